@@ -0,0 +1,656 @@
+/*
+Microbenchmarks for the cooling loop hot path.
+
+Every benchmark processes a batch of independent samples or controllers per iteration
+(first argument, swept 1..4096) and is repeated for 1, 2 and 4 threads. Each thread owns
+its own controllers, so the thread sweep shows how the hot path scales when several loops
+are stepped side by side.
+
+Results can be written as JSON for comparison between releases:
+    ./CoolingLoopControlBench --benchmark_out=bench.json --benchmark_out_format=json
+
+Each benchmark also reports allocs_per_iter, the number of heap allocations made by the
+timed loop, which the perf gate (benches/perf_gate.py) holds against the stored baseline.
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "AllocationTracker.h"
+#include "CANBus.h"
+#include "Checkpoint.h"
+#include "CoSimulation.h"
+#include "CoolingLoopController.h"
+#include "DriveCycle.h"
+#include "FleetRuntime.h"
+#include "FleetStatistics.h"
+#include "HealthEstimator.h"
+#include "JunctionEstimator.h"
+#include "LoopState.h"
+#include "Metrics.h"
+#include "PerformanceMap.h"
+#include "PlantServer.h"
+#include "PowerView.h"
+#include "PreCooling.h"
+#include "SensorDiagnostics.h"
+#include "SensorVoting.h"
+#include "TemperatureSensor.h"
+#include "TimerWheel.h"
+
+namespace {
+
+// Counts the allocations made between construction and report()
+class AllocationCounter {
+private:
+    long long start;
+
+public:
+    AllocationCounter() : start(AllocationTracker::threadAllocations()) {}
+
+    void report(benchmark::State& state) const {
+        double perIteration = static_cast<double>(AllocationTracker::threadAllocations() - start) /
+                              static_cast<double>(state.iterations());
+        state.counters["allocs_per_iter"] = benchmark::Counter(perIteration, benchmark::Counter::kAvgThreads);
+    }
+};
+
+// Sensor voltages spread over the interpolation table (about 20-100°C)
+std::vector<float> makeVoltages(size_t count) {
+    std::vector<float> voltages(count);
+    for (size_t i = 0; i < count; ++i) {
+        voltages[i] = 1.0f + 3.0f * static_cast<float>(i % 97) / 96.0f;
+    }
+    return voltages;
+}
+
+// Batch sizes and thread counts shared by all benchmarks
+void sweep(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(8)->Range(1, 4096)->ThreadRange(1, 4)->UseRealTime();
+}
+
+} // namespace
+
+// PIDController::compute over a batch of independent controllers
+static void BM_PIDCompute(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<PIDController> pids(batch, PIDController(0.5f, 0.1f, 0.05f));
+    std::vector<float> temperatures(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        temperatures[i] = 40.0f + static_cast<float>(i % 40);
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            float output = pids[i].compute(50.0f, temperatures[i]);
+            benchmark::DoNotOptimize(output);
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_PIDCompute)->Apply(sweep);
+
+// Voltage to temperature lookup
+static void BM_InterpolateTemperature(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<float> voltages = makeVoltages(batch);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            float temperature = interpolateTemperature(voltages[i]);
+            benchmark::DoNotOptimize(temperature);
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_InterpolateTemperature)->Apply(sweep);
+
+// Radiator map lookups for a batch of operating points, one by one with evaluate() (second
+// argument 0) or with evaluateBatch() (1), on an 11 x 13 datasheet-sized grid
+static void BM_PerformanceMap(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    PerformanceMap map;
+    std::vector<float> grid(11 * 13);
+    for (size_t i = 0; i < grid.size(); ++i) grid[i] = 20.0f + static_cast<float>(i);
+    map.assign({0.0f, 0.1f, 11}, {0.0f, 1.0f, 13}, grid);
+    std::vector<float> flow(batch), air(batch), out(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        flow[i] = static_cast<float>(i % 89) / 88.0f;
+        air[i] = 12.0f * static_cast<float>(i % 97) / 96.0f;
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        if (state.range(1)) {
+            map.evaluateBatch(flow.data(), air.data(), out.data(), batch);
+        } else {
+            for (size_t i = 0; i < batch; ++i) out[i] = map.evaluate(flow[i], air[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_PerformanceMap)->ArgNames({"batch", "simd"})->ArgsProduct({{8, 512, 4096}, {0, 1}})->UseRealTime();
+
+// Sensor plausibility over many channels at once (batch = channels)
+static void BM_ClassifySensorSamples(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<float> voltages = makeVoltages(batch);
+    std::vector<float> previous = makeVoltages(batch + 1);
+    previous.erase(previous.begin());
+    std::vector<uint8_t> status(batch);
+    SensorLimits limits;
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        classifySensorSamples(voltages.data(), previous.data(), status.data(), batch, limits);
+        benchmark::DoNotOptimize(status.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_ClassifySensorSamples)->Apply(sweep);
+
+// Triple-sensor voting over many loops at once (batch = loops)
+static void BM_VoteSensorChannels(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<float> channel[MAX_SENSOR_CHANNELS];
+    std::vector<std::uint8_t> status[MAX_SENSOR_CHANNELS];
+    for (int ch = 0; ch < MAX_SENSOR_CHANNELS; ++ch) {
+        channel[ch].resize(batch);
+        status[ch].resize(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            channel[ch][i] = 40.0f + static_cast<float>((i * (3 + ch)) % 40);
+            status[ch][i] = static_cast<std::uint8_t>((i + ch) % 31 == 0);
+        }
+    }
+    const float* temperature[MAX_SENSOR_CHANNELS] = {channel[0].data(), channel[1].data(), channel[2].data()};
+    const std::uint8_t* statuses[MAX_SENSOR_CHANNELS] = {status[0].data(), status[1].data(), status[2].data()};
+    std::vector<float> control(batch), median(batch);
+    std::vector<std::uint8_t> disagreement(batch);
+    VotingLimits limits;
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        voteSensorChannelsBatch(temperature, statuses, MAX_SENSOR_CHANNELS, control.data(), median.data(),
+                                disagreement.data(), batch, limits);
+        benchmark::DoNotOptimize(control.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_VoteSensorChannels)->Apply(sweep);
+
+// CAN frame encoding (without printing)
+static void BM_EncodeCANFrame(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<CANFrame> frames(batch);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            float speed = static_cast<float>(i % 101);
+            frames[i] = encodeCANFrame(speed, 100.0f - speed);
+        }
+        benchmark::DoNotOptimize(frames.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_EncodeCANFrame)->Apply(sweep);
+
+// Full simulated control cycle: state machine, diagnostics, interpolation, both PIDs and CAN encoding
+static void BM_ControlCycle(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    // Threshold above the table maximum so the loops never latch into shutdown
+    std::vector<CoolingLoopController> controllers(batch, CoolingLoopController(50.0f, 130.0f));
+    std::vector<float> voltages = makeVoltages(batch);
+    std::vector<CANFrame> frames(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        controllers[i].step({voltages[i], true, true}); // OFF -> ON
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            const ControlOutputs& out = controllers[i].step({voltages[i], true, true});
+            frames[i] = encodeCANFrame(out.pumpSpeed, out.fanSpeed);
+        }
+        benchmark::DoNotOptimize(frames.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_ControlCycle)->Apply(sweep);
+
+// Co-simulation host stepping a batch of instances through the C ABI, one control cycle per
+// instance and step: set inputs, step, read outputs
+static void BM_CoSimulationStep(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<CoolingLoopInstance*> instances(batch);
+    std::vector<float> voltages = makeVoltages(batch);
+    std::vector<CoolingLoopOutputs> outputs(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        instances[i] = coolingLoopInstantiate(nullptr, 0, 50.0f, 130.0f, 0.01);
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            coolingLoopSetInputs(instances[i], voltages[i], 1, 1);
+            coolingLoopDoStep(instances[i], 0.01);
+            coolingLoopGetOutputs(instances[i], &outputs[i]);
+        }
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+    for (CoolingLoopInstance* instance : instances) {
+        coolingLoopFreeInstance(instance);
+    }
+}
+BENCHMARK(BM_CoSimulationStep)->Apply(sweep);
+
+// Warm restart: restoring a snapshot into a batch of controllers
+static void BM_RestoreCheckpoint(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<CoolingLoopController> controllers(batch, CoolingLoopController(50.0f, 70.0f));
+    CoolingLoopController source(50.0f, 70.0f);
+    source.step({2.0f, true, true});
+    source.step({2.0f, true, true});
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    source.saveCheckpoint(snapshot, sizeof(snapshot));
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            benchmark::DoNotOptimize(controllers[i].restoreCheckpoint(snapshot, sizeof(snapshot)));
+        }
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_RestoreCheckpoint)->Apply(sweep);
+
+// Power View frames: publish, read back, compose and diff (batch = frames, one changing reading each)
+static void BM_PowerViewFrame(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<float> voltages = makeVoltages(batch);
+    Seqlock<PowerViewSnapshot> snapshot;
+    PowerView view;
+    char buffer[POWER_VIEW_BUFFER_SIZE];
+    PowerViewSnapshot published{};
+    published.outputs = ControlOutputs{SystemState::ON, ShutdownCause::NONE, 0.0f, 0.0f, 0.0f,
+                                       SensorStatus::VALID, 0x3, false};
+    published.setpoint = 50.0f;
+    published.threshold = 70.0f;
+
+    AllocationCounter allocations;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            published.outputs.measuredTemperature = interpolateTemperature(voltages[i]);
+            published.outputs.pumpSpeed = published.outputs.measuredTemperature - 40.0f;
+            ++published.cycle;
+            snapshot.store(published);
+            PowerViewSnapshot shown;
+            snapshot.load(shown);
+            view.compose(shown);
+            bytes += view.diff(buffer, sizeof(buffer));
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+    state.counters["bytes_per_frame"] = static_cast<double>(bytes) / static_cast<double>(state.iterations() * batch);
+}
+BENCHMARK(BM_PowerViewFrame)->Apply(sweep);
+
+// Filter and pump health estimation over a fleet of loops (batch = loops)
+static void BM_UpdateHealth(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    HealthLimits limits;
+    std::vector<HealthState> health(batch, HealthState(limits));
+    std::vector<HealthSample> samples(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        float command = 20.0f + static_cast<float>(i % 80);
+        samples[i] = {command, command * 58.0f, 48.0f, 49.5f, 2500.0f};
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        updateHealthBatch(health.data(), samples.data(), batch, limits);
+        benchmark::DoNotOptimize(health.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_UpdateHealth)->Apply(sweep);
+
+// One telemetry cycle of the fleet anomaly statistics (batch = loops). The 100k run is the
+// fleet-size target: at 10 Hz it has to finish well within 100 ms.
+static void BM_FleetStatistics(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    FleetStatistics statistics(batch);
+    std::vector<float> duty(batch);
+    std::vector<float> load(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        load[i] = 500.0f + static_cast<float>(i % 41) * 100.0f;
+        duty[i] = load[i] * (0.01f + 0.0001f * static_cast<float>(i % 7));
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        statistics.update(duty.data(), load.data());
+        benchmark::ClobberMemory();
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_FleetStatistics)->Apply(sweep);
+BENCHMARK(BM_FleetStatistics)->Arg(100000)->UseRealTime();
+
+// One cycle of a 256k-loop fleet on the fleet runtime, on one and then two NUMA nodes with
+// a pinned worker per core (second argument; clamped to the nodes the machine has, reported
+// as the nodes counter). Items per second across the two runs is the socket scaling.
+static void BM_FleetRuntime(benchmark::State& state) {
+    FleetOptions options;
+    options.loops = static_cast<size_t>(state.range(0));
+    options.nodes = static_cast<int>(state.range(1));
+    FleetRuntime fleet;
+    if (!fleet.start(options)) {
+        state.SkipWithError("cannot allocate the fleet");
+        return;
+    }
+    fleet.run(1); // Leave the ignition cycle out
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        fleet.run(1);
+    }
+    allocations.report(state);
+    state.counters["nodes"] = fleet.nodeCount();
+    state.counters["shards"] = fleet.shardCount();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * options.loops));
+}
+BENCHMARK(BM_FleetRuntime)->ArgNames({"loops", "nodes"})->Args({262144, 1})->Args({262144, 2})->UseRealTime();
+
+// Drive cycle streamed from a 1M-sample binary file (10 Hz, 24 MB) and interpolated to a
+// 100 Hz control rate; one sample per iteration, restarting at the end of the file
+static void BM_DriveCycleStream(benchmark::State& state) {
+    std::string path = "coolingloop_bench.dcb";
+    DriveCycleWriter writer;
+    bool written = writer.open(path.c_str());
+    for (int i = 0; written && i < 1000000; ++i) {
+        written = writer.write({0.1 * i, 50.0f, 1000.0f + static_cast<float>(i % 600), 300.0f, 25.0f});
+    }
+    std::string error;
+    DriveCycleProfile profile;
+    if (!writer.close() || !written || !profile.open(path.c_str(), error)) {
+        state.SkipWithError("cannot write the drive cycle");
+        return;
+    }
+
+    long cycle = 0;
+    DriveCycleSample sample;
+    for (auto _ : state) {
+        if (!profile.at(static_cast<double>(cycle++) * 0.01, sample)) {
+            state.PauseTiming();
+            profile.open(path.c_str(), error);
+            cycle = 0;
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(sample);
+    }
+    state.SetItemsProcessed(state.iterations());
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_DriveCycleStream);
+
+// Control-period round trip to the plant server over a Unix socket: command out, plant
+// stepped, sample back. Must stay well under 1 ms for a 1 kHz hardware-in-the-loop run.
+static void BM_PlantRoundTrip(benchmark::State& state) {
+    std::string path = "/tmp/coolingloop_bench_plant.sock";
+    PlantModel plant(PlantParameters{}, 45.0f);
+    PlantServer server;
+    PlantLink link;
+    if (!server.start(path.c_str(), plant) || !link.connect(path.c_str())) {
+        state.SkipWithError("cannot start the plant server");
+        return;
+    }
+
+    PlantSample sample;
+    link.setPump(50.0f);
+    link.setFan(30.0f);
+    for (auto _ : state) {
+        if (!link.exchange(0.001f, sample)) {
+            state.SkipWithError("plant server connection lost");
+            break;
+        }
+        benchmark::DoNotOptimize(sample);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlantRoundTrip)->UseRealTime();
+
+// One cycle of a 256k-loop fleet with heat load noise, with and without deterministic mode
+// (second argument): the cost of block-aligned shards and the pairwise energy reduction
+static void BM_FleetDeterministic(benchmark::State& state) {
+    FleetOptions options;
+    options.loops = static_cast<size_t>(state.range(0));
+    options.deterministic = state.range(1) != 0;
+    options.loadNoise = 0.1f;
+    FleetRuntime fleet;
+    if (!fleet.start(options)) {
+        state.SkipWithError("cannot allocate the fleet");
+        return;
+    }
+    fleet.run(1); // Leave the ignition cycle out
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        fleet.run(1);
+    }
+    allocations.report(state);
+    benchmark::DoNotOptimize(fleet.summary().heatEnergy);
+    state.counters["shards"] = fleet.shardCount();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * options.loops));
+}
+BENCHMARK(BM_FleetDeterministic)->ArgNames({"loops", "deterministic"})->Args({262144, 0})->Args({262144, 1})->UseRealTime();
+
+// One cycle of N loops on one thread, laid out as FleetLoop objects (AoS, second argument 0)
+// or as LoopStateArray blocks (SoA, 1), at 1k, 100k and 1M loops
+static void BM_LoopStateLayout(benchmark::State& state) {
+    const size_t loops = static_cast<size_t>(state.range(0));
+    FleetOptions options;
+    std::vector<FleetLoop> aos;
+    LoopStateArray soa(state.range(1) ? loops : 0, options);
+    if (!state.range(1)) {
+        aos.reserve(loops);
+        for (size_t i = 0; i < loops; ++i) aos.emplace_back(options, i);
+    }
+    float seconds = 0.0f;
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        size_t shutdowns = 0;
+        if (state.range(1)) {
+            shutdowns = soa.step(seconds);
+        } else {
+            for (FleetLoop& loop : aos) shutdowns += loop.step(seconds, options.dt);
+        }
+        benchmark::DoNotOptimize(shutdowns);
+        seconds += options.dt;
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * loops));
+    state.SetBytesProcessed(static_cast<int64_t>(
+        state.iterations() * (state.range(1) ? soa.bytes() : loops * sizeof(FleetLoop))));
+}
+BENCHMARK(BM_LoopStateLayout)->ArgNames({"loops", "soa"})->ArgsProduct({{1000, 100000, 1000000}, {0, 1}})->UseRealTime();
+
+// Top-10 anomaly report over 100k loops
+static void BM_FleetTopAnomalies(benchmark::State& state) {
+    const size_t loops = static_cast<size_t>(state.range(0));
+    FleetStatisticsLimits limits;
+    limits.baselineSamples = 1.0f;
+    FleetStatistics statistics(loops, limits);
+    std::vector<float> duty(loops, 20.0f);
+    std::vector<float> load(loops, 1000.0f);
+    statistics.update(duty.data(), load.data());
+    for (size_t i = 0; i < loops; ++i) {
+        duty[i] = 20.0f + static_cast<float>((i * 7919) % 1000) * 0.001f; // Every loop gets a score
+    }
+    statistics.update(duty.data(), load.data());
+
+    FleetAnomaly report[10];
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        size_t found = statistics.topAnomalies(report, 10);
+        benchmark::DoNotOptimize(found);
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * loops));
+}
+BENCHMARK(BM_FleetTopAnomalies)->Arg(100000)->UseRealTime();
+
+// One step of the inverter IGBT junctions of many loops, one JunctionEstimator per device
+// (second argument 0) or one JunctionEstimatorArray (1)
+static void BM_JunctionEstimator(benchmark::State& state) {
+    const size_t devices = static_cast<size_t>(state.range(0));
+    std::vector<JunctionEstimator> scalar(state.range(1) ? 0 : devices, JunctionEstimator(INVERTER_IGBT_NETWORK, 50.0f));
+    JunctionEstimatorArray array(INVERTER_IGBT_NETWORK, state.range(1) ? devices : 0, 50.0f);
+    std::vector<float> power(devices);
+    std::vector<float> coolant(devices);
+    for (size_t i = 0; i < devices; ++i) {
+        power[i] = 100.0f + static_cast<float>(i % 500);
+        coolant[i] = 45.0f + static_cast<float>(i % 100) * 0.1f;
+    }
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        if (state.range(1)) {
+            array.update(power.data(), coolant.data(), 0.01f);
+            benchmark::DoNotOptimize(array.temperatures());
+        } else {
+            for (size_t i = 0; i < devices; ++i) {
+                benchmark::DoNotOptimize(scalar[i].update(power[i], coolant[i], 0.01f));
+            }
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * devices));
+}
+BENCHMARK(BM_JunctionEstimator)->ArgNames({"devices", "array"})->ArgsProduct({{4096, 262144}, {0, 1}})->UseRealTime();
+
+// One warm-started plan() call per control cycle over a ten-minute horizon, the hill climb
+// moving one planning step closer every five cycles
+static void BM_PreCoolingPlan(benchmark::State& state) {
+    PreCoolingOptions options;
+    LoadForecast forecast(options.horizon, options.stepSeconds, 1800.0f);
+    forecast.set(300.0f, 3500.0f);
+    PreCoolingPlanner planner(PlantParameters{}, options);
+    for (int call = 0; call < 100; ++call) planner.plan(50.0f, 50.0f, forecast);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        forecast.advance(1.0f);
+        if (forecast.at(0) == 3500.0f) { // Keep the climb ahead
+            forecast.set(0.0f, 1800.0f);
+            forecast.set(300.0f, 3500.0f);
+        }
+        benchmark::DoNotOptimize(planner.plan(50.0f, 50.0f, forecast));
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_PreCoolingPlan);
+
+// Fleet timers on one wheel (timers = loops x LOOP_TIMER_COUNT, all armed): per iteration one
+// timer is cancelled and re-armed, as a CAN inhibit restarting, and the clock moves one tick,
+// every timer due re-arming as a heartbeat. Items are arms, cancels and expiries; the time per
+// item stays flat from thousands to millions of timers, apart from cache misses.
+static void BM_TimerWheel(benchmark::State& state) {
+    const std::uint32_t timers = static_cast<std::uint32_t>(state.range(0));
+    TimerWheel wheel(timers);
+    std::vector<TimerHandle> handles(timers);
+    std::uint64_t seed = 88172645463325252ull;
+    auto delay = [&seed]() { // xorshift, 1 tick to 10 minutes at 1 ms ticks
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return 1 + seed % 600000;
+    };
+    for (std::uint32_t i = 0; i < timers; ++i) {
+        handles[i] = wheel.arm(delay(), i, static_cast<std::uint16_t>(i % LOOP_TIMER_COUNT));
+    }
+    auto rearm = [&](std::uint32_t owner, std::uint16_t kind) {
+        handles[owner] = wheel.arm(delay(), owner, kind);
+    };
+
+    AllocationCounter allocations;
+    std::uint32_t next = 0;
+    std::uint64_t operations = 0;
+    for (auto _ : state) {
+        wheel.cancel(handles[next]);
+        handles[next] = wheel.arm(delay(), next, static_cast<std::uint16_t>(LoopTimer::CAN_INHIBIT));
+        next = next + 1 < timers ? next + 1 : 0;
+        operations += 2 + 2 * wheel.advance(1, rearm); // Each expiry re-arms
+    }
+    allocations.report(state);
+    state.counters["armed"] = static_cast<double>(wheel.size());
+    state.counters["MiB"] = static_cast<double>(wheel.bytes()) / (1024.0 * 1024.0);
+    state.SetItemsProcessed(static_cast<int64_t>(operations));
+}
+BENCHMARK(BM_TimerWheel)->Arg(4096)->Arg(1 << 20)->Arg(4 << 20);
+
+// Per-cycle counters and stage latencies from every thread into one shared registry
+// (batch = cycles); sharding keeps the thread sweep flat
+static ControllerMetrics benchMetrics;
+
+static void BM_RecordCycleMetrics(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch; ++i) {
+            benchMetrics.cycles.add();
+            for (int stage = 0; stage < CONTROL_STAGE_COUNT; ++stage) {
+                benchMetrics.stageLatency[stage].record(1000 + 64 * i);
+            }
+            benchMetrics.canFramesSent.add();
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_RecordCycleMetrics)->Apply(sweep);
+
+#ifndef COOLINGLOOP_BUILD_TYPE
+#define COOLINGLOOP_BUILD_TYPE "unknown"
+#endif
+
+int main(int argc, char** argv) {
+    // Recorded in the JSON context so the perf gate only compares like with like
+    benchmark::AddCustomContext("coolingloop_build_type", COOLINGLOOP_BUILD_TYPE);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Performance regression gate for the cooling loop.
+
+Runs CoolingLoopControlBench in a fixed configuration (batch 512, one thread, repeated
+runs) and compares every gated benchmark against the checked-in baseline:
+
+  * time per iteration: fails when the median is more than --tolerance percent slower
+    AND a one-sided Mann-Whitney U test says the slowdown is significant (p < --alpha)
+  * allocs_per_iter:    fails on any increase
+
+Timings are only compared when the build type, host, CPU count and CPU model match the
+ones the baseline was recorded with (re-record with --update on the gating machine); a
+host name alone does not tell a resized VM or a new runner apart. Allocation counts are
+always compared.
+
+Usage:
+    perf_gate.py --bench ./CoolingLoopControlBench --baseline perf_baseline.json
+    perf_gate.py --bench ./CoolingLoopControlBench --baseline perf_baseline.json --update
+"""
+
+import argparse
+import json
+import math
+import platform
+import subprocess
+import sys
+import tempfile
+import os
+
+# Gated benchmarks: control cycle time, compute() throughput and the lookups around them
+GATED = ["BM_ControlCycle", "BM_PIDCompute", "BM_InterpolateTemperature", "BM_EncodeCANFrame"]
+FILTER = "^(" + "|".join(GATED) + ")/512/real_time/threads:1$"
+REPETITIONS = 15
+MIN_TIME = "0.05"
+
+
+def cpu_model():
+    """Processor model name as /proc/cpuinfo or lscpu report it, empty if unknown."""
+    try:
+        with open("/proc/cpuinfo") as cpuinfo:
+            for line in cpuinfo:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    try:
+        output = subprocess.run(["lscpu"], check=True, capture_output=True, text=True).stdout
+        for line in output.splitlines():
+            if line.startswith("Model name:"):
+                return line.split(":", 1)[1].strip()
+    except (OSError, subprocess.CalledProcessError):
+        pass
+    return platform.processor()
+
+
+def run_bench(bench):
+    """Run the gated benchmarks and return (configuration, {name: {samples, allocs}})."""
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "bench.json")
+        subprocess.run([bench,
+                        "--benchmark_filter=" + FILTER,
+                        "--benchmark_repetitions=%d" % REPETITIONS,
+                        "--benchmark_min_time=" + MIN_TIME,
+                        "--benchmark_enable_random_interleaving=true",
+                        "--benchmark_out=" + out,
+                        "--benchmark_out_format=json"],
+                       check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        with open(out) as f:
+            report = json.load(f)
+
+    results = {}
+    for entry in report["benchmarks"]:
+        if entry.get("run_type") != "iteration":
+            continue
+        name = entry["run_name"].split("/")[0]
+        result = results.setdefault(name, {"samples": [], "allocs": 0.0})
+        result["samples"].append(entry["real_time"])
+        result["allocs"] = max(result["allocs"], entry.get("allocs_per_iter", 0.0))
+    context = report["context"]
+    config = {"build_type": context.get("coolingloop_build_type") or "None",
+              "host": context.get("host_name", ""),
+              "num_cpus": context.get("num_cpus", 0),
+              "cpu_model": cpu_model()}
+    return config, results
+
+
+def median(values):
+    ordered = sorted(values)
+    mid = len(ordered) // 2
+    return ordered[mid] if len(ordered) % 2 else 0.5 * (ordered[mid - 1] + ordered[mid])
+
+
+def mann_whitney_greater(current, baseline):
+    """One-sided p-value that `current` tends to be larger than `baseline` (normal approx.)."""
+    combined = sorted([(v, 0) for v in current] + [(v, 1) for v in baseline])
+    ranks = [0.0] * len(combined)
+    tie_term = 0.0
+    i = 0
+    while i < len(combined):
+        j = i
+        while j + 1 < len(combined) and combined[j + 1][0] == combined[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = 0.5 * (i + j) + 1.0
+        ties = j - i + 1
+        tie_term += ties ** 3 - ties
+        i = j + 1
+
+    n1, n2 = len(current), len(baseline)
+    rank_sum = sum(r for r, (_, group) in zip(ranks, combined) if group == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0.0:
+        return 1.0
+    z = (u - n1 * n2 / 2.0 - 0.5) / math.sqrt(variance)  # continuity correction
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--bench", required=True, help="path to CoolingLoopControlBench")
+    parser.add_argument("--baseline", required=True, help="baseline JSON file")
+    parser.add_argument("--tolerance", type=float, default=15.0, help="allowed slowdown in percent")
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level")
+    parser.add_argument("--update", action="store_true", help="record a new baseline and exit")
+    args = parser.parse_args()
+
+    config, results = run_bench(args.bench)
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump({"config": config, "benchmarks": results}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Recorded %s baseline in %s" % (config["build_type"], args.baseline))
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    differing = sorted(key for key in set(config) | set(baseline["config"])
+                       if config.get(key) != baseline["config"].get(key))
+    compare_time = not differing
+    for key in differing:
+        print("WARNING: %s %r differs from baseline %r" % (key, config.get(key), baseline["config"].get(key)))
+    if not compare_time:
+        print("Not comparing timings on another machine or build: comparing allocation counts only")
+
+    failures = 0
+    for name in GATED:
+        if name not in baseline["benchmarks"] or name not in results:
+            print("FAIL %-28s missing from %s" % (name, "baseline" if name in results else "run"))
+            failures += 1
+            continue
+        base = baseline["benchmarks"][name]
+        cur = results[name]
+
+        if cur["allocs"] > base["allocs"]:
+            print("FAIL %-28s allocs/iter %.2f > baseline %.2f" % (name, cur["allocs"], base["allocs"]))
+            failures += 1
+
+        if compare_time:
+            change = 100.0 * (median(cur["samples"]) / median(base["samples"]) - 1.0)
+            p_value = mann_whitney_greater(cur["samples"], base["samples"])
+            regressed = change > args.tolerance and p_value < args.alpha
+            print("%s %-28s median %+6.1f%% (p=%.4f)" % ("FAIL" if regressed else "ok  ", name, change, p_value))
+            failures += regressed
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+Startup benchmark for the cooling loop application.
+
+Starts CoolingLoopControl with the baked calibration image repeatedly and measures the wall
+time from spawning the process to its first pump command ("Pump running at ..." on stdout),
+which covers exec, dynamic loading, static initialisation, mapping and validating the image
+and the first control cycle. Fails when the median exceeds --budget-ms.
+
+Usage:
+    startup_bench.py --app ./CoolingLoopControl --calibration calibration.img [--runs 20] [--budget-ms 50]
+"""
+
+import argparse
+import statistics
+import subprocess
+import sys
+import time
+
+
+def time_to_first_pump(app, calibration):
+    """Milliseconds from spawning the application to its first pump command."""
+    start = time.perf_counter()
+    process = subprocess.Popen([app, "--calibration", calibration],
+                               stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    try:
+        for line in process.stdout:
+            if line.startswith(b"Pump running"):
+                return (time.perf_counter() - start) * 1000.0
+        raise RuntimeError("application exited without commanding the pump")
+    finally:
+        process.kill()
+        process.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--app", required=True)
+    parser.add_argument("--calibration", required=True)
+    parser.add_argument("--runs", type=int, default=20)
+    parser.add_argument("--budget-ms", type=float, default=50.0)
+    args = parser.parse_args()
+
+    time_to_first_pump(args.app, args.calibration)  # Warm the page cache
+    samples = [time_to_first_pump(args.app, args.calibration) for _ in range(args.runs)]
+    median = statistics.median(samples)
+    print("start to first pump command: median %.2f ms, min %.2f ms, max %.2f ms over %d runs (budget %.0f ms)"
+          % (median, min(samples), max(samples), len(samples), args.budget_ms))
+    if median > args.budget_ms:
+        print("FAIL: startup exceeds the budget")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
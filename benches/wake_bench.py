@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Wake benchmark for the low-power OFF state of the cooling loop application.
+
+Starts CoolingLoopControl with the eventfd ignition stand-in (--wake eventfd) and runs key
+cycles: while the application waits for the ignition it must not be scheduled at all (no
+context switch of any of its threads over --idle-ms), then SIGUSR1 turns the ignition on
+and the wall time to the first pump command ("Pump running at ..." on stdout) is measured,
+and SIGUSR2 turns it off again. Fails when the median wake latency exceeds --budget-ms or
+the parked process woke up.
+
+Usage:
+    wake_bench.py --app ./CoolingLoopControl --calibration calibration.img [--cycles 20] [--budget-ms 5]
+"""
+
+import argparse
+import glob
+import os
+import signal
+import statistics
+import subprocess
+import sys
+import time
+
+
+def context_switches(pid):
+    """Context switches of all threads of a process so far, None without /proc."""
+    total = 0
+    paths = glob.glob("/proc/%d/task/*/status" % pid)
+    if not paths:
+        return None
+    for path in paths:
+        try:
+            with open(path) as status:
+                for line in status:
+                    if line.startswith(("voluntary_ctxt_switches", "nonvoluntary_ctxt_switches")):
+                        total += int(line.split()[1])
+        except OSError:
+            pass  # Thread gone
+    return total
+
+
+def read_until(process, prefix):
+    for line in process.stdout:
+        if line.startswith(prefix):
+            return line
+    raise RuntimeError("application exited before printing %r" % prefix)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--app", required=True)
+    parser.add_argument("--calibration", required=True)
+    parser.add_argument("--cycles", type=int, default=20)
+    parser.add_argument("--idle-ms", type=float, default=200.0)
+    parser.add_argument("--budget-ms", type=float, default=5.0)
+    args = parser.parse_args()
+
+    process = subprocess.Popen([args.app, "--calibration", args.calibration, "--wake", "eventfd",
+                                "--no-afterrun", "--period", "10"],
+                               stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    samples = []
+    reported = []
+    wakeups = 0
+    try:
+        for _ in range(args.cycles):
+            read_until(process, b"System OFF. Waiting for the ignition.")
+            time.sleep(0.02)  # Let it reach poll()
+            before = context_switches(process.pid)
+            time.sleep(args.idle_ms / 1000.0)
+            after = context_switches(process.pid)
+            if before is not None and after is not None:
+                wakeups += after - before
+
+            start = time.perf_counter()
+            os.kill(process.pid, signal.SIGUSR1)
+            read_until(process, b"Pump running")
+            samples.append((time.perf_counter() - start) * 1000.0)
+            line = read_until(process, b"Wake to first pump command:")
+            reported.append(int(line.split()[-2]) / 1000.0)
+            os.kill(process.pid, signal.SIGUSR2)
+    finally:
+        process.kill()
+        process.wait()
+
+    median = statistics.median(samples)
+    print("ignition to first pump command: median %.2f ms, min %.2f ms, max %.2f ms over %d key cycles (budget %.0f ms)"
+          % (median, min(samples), max(samples), len(samples), args.budget_ms))
+    print("in process, wake to first pump command: median %.3f ms" % statistics.median(reported))
+    print("context switches while parked: %d over %d x %.0f ms" % (wakeups, args.cycles, args.idle_ms))
+    if median > args.budget_ms:
+        print("FAIL: wake latency exceeds the budget")
+        return 1
+    if wakeups > 0:
+        print("FAIL: the parked application woke up")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
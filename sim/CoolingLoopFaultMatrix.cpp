@@ -0,0 +1,201 @@
+/*
+Fault-injection matrix for the cooling loop.
+
+Runs every scenario file against every heat load on a pool of threads, checks the
+scenario expectations and prints a coverage report: for each injected fault, how many
+runs reached each controller outcome and how many cycles after the fault it took.
+
+Usage:
+    CoolingLoopFaultMatrix [--threads N] [--loads W,W,...] [--report coverage.csv] scenario.fault...
+*/
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandLine.h"
+#include "FaultInjection.h"
+
+namespace {
+
+struct MatrixRun {
+    const FaultScenario* scenario;
+    float heatLoad;
+    FaultRunResult result;
+};
+
+// Runs reaching an outcome after a fault, with latency statistics in cycles
+struct CoverageCell {
+    long runs = 0;
+    long reached = 0;
+    long minLatency = -1;
+    long maxLatency = -1;
+    double latencySum = 0.0;
+
+    void add(long latency) {
+        ++runs;
+        if (latency < 0) {
+            return;
+        }
+        ++reached;
+        latencySum += static_cast<double>(latency);
+        if (minLatency < 0 || latency < minLatency) minLatency = latency;
+        if (latency > maxLatency) maxLatency = latency;
+    }
+};
+
+bool parseLoads(const char* text, std::vector<float>& loads) {
+    std::stringstream list(text);
+    std::string item;
+    loads.clear();
+    while (std::getline(list, item, ',')) {
+        float load = 0.0f;
+        if (!parseFloat(item.c_str(), load)) {
+            return false;
+        }
+        loads.push_back(load);
+    }
+    return !loads.empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long threadCount = static_cast<long>(std::thread::hardware_concurrency());
+    std::vector<float> loads; // Empty: use each scenario's own load
+    const char* reportPath = nullptr;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; ++i) {
+        bool ok = true;
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], threadCount);
+        } else if (std::strcmp(argv[i], "--loads") == 0 && i + 1 < argc) {
+            ok = parseLoads(argv[++i], loads);
+        } else if (std::strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            reportPath = argv[++i];
+        } else {
+            files.push_back(argv[i]);
+        }
+        if (!ok) {
+            std::cerr << "Error parsing command-line arguments: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: CoolingLoopFaultMatrix [--threads N] [--loads W,W,...] [--report file.csv] scenario.fault...\n";
+        return 1;
+    }
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+
+    // Load the scenarios
+    std::vector<FaultScenario> scenarios(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::ifstream in(files[i]);
+        std::string error;
+        if (!in) {
+            std::cerr << files[i] << ": cannot open\n";
+            return 1;
+        }
+        if (!parseFaultScenario(in, scenarios[i], error)) {
+            std::cerr << files[i] << ": " << error << "\n";
+            return 1;
+        }
+        if (scenarios[i].name.empty()) {
+            scenarios[i].name = files[i];
+        }
+    }
+
+    // Build the matrix: scenario x heat load
+    std::vector<MatrixRun> runs;
+    for (const FaultScenario& scenario : scenarios) {
+        if (loads.empty()) {
+            runs.push_back(MatrixRun{&scenario, scenario.heatLoad, FaultRunResult{}});
+        }
+        for (float load : loads) {
+            runs.push_back(MatrixRun{&scenario, load, FaultRunResult{}});
+        }
+    }
+
+    // Run it on the worker threads
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (long t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < runs.size(); i = next++) {
+                FaultScenario scenario = *runs[i].scenario;
+                scenario.heatLoad = runs[i].heatLoad;
+                runs[i].result = runFaultScenario(scenario);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Aggregate coverage per fault type and outcome
+    CoverageCell coverage[FAULT_TYPE_COUNT][FAULT_OUTCOME_COUNT];
+    int failures = 0;
+    for (const MatrixRun& run : runs) {
+        for (const FaultSpec& fault : run.scenario->faults) {
+            for (int o = 0; o < FAULT_OUTCOME_COUNT; ++o) {
+                coverage[static_cast<int>(fault.type)][o].add(run.result.latency(static_cast<FaultOutcome>(o)));
+            }
+        }
+        if (!run.result.passed) {
+            ++failures;
+            std::cout << "FAIL " << run.scenario->name << " @ " << run.heatLoad << " W: " << run.result.failure << "\n";
+        }
+    }
+
+    std::cout << "Fault matrix: " << scenarios.size() << " scenarios, " << runs.size() << " runs on "
+              << threadCount << " threads, " << failures << " failed\n\n";
+    std::cout << "Coverage: runs reaching each outcome after the fault (latency min/mean/max in cycles)\n";
+    std::cout << std::left << std::setw(17) << "fault";
+    for (int o = 0; o < FAULT_OUTCOME_COUNT; ++o) {
+        std::cout << std::setw(24) << faultOutcomeName(static_cast<FaultOutcome>(o));
+    }
+    std::cout << "\n";
+    for (int f = 0; f < FAULT_TYPE_COUNT; ++f) {
+        if (coverage[f][0].runs == 0) {
+            continue;
+        }
+        std::cout << std::setw(17) << faultTypeName(static_cast<FaultType>(f));
+        for (int o = 0; o < FAULT_OUTCOME_COUNT; ++o) {
+            const CoverageCell& cell = coverage[f][o];
+            std::ostringstream text;
+            text << cell.reached << "/" << cell.runs;
+            if (cell.reached) {
+                text << " " << cell.minLatency << "/" << std::fixed << std::setprecision(0)
+                     << cell.latencySum / cell.reached << "/" << cell.maxLatency;
+            }
+            std::cout << std::setw(24) << text.str();
+        }
+        std::cout << "\n";
+    }
+
+    if (reportPath) {
+        std::ofstream report(reportPath);
+        report << "fault,outcome,runs,reached,min_latency,mean_latency,max_latency\n";
+        for (int f = 0; f < FAULT_TYPE_COUNT; ++f) {
+            for (int o = 0; o < FAULT_OUTCOME_COUNT; ++o) {
+                const CoverageCell& cell = coverage[f][o];
+                if (cell.runs == 0) {
+                    continue;
+                }
+                report << faultTypeName(static_cast<FaultType>(f)) << "," << faultOutcomeName(static_cast<FaultOutcome>(o))
+                       << "," << cell.runs << "," << cell.reached << "," << cell.minLatency << ","
+                       << (cell.reached ? cell.latencySum / cell.reached : -1.0) << "," << cell.maxLatency << "\n";
+            }
+        }
+    }
+    return failures ? 1 : 0;
+}
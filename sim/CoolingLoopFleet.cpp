@@ -0,0 +1,94 @@
+/*
+Fleet simulator for the cooling loop.
+
+Steps a fleet of independent loops through the drive profile on the NUMA-aware fleet
+runtime and prints the shard placement, the throughput and the fleet aggregates. With
+--deterministic the aggregates are the same bit for bit for any --shards; --noise adds a
+per-cycle heat load variation drawn from each loop's own random stream.
+
+Usage:
+    CoolingLoopFleet [--loops N] [--cycles N] [--shards N] [--nodes N] [--no-pin]
+                     [--deterministic] [--noise F] [--seed N]
+*/
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "CommandLine.h"
+#include "FleetRuntime.h"
+
+int main(int argc, char* argv[]) {
+    FleetOptions options;
+    options.loops = 100000;
+    long loops = static_cast<long>(options.loops);
+    long cycles = 60;
+    long shards = 0;
+    long nodes = 0;
+    long seed = static_cast<long>(options.seed);
+
+    for (int i = 1; i < argc; ++i) {
+        bool ok = true;
+        if (std::strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], loops);
+        } else if (std::strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], cycles);
+        } else if (std::strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], shards);
+        } else if (std::strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], nodes);
+        } else if (std::strcmp(argv[i], "--no-pin") == 0) {
+            options.pin = false;
+        } else if (std::strcmp(argv[i], "--deterministic") == 0) {
+            options.deterministic = true;
+        } else if (std::strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+            ok = parseFloat(argv[++i], options.loadNoise) && options.loadNoise >= 0.0f && options.loadNoise <= 1.0f;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], seed);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Usage: CoolingLoopFleet [--loops N] [--cycles N] [--shards N] [--nodes N] [--no-pin]\n"
+                         "                        [--deterministic] [--noise F] [--seed N]\n";
+            return 1;
+        }
+    }
+    options.loops = static_cast<std::size_t>(loops);
+    options.shards = static_cast<int>(shards);
+    options.nodes = static_cast<int>(nodes);
+    options.seed = static_cast<std::uint64_t>(seed);
+
+    FleetRuntime fleet;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (!fleet.start(options)) {
+        std::cerr << "Cannot allocate " << options.loops << " loops\n";
+        return 1;
+    }
+    double setup = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "Fleet: " << options.loops << " loops in " << fleet.shardCount() << " shards on "
+              << fleet.nodeCount() << " NUMA node(s), set up in " << setup * 1e3 << " ms\n";
+    for (int s = 0; s < fleet.shardCount(); ++s) {
+        std::cout << "  shard " << s << ": " << fleet.shardLoops(s) << " loops, node " << fleet.shardNode(s)
+                  << ", cpu ";
+        if (fleet.shardCpu(s) >= 0) {
+            std::cout << fleet.shardCpu(s) << "\n";
+        } else {
+            std::cout << "unpinned\n";
+        }
+    }
+
+    begin = std::chrono::steady_clock::now();
+    fleet.run(cycles);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    FleetSummary summary = fleet.summary();
+    std::cout << "Stepped " << summary.loopCycles << " loop cycles in " << seconds * 1e3 << " ms ("
+              << static_cast<double>(summary.loopCycles) / seconds / 1e6 << " M loop cycles/s)\n";
+    std::cout << "Shutdowns: " << summary.shutdowns << ", peak temperature " << summary.peakTemperature << "°C\n";
+    std::cout << "Heat energy: " << std::hexfloat << summary.heatEnergy << std::defaultfloat << " ("
+              << summary.heatEnergy / 3.6e6 << " kWh)\n";
+    return 0;
+}
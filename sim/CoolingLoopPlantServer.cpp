@@ -0,0 +1,85 @@
+/*
+Plant server: the plant model in its own process, standing in for the hardware-in-the-loop
+rig. The controller connects with --plant and exchanges one command and one sample per
+control period over a Unix socket (see src/PlantServer.h).
+
+Usage:
+    CoolingLoopPlantServer socket [--profile file] [--radiator-map file]
+
+Runs until Ctrl+C. Example at 1 kHz:
+    CoolingLoopPlantServer /tmp/plant.sock --profile config/drive_cycle.csv &
+    CoolingLoopControl --plant /tmp/plant.sock --period 1
+*/
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "DriveCycle.h"
+#include "PerformanceMap.h"
+#include "PlantModel.h"
+#include "PlantServer.h"
+
+static std::atomic<bool> stopRequested(false);
+
+extern "C" void requestStop(int) {
+    stopRequested = true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* socketPath = nullptr;
+    const char* profilePath = nullptr;
+    const char* radiatorPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--radiator-map") == 0 && i + 1 < argc) {
+            radiatorPath = argv[++i];
+        } else if (!socketPath) {
+            socketPath = argv[i];
+        } else {
+            socketPath = nullptr;
+            break;
+        }
+    }
+    if (!socketPath) {
+        std::cerr << "Usage: CoolingLoopPlantServer socket [--profile file] [--radiator-map file]\n";
+        return 1;
+    }
+
+    DriveCycleProfile profile;
+    std::string error;
+    if (profilePath && !profile.open(profilePath, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    RadiatorMap radiator;
+    if (radiatorPath && !loadRadiatorMap(radiatorPath, radiator, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    PlantModel plant(PlantParameters{}, 45.0f);
+    if (radiatorPath) {
+        plant.setRadiatorMap(&radiator);
+    }
+    PlantServer server;
+    if (!server.start(socketPath, plant, profilePath ? &profile : nullptr)) {
+        std::cerr << "Cannot serve the plant on " << socketPath << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::cout << "Serving the plant on " << socketPath << "\n";
+
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    server.stop();
+    std::cout << server.roundTrips() << " round trips\n";
+    return 0;
+}
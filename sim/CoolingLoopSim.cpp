@@ -0,0 +1,278 @@
+/*
+Virtual-time simulator for the cooling loop.
+
+Runs the controller against the plant model as fast as the CPU allows (no sleeps), using a
+stepped heat-load profile that exercises warm-up, regulation and high-load phases. Used for
+closed-loop checks and to train the profiles of the PGO release build. With --profile the
+heat load and ambient temperature come from a recorded drive cycle (CSV or binary, see
+src/DriveCycle.h), streamed and interpolated to the control rate; the run ends with the
+drive cycle. With --radiator-map the radiator conductance comes from a datasheet
+performance map (config/radiator_map.txt) over coolant flow and air velocity, the latter
+including the ram air at the drive cycle's vehicle speed. With --derate the controller
+derates instead of shutting down (see src/Derating.h) and the inverter and DC-DC losses
+scale with the allowed power. With --junction-limit the inverter and DC-DC junction
+temperatures are estimated from their losses (see src/JunctionEstimator.h) and the coolant
+setpoint rises while the hottest junction stays below the limit less its margin. With
+--lookahead the planner of src/PreCooling.h sees the heat load ten minutes ahead (the
+drive cycle read ahead, or the built-in profile) and pre-cools before load peaks. With
+--key-off the ignition goes off at the given time and the heat stored in the power stage
+soaks into the coolant; --afterrun keeps the loop cooling after key-off (see src/Afterrun.h),
+on a timer of src/TimerWheel.h.
+
+Usage:
+    CoolingLoopSim [setpoint] [threshold] [--cycles N] [--dt seconds] [--trace] [--profile file]
+                   [--radiator-map file] [--derate] [--junction-limit celsius]
+                   [--lookahead] [--key-off seconds] [--afterrun]
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "CANBus.h"
+#include "CommandLine.h"
+#include "CoolingLoopController.h"
+#include "DriveCycle.h"
+#include "JunctionEstimator.h"
+#include "PerformanceMap.h"
+#include "PlantModel.h"
+#include "PreCooling.h"
+#include "TimerWheel.h"
+
+// Heat soak after key-off: the power stage gives up its stored heat, this share of the load
+// at key-off at first, with this time constant
+const float SOAK_SHARE = 0.5f;
+const float SOAK_SECONDS = 60.0f;
+
+int main(int argc, char* argv[]) {
+    float tempSetpoint = 50.0f;    // Default setpoint
+    float safetyThreshold = 70.0f; // Default safety threshold
+    long cycles = 36000;           // Ten hours at 1 Hz
+    float dt = 1.0f;               // Control period (s)
+    bool trace = false;
+    const char* profilePath = nullptr;
+    const char* radiatorPath = nullptr;
+    bool derate = false;
+    float junctionLimit = 0.0f; // 0 = no junction estimate
+    bool lookahead = false;
+    float keyOff = -1.0f; // Key-off time (s), none by default
+    bool afterrun = false;
+
+    // Parse command-line arguments
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        bool ok = true;
+        if (std::strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            ok = parseCount(argv[++i], cycles);
+        } else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc) {
+            ok = parseFloat(argv[++i], dt);
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--radiator-map") == 0 && i + 1 < argc) {
+            radiatorPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--derate") == 0) {
+            derate = true;
+        } else if (std::strcmp(argv[i], "--junction-limit") == 0 && i + 1 < argc) {
+            ok = parseFloat(argv[++i], junctionLimit) && junctionLimit > 0.0f;
+        } else if (std::strcmp(argv[i], "--lookahead") == 0) {
+            lookahead = true;
+        } else if (std::strcmp(argv[i], "--key-off") == 0 && i + 1 < argc) {
+            ok = parseFloat(argv[++i], keyOff) && keyOff >= 0.0f;
+        } else if (std::strcmp(argv[i], "--afterrun") == 0) {
+            afterrun = true;
+        } else if (positional == 0) {
+            ok = parseFloat(argv[i], tempSetpoint);
+            ++positional;
+        } else {
+            ok = parseFloat(argv[i], safetyThreshold);
+            ++positional;
+        }
+        if (!ok) {
+            std::cerr << "Error parsing command-line arguments: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if (cycles == 0) {
+        cycles = 1;
+    }
+
+    DriveCycleProfile profile;
+    std::string error;
+    if (profilePath && !profile.open(profilePath, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    RadiatorMap radiator;
+    if (radiatorPath && !loadRadiatorMap(radiatorPath, radiator, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    CoolingLoopController controller(tempSetpoint, safetyThreshold);
+    if (derate) {
+        controller.enableDerating(DerateLimits{});
+    }
+    if (afterrun) {
+        controller.enableAfterrun(AfterrunLimits{});
+    }
+    PlantModel plant(PlantParameters{}, 25.0f);
+    if (radiatorPath) {
+        plant.setRadiatorMap(&radiator);
+    }
+    PowerStageJunctions junctions(plant.temperature());
+    JunctionLimits limits;
+    limits.junctionLimit = junctionLimit;
+    JunctionHeadroom headroom(limits);
+    float setpointRaise = 0.0f;
+    float inverterShare = INVERTER_LOSS_SHARE;
+
+    // Forecast of the heat load: the same drive cycle, read one horizon ahead of the plant
+    PreCoolingOptions preCooling;
+    LoadForecast forecast(preCooling.horizon, preCooling.stepSeconds);
+    PreCoolingPlanner planner(PlantParameters{}, preCooling);
+    DriveCycleProfile ahead;
+    if (lookahead && profilePath && !ahead.open(profilePath, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    double forecastUntil = 0.0; // Forecast filled up to this time (s)
+    float coolingFloor = 0.0f;
+
+    // Afterrun and soak timers, in 1 ms ticks
+    TimerWheel timers(2);
+    bool afterrunExpired = false;
+    bool afterrunSoaked = false;
+    float soakLoad = 0.0f;   // Heat load at key-off (W)
+    float afterrunSeconds = 0.0f;
+    float keyOffPeak = 0.0f; // Peak coolant temperature after key-off
+
+    double pumpSum = 0.0, fanSum = 0.0;
+    float maxTemperature = plant.temperature();
+    float minAllowedPower = 100.0f;
+    float maxJunction = plant.temperature();
+    unsigned long checksum = 0; // Keeps the CAN encoding live
+    long cycle = 0;
+
+    if (trace) {
+        std::cout << "time,temperature,pump,fan,state\n";
+    }
+    for (; cycle < cycles; ++cycle) {
+        float now = static_cast<float>(cycle) * dt;
+        if (profilePath) {
+            DriveCycleSample sample;
+            if (!profile.at(static_cast<double>(cycle) * dt, sample)) {
+                if (!profile.error().empty()) {
+                    std::cerr << profilePath << ": " << profile.error() << "\n";
+                    return 1;
+                }
+                break; // End of the drive cycle
+            }
+            plant.setHeatLoad(sample.inverterLoss + sample.dcdcLoss);
+            float total = sample.inverterLoss + sample.dcdcLoss;
+            inverterShare = total > 0.0f ? sample.inverterLoss / total : INVERTER_LOSS_SHARE;
+            plant.setAmbientTemperature(sample.ambient);
+            planner.setAmbientTemperature(sample.ambient);
+            plant.setVehicleSpeed(sample.speed);
+        } else {
+            plant.setHeatLoad(driveProfileHeatLoad(now));
+        }
+        const bool ignition = keyOff < 0.0f || now < keyOff;
+        if (!ignition) {
+            if (soakLoad == 0.0f) soakLoad = SOAK_SHARE * plant.heatLoad();
+            plant.setHeatLoad(soakLoad * std::exp(-(now - keyOff) / SOAK_SECONDS));
+        }
+
+        SensorInputs inputs{plant.sensorVoltage(), ignition, true};
+        inputs.afterrunExpired = afterrunExpired;
+        inputs.afterrunSoaked = afterrunSoaked;
+        inputs.setpointRaise = setpointRaise;
+        inputs.coolingFloor = coolingFloor;
+        const ControlOutputs& out = controller.step(inputs);
+        if (out.afterrunSeconds > 0.0f) {
+            afterrunSeconds = out.afterrunSeconds;
+            timers.arm(static_cast<std::uint64_t>(out.afterrunSeconds * 1000.0f), 0,
+                       static_cast<std::uint16_t>(LoopTimer::AFTERRUN));
+            timers.arm(static_cast<std::uint64_t>(out.soakSeconds * 1000.0f), 0,
+                       static_cast<std::uint16_t>(LoopTimer::SOAK));
+        }
+        afterrunExpired = false;
+        timers.advance(static_cast<std::uint64_t>(dt * 1000.0f),
+                       [&afterrunExpired, &afterrunSoaked](std::uint32_t, std::uint16_t kind) {
+                           if (kind == static_cast<std::uint16_t>(LoopTimer::SOAK)) {
+                               afterrunSoaked = true;
+                           } else {
+                               afterrunExpired = true;
+                           }
+                       });
+        CANFrame frame = encodeCANFrame(out.pumpSpeed, out.fanSpeed);
+        checksum += frame.data[2] + frame.data[6];
+        if (out.allowedPower < 100.0f) {
+            plant.setHeatLoad(plant.heatLoad() * out.allowedPower / 100.0f); // Losses follow the power limit
+            if (out.allowedPower < minAllowedPower) minAllowedPower = out.allowedPower;
+        }
+
+        plant.step(dt, out.pumpSpeed, out.fanSpeed);
+        if (junctionLimit > 0.0f) {
+            float loss = plant.heatLoad();
+            float hottest = junctions.update(loss * inverterShare, loss * (1.0f - inverterShare),
+                                             plant.inletTemperature(), plant.temperature(), dt);
+            setpointRaise = headroom.update(hottest, plant.temperature(), tempSetpoint, dt);
+            if (hottest > maxJunction) maxJunction = hottest;
+        }
+        if (lookahead) {
+            double end = static_cast<double>(cycle + 1) * dt;
+            forecast.advance(dt);
+            if (profilePath) {
+                readForecast(ahead, forecast, end, forecastUntil);
+            }
+            for (; !profilePath && forecastUntil < end + preCooling.horizon * preCooling.stepSeconds;
+                 forecastUntil += preCooling.stepSeconds) {
+                float seconds = static_cast<float>(forecastUntil);
+                forecast.set(static_cast<float>(forecastUntil - end), driveProfileHeatLoad(seconds));
+            }
+            coolingFloor = planner.plan(plant.temperature(), tempSetpoint, forecast);
+        }
+        pumpSum += out.pumpSpeed;
+        fanSum += out.fanSpeed;
+        if (plant.temperature() > maxTemperature) maxTemperature = plant.temperature();
+        if (!ignition && plant.temperature() > keyOffPeak) keyOffPeak = plant.temperature();
+
+        if (trace) {
+            std::cout << now << "," << plant.temperature() << "," << out.pumpSpeed << ","
+                      << out.fanSpeed << "," << static_cast<int>(out.state) << "\n";
+        }
+        if (out.state == SystemState::SAFETY_SHUTDOWN) {
+            ++cycle;
+            break;
+        }
+    }
+
+    std::cout << "Simulated " << cycle << " cycles (" << cycle * dt << " s)\n";
+    const char* finalState = "ON";
+    switch (controller.state()) {
+        case SystemState::OFF: finalState = "OFF"; break;
+        case SystemState::ON: finalState = "ON"; break;
+        case SystemState::SAFETY_SHUTDOWN: finalState = "SAFETY_SHUTDOWN"; break;
+        case SystemState::AFTERRUN: finalState = "AFTERRUN"; break;
+    }
+    std::cout << "Final state: " << finalState << "\n";
+    std::cout << "Final temperature: " << plant.temperature() << "°C, peak " << maxTemperature << "°C\n";
+    std::cout << "Mean pump speed: " << pumpSum / cycle << "%, mean fan speed: " << fanSum / cycle << "%\n";
+    if (derate) {
+        std::cout << "Lowest allowed power: " << minAllowedPower << "%\n";
+    }
+    if (junctionLimit > 0.0f) {
+        std::cout << "Peak junction temperature: " << maxJunction << "°C, requested setpoint raise "
+                  << headroom.value() << " K\n";
+    }
+    if (keyOff >= 0.0f) {
+        std::cout << "Peak after key-off: " << keyOffPeak << "°C, afterrun " << afterrunSeconds << " s\n";
+    }
+    std::cout << "CAN checksum: " << checksum << "\n";
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include "Actuators.h"
+
+#include <iostream>
+
+static ActuatorDriver* actuatorDriver = nullptr;
+
+void setActuatorDriver(ActuatorDriver* driver) {
+    actuatorDriver = driver;
+}
+
+// Function to control the pump
+void controlPump(float speed) {
+    if (actuatorDriver) {
+        actuatorDriver->setPump(speed);
+        return;
+    }
+    std::cout << "Pump running at " << speed << "% speed.\n";
+}
+
+// Function to control the fan
+void controlFan(float speed) {
+    if (actuatorDriver) {
+        actuatorDriver->setFan(speed);
+        return;
+    }
+    std::cout << "Fan running at " << speed << "% speed.\n";
+}
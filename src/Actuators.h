@@ -0,0 +1,26 @@
+/*
+Pump and fan outputs (EMP WP32 pump, VA97 fan).
+*/
+
+#ifndef COOLINGLOOP_ACTUATORS_H
+#define COOLINGLOOP_ACTUATORS_H
+
+// Driver behind controlPump() and controlFan(). Without one the commands are printed; the
+// HIL link (PlantLink, see PlantServer.h) sends them to the plant server instead.
+class ActuatorDriver {
+public:
+    virtual ~ActuatorDriver() = default;
+    virtual void setPump(float speed) = 0;
+    virtual void setFan(float speed) = 0;
+};
+
+// Route the commands to driver (nullptr: back to the console)
+void setActuatorDriver(ActuatorDriver* driver);
+
+// Function to control the pump
+void controlPump(float speed);
+
+// Function to control the fan
+void controlFan(float speed);
+
+#endif // COOLINGLOOP_ACTUATORS_H
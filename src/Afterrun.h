@@ -0,0 +1,37 @@
+/*
+Afterrun: cooling after key-off. When the ignition goes off, the inverter and DC-DC
+converter still hold the heat of the last minutes of driving in their baseplates and cold
+plates. With the pump and fan stopped it soaks into the standing coolant and the power
+stage, and the temperature peaks after the vehicle is parked.
+
+Instead of going OFF, a hot loop goes to AFTERRUN and keeps pump and fan at a fixed, quiet
+speed for a time calculated at key-off: the soak time plus the time to bring the coolant
+down to the end temperature. The controller has no clock; it reports the time in the
+cycle it enters AFTERRUN (ControlOutputs::afterrunSeconds and soakSeconds), and its owner
+arms timers (LoopTimer::AFTERRUN and SOAK in TimerWheel.h) and reports their expiry
+(SensorInputs::afterrunExpired and afterrunSoaked). Afterrun ends early once the soak time
+is over and the coolant is below the end temperature: right after key-off the standing
+coolant reads cool while the baseplates are still hot. The ignition coming back on returns
+to ON; low coolant and, without derating, overtemperature shut down as in ON.
+*/
+
+#ifndef COOLINGLOOP_AFTERRUN_H
+#define COOLINGLOOP_AFTERRUN_H
+
+struct AfterrunLimits {
+    float endTemperature = 45.0f;   // No afterrun at or below this coolant temperature; ends there (°C)
+    float secondsPerKelvin = 20.0f; // Cool-down time per K above the end temperature at afterrun speed
+    float soakSeconds = 60.0f;      // Heat soaking out of the power stage after key-off (s)
+    float maximumSeconds = 900.0f;  // Longest afterrun, for the 12 V battery (s)
+    float pumpSpeed = 60.0f;        // %
+    float fanSpeed = 40.0f;         // %
+};
+
+// Afterrun time (s) for the coolant temperature at key-off (°C); 0 for none
+inline float afterrunDuration(const AfterrunLimits& limits, float temperature) {
+    if (!(temperature > limits.endTemperature)) return 0.0f;
+    float seconds = limits.soakSeconds + limits.secondsPerKelvin * (temperature - limits.endTemperature);
+    return seconds < limits.maximumSeconds ? seconds : limits.maximumSeconds;
+}
+
+#endif // COOLINGLOOP_AFTERRUN_H
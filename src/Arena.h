@@ -0,0 +1,53 @@
+/*
+Fixed-capacity allocator for runtime structures.
+
+The controller and the emulated plant of the application are carved out of static storage
+at startup, so the steady-state cycle never touches the heap (heap calls cause jitter on the
+PLC target). The arena returns nullptr when exhausted instead of throwing.
+*/
+
+#ifndef COOLINGLOOP_ARENA_H
+#define COOLINGLOOP_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bump allocator over a caller-provided buffer. Objects are never freed individually;
+// reset() releases everything at once. Destructors are not run, so only trivially
+// destructible types may be created in it.
+class MonotonicArena {
+private:
+    unsigned char* base;
+    std::size_t capacity;
+    std::size_t used;
+
+public:
+    MonotonicArena(void* buffer, std::size_t size)
+        : base(static_cast<unsigned char*>(buffer)), capacity(size), used(0) {}
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(base) + used;
+        std::size_t offset = used + (((address + alignment - 1) & ~(alignment - 1)) - address);
+        if (offset + size > capacity) {
+            return nullptr;
+        }
+        used = offset + size;
+        return base + offset;
+    }
+
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        void* memory = allocate(sizeof(T), alignof(T));
+        return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    void reset() { used = 0; }
+    std::size_t bytesUsed() const { return used; }
+    std::size_t bytesFree() const { return capacity - used; }
+};
+
+#endif // COOLINGLOOP_ARENA_H
@@ -0,0 +1,85 @@
+#include "CANBus.h"
+
+#include <iostream>
+
+// Encode pump and fan speeds into the CAN message
+CANFrame encodeCANFrame(float pumpSpeed, float fanSpeed, const CANLayout& layout) {
+    CANFrame frame{layout.id, layout.dlc, {0}}; // CAN ID for the message, Data Length Code
+
+    // Encode speeds into CAN message
+    frame.data[layout.pumpByte] = static_cast<unsigned char>(pumpSpeed / 100 * 255); // Scale pump speed to 0-255
+    frame.data[layout.fanByte] = static_cast<unsigned char>(fanSpeed / 100 * 255);   // Scale fan speed to 0-255
+    return frame;
+}
+
+// Decode pump and fan speeds on the receiving side (motor controllers)
+void decodeCANFrame(const CANFrame& frame, float& pumpSpeed, float& fanSpeed, const CANLayout& layout) {
+    pumpSpeed = frame.data[layout.pumpByte] * 100.0f / 255.0f;
+    fanSpeed = frame.data[layout.fanByte] * 100.0f / 255.0f;
+}
+
+// Print a CAN message in hex, leaving the format of std::cout as it was
+void printCANFrame(const CANFrame& frame) {
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::cout << "CANID: 0x" << std::hex << std::uppercase << frame.id << "\n";
+    std::cout << "MSG: ";
+    for (int i = 0; i < frame.dlc; ++i) {
+        std::cout << "0x" << static_cast<int>(frame.data[i]) << " ";
+    }
+    std::cout << "\n";
+    std::cout.flags(flags);
+}
+
+// Simulate CAN Bus control messages
+void CANcontrol(float pumpSpeed, float fanSpeed, const CANLayout& layout) {
+    printCANFrame(encodeCANFrame(pumpSpeed, fanSpeed, layout));
+}
+
+// Encode the allowed power of the inverter and the DC-DC converter
+CANFrame encodeDerateFrame(float inverterPower, float dcdcPower, const DerateLayout& layout) {
+    CANFrame frame{layout.id, layout.dlc, {0}};
+    frame.data[layout.inverterByte] = static_cast<unsigned char>(inverterPower / 100 * 255);
+    frame.data[layout.dcdcByte] = static_cast<unsigned char>(dcdcPower / 100 * 255);
+    return frame;
+}
+
+// Decode the allowed power on the receiving side (inverter and DC-DC converter)
+void decodeDerateFrame(const CANFrame& frame, float& inverterPower, float& dcdcPower, const DerateLayout& layout) {
+    inverterPower = frame.data[layout.inverterByte] * 100.0f / 255.0f;
+    dcdcPower = frame.data[layout.dcdcByte] * 100.0f / 255.0f;
+}
+
+// Simulate the derating message
+void CANderate(float inverterPower, float dcdcPower, const DerateLayout& layout) {
+    printCANFrame(encodeDerateFrame(inverterPower, dcdcPower, layout));
+}
+
+namespace {
+
+// 16-bit little-endian field, rounded and clamped to its range
+void putField(unsigned char* data, float value) {
+    long raw = value > 0.0f ? static_cast<long>(value + 0.5f) : 0;
+    if (raw > 65535) raw = 65535;
+    data[0] = static_cast<unsigned char>(raw);
+    data[1] = static_cast<unsigned char>(raw >> 8);
+}
+
+float getField(const unsigned char* data) {
+    return static_cast<float>(data[0] | (data[1] << 8));
+}
+
+} // namespace
+
+// Encode a heat-load forecast point
+CANFrame encodeForecastFrame(float secondsAhead, float heatLoad, const ForecastLayout& layout) {
+    CANFrame frame{layout.id, layout.dlc, {0}};
+    putField(frame.data + layout.secondsByte, secondsAhead);
+    putField(frame.data + layout.loadByte, heatLoad / 10.0f);
+    return frame;
+}
+
+// Decode a heat-load forecast point on the cooling controller
+void decodeForecastFrame(const CANFrame& frame, float& secondsAhead, float& heatLoad, const ForecastLayout& layout) {
+    secondsAhead = getField(frame.data + layout.secondsByte);
+    heatLoad = getField(frame.data + layout.loadByte) * 10.0f;
+}
@@ -0,0 +1,77 @@
+/*
+CAN Bus messages for the pump and fan motor controllers.
+Encodes messages with a predefined CAN ID 18FF408F such that, motor can be controlled by this.
+*/
+
+#ifndef COOLINGLOOP_CAN_BUS_H
+#define COOLINGLOOP_CAN_BUS_H
+
+// CAN frame as it is put on the bus
+struct CANFrame {
+    unsigned int id;
+    unsigned char dlc;
+    unsigned char data[8];
+};
+
+// Where the pump and fan commands sit in the message (0-255 = 0-100%)
+struct CANLayout {
+    unsigned int id;
+    unsigned char dlc;
+    unsigned char pumpByte;
+    unsigned char fanByte;
+};
+
+// ID 18FF408F, pump in byte 2, fan in byte 6
+const CANLayout DEFAULT_CAN_LAYOUT = {0x18FF408F, 8, 2, 6};
+
+// Print a CAN message on std::cout (ID and data bytes in hex)
+void printCANFrame(const CANFrame& frame);
+
+// Encode pump and fan speeds into the CAN message
+CANFrame encodeCANFrame(float pumpSpeed, float fanSpeed, const CANLayout& layout = DEFAULT_CAN_LAYOUT);
+
+// Decode pump and fan speeds on the receiving side (motor controllers)
+void decodeCANFrame(const CANFrame& frame, float& pumpSpeed, float& fanSpeed,
+                    const CANLayout& layout = DEFAULT_CAN_LAYOUT);
+
+// Simulate CAN Bus control messages
+void CANcontrol(float pumpSpeed, float fanSpeed, const CANLayout& layout = DEFAULT_CAN_LAYOUT);
+
+// Where the allowed power of the inverter and the DC-DC converter sit in the derating message
+// (0-255 = 0-100%, rounded down so a limit is never exceeded)
+struct DerateLayout {
+    unsigned int id;
+    unsigned char dlc;
+    unsigned char inverterByte;
+    unsigned char dcdcByte;
+};
+
+// ID 18FF418F, inverter in byte 0, DC-DC in byte 1
+const DerateLayout DEFAULT_DERATE_LAYOUT = {0x18FF418F, 8, 0, 1};
+
+CANFrame encodeDerateFrame(float inverterPower, float dcdcPower, const DerateLayout& layout = DEFAULT_DERATE_LAYOUT);
+void decodeDerateFrame(const CANFrame& frame, float& inverterPower, float& dcdcPower,
+                       const DerateLayout& layout = DEFAULT_DERATE_LAYOUT);
+
+// Simulate the derating message
+void CANderate(float inverterPower, float dcdcPower, const DerateLayout& layout = DEFAULT_DERATE_LAYOUT);
+
+// Heat-load forecast point from the vehicle controller: from secondsAhead on, the inverter and
+// DC-DC losses are expected at heatLoad (see PreCooling.h). Both fields are 16-bit little-endian,
+// the time in s (up to 65535), the load in 10 W units (up to 655 kW).
+struct ForecastLayout {
+    unsigned int id;
+    unsigned char dlc;
+    unsigned char secondsByte; // First byte of the time ahead
+    unsigned char loadByte;    // First byte of the heat load
+};
+
+// ID 18FF428F, time ahead in bytes 0-1, heat load in bytes 2-3
+const ForecastLayout DEFAULT_FORECAST_LAYOUT = {0x18FF428F, 8, 0, 2};
+
+CANFrame encodeForecastFrame(float secondsAhead, float heatLoad,
+                             const ForecastLayout& layout = DEFAULT_FORECAST_LAYOUT);
+void decodeForecastFrame(const CANFrame& frame, float& secondsAhead, float& heatLoad,
+                         const ForecastLayout& layout = DEFAULT_FORECAST_LAYOUT);
+
+#endif // COOLINGLOOP_CAN_BUS_H
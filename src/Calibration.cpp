@@ -0,0 +1,274 @@
+#include "Calibration.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Checksum.h"
+#include "CommandLine.h"
+#include "SensorDiagnostics.h"
+#include "SensorVoting.h"
+
+namespace {
+
+// Largest 29-bit extended CAN identifier
+const std::uint32_t MAX_CAN_ID = 0x1FFFFFFF;
+
+bool allFinite(const float* values, std::uint32_t count) {
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (!std::isfinite(values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::uint32_t imageChecksum(const CalibrationImage& image) {
+    CalibrationImage copy = image;
+    copy.checksum = 0;
+    return fnv1a(reinterpret_cast<const unsigned char*>(&copy), sizeof(copy));
+}
+
+void seal(CalibrationImage& image) {
+    image.magic = CALIBRATION_MAGIC;
+    image.version = CALIBRATION_VERSION;
+    image.size = sizeof(CalibrationImage);
+    image.checksum = imageChecksum(image);
+}
+
+CalibrationImage buildDefaultCalibration() {
+    CalibrationImage image;
+    std::memset(&image, 0, sizeof(image));
+    const SensorTable& table = defaultSensorTable();
+    image.sensorPoints = static_cast<std::uint32_t>(table.size);
+    for (int i = 0; i < table.size; ++i) {
+        image.sensorTemperature[i] = table.temperature[i];
+        image.sensorVoltage[i] = table.voltage[i];
+    }
+    SensorLimits limits;
+    image.openVoltage = limits.openVoltage;
+    image.shortVoltage = limits.shortVoltage;
+    image.maxStep = limits.maxStep;
+    image.maxSpread = VotingLimits().maxSpread;
+    const float pumpGains[3] = {-0.5f, -0.1f, -0.05f}; // Tuned values for pump
+    const float fanGains[3] = {-0.4f, -0.1f, -0.03f};  // Tuned values for fan
+    std::memcpy(image.pumpGains, pumpGains, sizeof(pumpGains));
+    std::memcpy(image.fanGains, fanGains, sizeof(fanGains));
+    image.setpoint = 50.0f;
+    image.threshold = 70.0f;
+    image.canId = DEFAULT_CAN_LAYOUT.id;
+    image.canDlc = DEFAULT_CAN_LAYOUT.dlc;
+    image.canPumpByte = DEFAULT_CAN_LAYOUT.pumpByte;
+    image.canFanByte = DEFAULT_CAN_LAYOUT.fanByte;
+    seal(image);
+    return image;
+}
+
+// Whole-argument unsigned integer in any C base (0x18FF408F, 8)
+bool parseUnsigned(const char* text, std::uint32_t& value) {
+    if (!text || !*text || *text == '-') {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    unsigned long parsed = std::strtoul(text, &end, 0);
+    if (*end != '\0' || errno == ERANGE || parsed > 0xFFFFFFFFul) {
+        return false;
+    }
+    value = static_cast<std::uint32_t>(parsed);
+    return true;
+}
+
+bool parseFloats(std::istringstream& line, float* values, int count) {
+    std::string token;
+    for (int i = 0; i < count; ++i) {
+        if (!(line >> token) || !parseFloat(token.c_str(), values[i])) {
+            return false;
+        }
+    }
+    return !(line >> token);
+}
+
+} // namespace
+
+const CalibrationImage& defaultCalibration() {
+    static const CalibrationImage image = buildDefaultCalibration();
+    return image;
+}
+
+SensorTable sensorTable(const CalibrationImage& image) {
+    return SensorTable{image.sensorTemperature, image.sensorVoltage, static_cast<int>(image.sensorPoints)};
+}
+
+CANLayout canLayout(const CalibrationImage& image) {
+    return CANLayout{image.canId, static_cast<unsigned char>(image.canDlc), static_cast<unsigned char>(image.canPumpByte),
+                     static_cast<unsigned char>(image.canFanByte)};
+}
+
+// Checksum and bounds check of an image in memory
+bool validateCalibrationImage(const void* data, std::size_t size) {
+    if (size != sizeof(CalibrationImage)) {
+        return false;
+    }
+    const CalibrationImage& image = *static_cast<const CalibrationImage*>(data);
+    if (image.magic != CALIBRATION_MAGIC || image.version != CALIBRATION_VERSION ||
+        image.size != sizeof(CalibrationImage) || image.checksum != imageChecksum(image)) {
+        return false;
+    }
+    if (image.sensorPoints < 2 || image.sensorPoints > MAX_CALIBRATION_POINTS) {
+        return false;
+    }
+    if (!allFinite(image.sensorTemperature, image.sensorPoints) || !allFinite(image.sensorVoltage, image.sensorPoints)) {
+        return false;
+    }
+    for (std::uint32_t i = 1; i < image.sensorPoints; ++i) {
+        if (!(image.sensorTemperature[i] > image.sensorTemperature[i - 1]) ||
+            !(image.sensorVoltage[i] < image.sensorVoltage[i - 1])) {
+            return false;
+        }
+    }
+
+    // Non-finite gains or limits would reach the outputs, and the float-to-byte cast of the
+    // CAN frame, as NaN
+    const float limits[] = {image.openVoltage, image.shortVoltage, image.maxStep, image.maxSpread,
+                            image.setpoint, image.threshold};
+    if (!allFinite(limits, 6) || !allFinite(image.pumpGains, 3) || !allFinite(image.fanGains, 3)) {
+        return false;
+    }
+    if (!(image.shortVoltage < image.openVoltage) || !(image.maxStep > 0.0f) || !(image.maxSpread > 0.0f) ||
+        !(image.setpoint < image.threshold)) {
+        return false;
+    }
+    return image.canId <= MAX_CAN_ID && image.canDlc <= 8 && image.canPumpByte < image.canDlc &&
+           image.canFanByte < image.canDlc;
+}
+
+// Parse the text calibration
+bool parseCalibration(std::istream& in, CalibrationImage& image, std::string& error) {
+    std::memset(&image, 0, sizeof(image));
+    std::string text;
+    int lineNumber = 0;
+    while (std::getline(in, text)) {
+        ++lineNumber;
+        std::string::size_type comment = text.find('#');
+        if (comment != std::string::npos) {
+            text.erase(comment);
+        }
+        std::istringstream line(text);
+        std::string keyword, token;
+        if (!(line >> keyword)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (keyword == "sensor") {
+            float point[2];
+            ok = image.sensorPoints < MAX_CALIBRATION_POINTS && parseFloats(line, point, 2);
+            if (ok) {
+                image.sensorTemperature[image.sensorPoints] = point[0];
+                image.sensorVoltage[image.sensorPoints] = point[1];
+                ++image.sensorPoints;
+            }
+        } else if (keyword == "pump_pid") {
+            ok = parseFloats(line, image.pumpGains, 3);
+        } else if (keyword == "fan_pid") {
+            ok = parseFloats(line, image.fanGains, 3);
+        } else if (keyword == "open_voltage") {
+            ok = parseFloats(line, &image.openVoltage, 1);
+        } else if (keyword == "short_voltage") {
+            ok = parseFloats(line, &image.shortVoltage, 1);
+        } else if (keyword == "max_step") {
+            ok = parseFloats(line, &image.maxStep, 1);
+        } else if (keyword == "max_spread") {
+            ok = parseFloats(line, &image.maxSpread, 1);
+        } else if (keyword == "setpoint") {
+            ok = parseFloats(line, &image.setpoint, 1);
+        } else if (keyword == "threshold") {
+            ok = parseFloats(line, &image.threshold, 1);
+        } else if (keyword == "can_id" || keyword == "can_dlc" || keyword == "can_pump_byte" ||
+                   keyword == "can_fan_byte") {
+            std::uint32_t& field = keyword == "can_id"    ? image.canId
+                                   : keyword == "can_dlc" ? image.canDlc
+                                   : keyword == "can_pump_byte" ? image.canPumpByte
+                                                                : image.canFanByte;
+            ok = (line >> token) && parseUnsigned(token.c_str(), field) && !(line >> token);
+        } else {
+            error = "line " + std::to_string(lineNumber) + ": unknown keyword '" + keyword + "'";
+            return false;
+        }
+        if (!ok) {
+            error = "line " + std::to_string(lineNumber) + ": bad value for '" + keyword + "'";
+            return false;
+        }
+    }
+
+    seal(image);
+    if (!validateCalibrationImage(&image, sizeof(image))) {
+        error = "sensor table must have 2-16 points with rising temperature and falling voltage, all "
+                "values must be finite with short_voltage below open_voltage, positive max_step and "
+                "max_spread and setpoint below threshold, and the CAN ID must fit 29 bits with the "
+                "CAN bytes within can_dlc (at most 8)";
+        return false;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+
+// Map an image file read-only
+const CalibrationImage* mapCalibrationImage(const char* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) == sizeof(CalibrationImage)) {
+        mapping = ::mmap(nullptr, sizeof(CalibrationImage), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    if (!validateCalibrationImage(mapping, sizeof(CalibrationImage))) {
+        ::munmap(mapping, sizeof(CalibrationImage));
+        return nullptr;
+    }
+    return static_cast<const CalibrationImage*>(mapping);
+}
+
+void unmapCalibrationImage(const CalibrationImage* image) {
+    if (image) {
+        ::munmap(const_cast<CalibrationImage*>(image), sizeof(CalibrationImage));
+    }
+}
+
+#else
+
+// No mmap: read the image into one static slot instead
+const CalibrationImage* mapCalibrationImage(const char* path) {
+    static CalibrationImage slot;
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return nullptr;
+    }
+    unsigned char extra;
+    bool ok = std::fread(&slot, 1, sizeof(slot), file) == sizeof(slot) && std::fread(&extra, 1, 1, file) == 0;
+    std::fclose(file);
+    return ok && validateCalibrationImage(&slot, sizeof(slot)) ? &slot : nullptr;
+}
+
+void unmapCalibrationImage(const CalibrationImage*) {}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+Calibration image: sensor table, plausibility limits, PID gains, setpoints and CAN layout
+in one read-only binary file.
+
+The text calibration (config/calibration.txt) is parsed at build time by CalibrationBake,
+which writes calibration.img next to the binaries. At startup the application maps the
+image and uses it in place: there is no parsing, no table building and no allocation
+between process start and the first pump command. The image is a fixed-layout struct of
+32-bit little-endian fields, so it can only be mapped on a little-endian target; a mapped
+image is validated (magic, version, size, checksum, table and CAN bounds) before use.
+*/
+
+#ifndef COOLINGLOOP_CALIBRATION_H
+#define COOLINGLOOP_CALIBRATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "CANBus.h"
+#include "TemperatureSensor.h"
+
+const std::uint32_t CALIBRATION_MAGIC = 0x49434C43; // "CLCI"
+const std::uint32_t CALIBRATION_VERSION = 1;
+const int MAX_CALIBRATION_POINTS = 16;
+const float CALIBRATION_PERIOD = 1.0f; // Control period the per-cycle values are tuned for (s)
+
+struct CalibrationImage {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t size;     // sizeof(CalibrationImage)
+    std::uint32_t checksum; // FNV-1a over the image with this field set to 0
+
+    // Temperature sensor table (see SensorTable)
+    std::uint32_t sensorPoints;
+    float sensorTemperature[MAX_CALIBRATION_POINTS];
+    float sensorVoltage[MAX_CALIBRATION_POINTS];
+
+    // Plausibility and voting limits (maxStep per cycle of CALIBRATION_PERIOD)
+    float openVoltage;
+    float shortVoltage;
+    float maxStep;
+    float maxSpread;
+
+    // PID gains (Kp, Ki, Kd), Ki and Kd per cycle of CALIBRATION_PERIOD
+    float pumpGains[3];
+    float fanGains[3];
+
+    // Default setpoint and safety threshold (°C)
+    float setpoint;
+    float threshold;
+
+    // Pump and fan command message
+    std::uint32_t canId;
+    std::uint32_t canDlc;
+    std::uint32_t canPumpByte;
+    std::uint32_t canFanByte;
+};
+
+static_assert(sizeof(CalibrationImage) == 4 * (5 + 2 * MAX_CALIBRATION_POINTS + 4 + 6 + 2 + 4),
+              "calibration image must not contain padding");
+
+// Built-in calibration, identical to config/calibration.txt
+const CalibrationImage& defaultCalibration();
+
+// Views of the image in the types the controller and CAN code use
+SensorTable sensorTable(const CalibrationImage& image);
+CANLayout canLayout(const CalibrationImage& image);
+
+// Checksum and bounds check of an image in memory
+bool validateCalibrationImage(const void* data, std::size_t size);
+
+// Parse the text calibration (build time only). Returns false and fills error (with the line
+// number) on bad input; the result is sealed with its checksum.
+bool parseCalibration(std::istream& in, CalibrationImage& image, std::string& error);
+
+// Map an image file read-only. Returns nullptr if it cannot be mapped or does not validate.
+// The mapping stays valid until unmapCalibrationImage().
+const CalibrationImage* mapCalibrationImage(const char* path);
+void unmapCalibrationImage(const CalibrationImage* image);
+
+#endif // COOLINGLOOP_CALIBRATION_H
@@ -0,0 +1,216 @@
+#include "Checkpoint.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "Checksum.h"
+#include "CoolingLoopController.h"
+
+namespace {
+
+const unsigned char CHECKPOINT_MAGIC[4] = {'C', 'L', 'C', 'S'};
+const std::size_t HEADER_SIZE = 8;
+const std::size_t PAYLOAD_SIZE = CHECKPOINT_SIZE - HEADER_SIZE - 4;
+
+// Little-endian field writer over a fixed buffer
+class SnapshotWriter {
+private:
+    unsigned char* out;
+
+public:
+    explicit SnapshotWriter(unsigned char* buffer) : out(buffer) {}
+
+    void u8(std::uint8_t value) { *out++ = value; }
+    void u16(std::uint16_t value) {
+        u8(static_cast<std::uint8_t>(value));
+        u8(static_cast<std::uint8_t>(value >> 8));
+    }
+    void u32(std::uint32_t value) {
+        u16(static_cast<std::uint16_t>(value));
+        u16(static_cast<std::uint16_t>(value >> 16));
+    }
+    void f32(float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u32(bits);
+    }
+};
+
+// Little-endian field reader; the caller has checked the length
+class SnapshotReader {
+private:
+    const unsigned char* in;
+
+public:
+    explicit SnapshotReader(const unsigned char* buffer) : in(buffer) {}
+
+    std::uint8_t u8() { return *in++; }
+    std::uint16_t u16() {
+        std::uint16_t low = u8();
+        return static_cast<std::uint16_t>(low | (u8() << 8));
+    }
+    std::uint32_t u32() {
+        std::uint32_t low = u16();
+        return low | (static_cast<std::uint32_t>(u16()) << 16);
+    }
+    float f32() {
+        std::uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+} // namespace
+
+// Serialise the dynamic state of the controller
+std::size_t CoolingLoopController::saveCheckpoint(unsigned char* buffer, std::size_t size) const {
+    if (size < CHECKPOINT_SIZE) {
+        return 0;
+    }
+    SnapshotWriter writer(buffer);
+    for (unsigned char byte : CHECKPOINT_MAGIC) {
+        writer.u8(byte);
+    }
+    writer.u16(CHECKPOINT_VERSION);
+    writer.u16(static_cast<std::uint16_t>(PAYLOAD_SIZE));
+
+    writer.f32(tempSetpoint);
+    writer.f32(safetyThreshold);
+    writer.u8(static_cast<std::uint8_t>(outputs.state));
+    writer.u8(static_cast<std::uint8_t>(outputs.cause));
+    writer.u8(static_cast<std::uint8_t>(outputs.sensorStatus));
+    writer.u8(outputs.activeSensors);
+    writer.u8(static_cast<std::uint8_t>((hasPreviousVoltage ? 1 : 0) | (outputs.sensorDisagreement ? 2 : 0)));
+    writer.f32(outputs.measuredTemperature);
+    writer.f32(outputs.pumpSpeed);
+    writer.f32(outputs.fanSpeed);
+    PIDState pump = pumpPID.state();
+    PIDState fan = fanPID.state();
+    writer.f32(pump.prevError);
+    writer.f32(pump.integral);
+    writer.f32(fan.prevError);
+    writer.f32(fan.integral);
+    for (float voltage : previousVoltage) {
+        writer.f32(voltage);
+    }
+    writer.f32(outputs.allowedPower);
+    writer.u32(fnv1a(buffer, CHECKPOINT_SIZE - 4));
+    return CHECKPOINT_SIZE;
+}
+
+// Restore a snapshot taken by saveCheckpoint()
+bool CoolingLoopController::restoreCheckpoint(const unsigned char* buffer, std::size_t size, bool warmRestart) {
+    if (size != CHECKPOINT_SIZE || std::memcmp(buffer, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        return false;
+    }
+    SnapshotReader reader(buffer + sizeof(CHECKPOINT_MAGIC));
+    if (reader.u16() != CHECKPOINT_VERSION || reader.u16() != PAYLOAD_SIZE) {
+        return false;
+    }
+    if (SnapshotReader(buffer + CHECKPOINT_SIZE - 4).u32() != fnv1a(buffer, CHECKPOINT_SIZE - 4)) {
+        return false;
+    }
+
+    // State tuned for other setpoints would not be a smooth continuation
+    float setpoint = reader.f32();
+    float threshold = reader.f32();
+    if (setpoint != tempSetpoint || threshold != safetyThreshold) {
+        return false;
+    }
+    std::uint8_t state = reader.u8();
+    std::uint8_t cause = reader.u8();
+    std::uint8_t sensorStatus = reader.u8();
+    if (state > static_cast<std::uint8_t>(SystemState::AFTERRUN) ||
+        cause > static_cast<std::uint8_t>(ShutdownCause::OVERTEMPERATURE) ||
+        sensorStatus > static_cast<std::uint8_t>(SensorStatus::RATE_OF_CHANGE)) {
+        return false;
+    }
+
+    ControlOutputs restored;
+    restored.state = static_cast<SystemState>(state);
+    restored.cause = static_cast<ShutdownCause>(cause);
+    restored.sensorStatus = static_cast<SensorStatus>(sensorStatus);
+    restored.activeSensors = reader.u8();
+    std::uint8_t flags = reader.u8();
+    if (restored.activeSensors >= (1u << MAX_SENSOR_CHANNELS) || (flags & ~3u) != 0) {
+        return false;
+    }
+    restored.sensorDisagreement = (flags & 2) != 0;
+    restored.measuredTemperature = reader.f32();
+    restored.pumpSpeed = reader.f32();
+    restored.fanSpeed = reader.f32();
+    PIDState pump;
+    pump.prevError = reader.f32();
+    pump.integral = reader.f32();
+    PIDState fan;
+    fan.prevError = reader.f32();
+    fan.integral = reader.f32();
+    if (!std::isfinite(restored.measuredTemperature) || !std::isfinite(pump.prevError) ||
+        !std::isfinite(pump.integral) || !std::isfinite(fan.prevError) || !std::isfinite(fan.integral) ||
+        !(restored.pumpSpeed >= 0.0f && restored.pumpSpeed <= 100.0f) ||
+        !(restored.fanSpeed >= 0.0f && restored.fanSpeed <= 100.0f)) {
+        return false;
+    }
+
+    // The afterrun timer died with the process: resume as ON, so the key-off is seen again and
+    // a new afterrun time requested
+    if (warmRestart && restored.state == SystemState::AFTERRUN) {
+        restored.state = SystemState::ON;
+    }
+
+    // A restart clears a latched shutdown, as a cold start would
+    if (warmRestart && restored.state == SystemState::SAFETY_SHUTDOWN) {
+        restored.state = SystemState::OFF;
+        restored.cause = ShutdownCause::NONE;
+        restored.pumpSpeed = 0.0f;
+        restored.fanSpeed = 0.0f;
+    }
+
+    float voltages[MAX_SENSOR_CHANNELS];
+    for (float& voltage : voltages) {
+        voltage = reader.f32();
+        if (!std::isfinite(voltage)) {
+            return false;
+        }
+    }
+    restored.allowedPower = reader.f32();
+    if (!(restored.allowedPower >= 0.0f && restored.allowedPower <= 100.0f)) {
+        return false;
+    }
+    if (restored.state == SystemState::OFF) {
+        restored.allowedPower = 100.0f;
+    }
+
+    outputs = restored;
+    pumpPID.restore(pump);
+    fanPID.restore(fan);
+    hasPreviousVoltage = (flags & 1) != 0;
+    for (int ch = 0; ch < MAX_SENSOR_CHANNELS; ++ch) {
+        previousVoltage[ch] = voltages[ch];
+    }
+    return true;
+}
+
+// Write a snapshot file atomically
+bool writeCheckpointFile(const char* path, const char* tempPath, const unsigned char* data, std::size_t size) {
+    std::FILE* file = std::fopen(tempPath, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(data, 1, size, file) == size;
+    ok = std::fclose(file) == 0 && ok;
+    return ok && std::rename(tempPath, path) == 0;
+}
+
+// Read a snapshot file
+std::size_t readCheckpointFile(const char* path, unsigned char* buffer, std::size_t size) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    std::size_t bytes = std::fread(buffer, 1, size, file);
+    std::fclose(file);
+    return bytes;
+}
@@ -0,0 +1,45 @@
+/*
+Checkpoint and warm restart of the controller state.
+
+main() writes a snapshot of the controller after every cycle and restores it at startup,
+so a supervised restart (after a crash, or after a latched SAFETY_SHUTDOWN) resumes with
+the PID integrators, sensor history and state machine where they were instead of ramping
+up from cold. A restart still clears a latched shutdown: a restored SAFETY_SHUTDOWN comes
+back as OFF.
+
+Snapshot layout, all fields little-endian and packed (CHECKPOINT_SIZE bytes in total):
+
+    0   magic "CLCS"
+    4   u16  version (CHECKPOINT_VERSION)
+    6   u16  payload length
+    8   f32  setpoint, f32 threshold           configuration the state belongs to
+    16  u8   state, cause, sensor status, active sensors, flags (bit0 sensor history, bit1 disagreement)
+    21  f32  measured temperature, pump, fan   last outputs
+    33  f32  pump PID prevError, integral
+    41  f32  fan PID prevError, integral
+    49  f32  previous voltage x3               rate-of-change history
+    61  f32  allowed power                     derating (version 2)
+    65  u32  FNV-1a over bytes 0-64
+
+A reader rejects any other version or length, so fields are only ever added with a new
+version number. It also rejects a snapshot with non-finite values, speeds outside 0-100 %,
+unknown enum values, mask or flag bits; main() then starts cold.
+*/
+
+#ifndef COOLINGLOOP_CHECKPOINT_H
+#define COOLINGLOOP_CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+
+const std::uint16_t CHECKPOINT_VERSION = 2;
+const std::size_t CHECKPOINT_SIZE = 69;
+
+// Write a snapshot to path by way of tempPath and a rename, so a reader never sees half a
+// file. Returns false on any I/O error.
+bool writeCheckpointFile(const char* path, const char* tempPath, const unsigned char* data, std::size_t size);
+
+// Read up to size bytes of a snapshot file. Returns the bytes read, 0 if there is none.
+std::size_t readCheckpointFile(const char* path, unsigned char* buffer, std::size_t size);
+
+#endif // COOLINGLOOP_CHECKPOINT_H
@@ -0,0 +1,19 @@
+/*
+FNV-1a checksum for the binary checkpoint and calibration images.
+*/
+
+#ifndef COOLINGLOOP_CHECKSUM_H
+#define COOLINGLOOP_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+inline std::uint32_t fnv1a(const unsigned char* data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#endif // COOLINGLOOP_CHECKSUM_H
@@ -0,0 +1,205 @@
+#include "CoSimulation.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "CANBus.h"
+#include "Calibration.h"
+#include "Checkpoint.h"
+#include "CoolingLoopController.h"
+
+static_assert(COOLINGLOOP_STATE_SIZE == CHECKPOINT_SIZE + 8 + 8 + 4 + 2, "co-simulation snapshot layout");
+
+// The controller holds on to its calibration, so the instance keeps its own copy
+struct CoolingLoopInstance {
+    CalibrationImage calibration;
+    CANLayout layout;
+    CoolingLoopController controller;
+    SensorInputs inputs;
+    double period;         // Control period (s)
+    double time;           // Simulated time reached (s)
+    std::uint64_t cycles;  // Control cycles run; the next one samples at cycles * period
+    CoolingLoopOutputs outputs;
+
+    CoolingLoopInstance(const CalibrationImage& image, float setpoint, float threshold, double controlPeriod)
+        : calibration(image), layout(canLayout(calibration)), controller(calibration, setpoint, threshold),
+          inputs{0.0f, false, true}, period(controlPeriod), time(0.0), cycles(0), outputs() {
+        // The calibration is tuned per CALIBRATION_PERIOD cycle
+        controller.setControlPeriod(static_cast<float>(controlPeriod));
+        publish();
+    }
+
+    // Outputs of the last cycle in the host's terms
+    void publish() {
+        const ControlOutputs& out = controller.lastOutputs();
+        outputs.pumpSpeed = out.pumpSpeed;
+        outputs.fanSpeed = out.fanSpeed;
+        outputs.measuredTemperature = out.measuredTemperature;
+        outputs.state = static_cast<int>(out.state);
+        outputs.cause = static_cast<int>(out.cause);
+        CANFrame frame = encodeCANFrame(out.pumpSpeed, out.fanSpeed, layout);
+        outputs.canId = frame.id;
+        outputs.canDlc = frame.dlc;
+        std::memcpy(outputs.canData, frame.data, sizeof(outputs.canData));
+        outputs.allowedPower = out.allowedPower;
+    }
+};
+
+namespace {
+
+// Little-endian fields after the controller checkpoint
+void putBits(unsigned char* out, std::uint64_t bits, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+}
+
+std::uint64_t getBits(const unsigned char* in, int bytes) {
+    std::uint64_t bits = 0;
+    for (int i = 0; i < bytes; ++i) {
+        bits |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return bits;
+}
+
+// Sample instants within a billionth of a period of the step end belong to the next step,
+// so accumulated rounding in the host's time never runs a cycle early
+double sampleLimit(double time, double period) {
+    return time - 1e-9 * period;
+}
+
+} // namespace
+
+extern "C" {
+
+CoolingLoopInstance* coolingLoopInstantiate(const void* calibration, size_t calibrationSize, float setpoint,
+                                            float threshold, double controlPeriod) {
+    if (!(controlPeriod > 0.0) || !std::isfinite(controlPeriod)) {
+        return nullptr;
+    }
+    CalibrationImage image = defaultCalibration();
+    if (calibration) {
+        // Copied before validation: the host's buffer need not be aligned
+        if (calibrationSize != sizeof(image)) {
+            return nullptr;
+        }
+        std::memcpy(&image, calibration, sizeof(image));
+        if (!validateCalibrationImage(&image, sizeof(image))) {
+            return nullptr;
+        }
+    }
+    return new (std::nothrow) CoolingLoopInstance(image, setpoint != 0.0f ? setpoint : image.setpoint,
+                                                  threshold != 0.0f ? threshold : image.threshold, controlPeriod);
+}
+
+void coolingLoopFreeInstance(CoolingLoopInstance* instance) {
+    delete instance;
+}
+
+CoolingLoopStatus coolingLoopEnableDerating(CoolingLoopInstance* instance, float minimumPower, float recoveryRate) {
+    if (!instance || !(minimumPower >= 0.0f && minimumPower <= 100.0f) || !(recoveryRate > 0.0f)) {
+        return COOLINGLOOP_ERROR;
+    }
+    DerateLimits limits;
+    limits.minimumPower = minimumPower;
+    limits.recoveryRate = recoveryRate;
+    instance->controller.enableDerating(limits);
+    return COOLINGLOOP_OK;
+}
+
+CoolingLoopStatus coolingLoopSetInputs(CoolingLoopInstance* instance, float sensorVoltage, int ignition,
+                                       int coolantLevel) {
+    if (!instance) {
+        return COOLINGLOOP_ERROR;
+    }
+    instance->inputs.sensorVoltage = sensorVoltage;
+    instance->inputs.ignitionSwitch = ignition != 0;
+    instance->inputs.levelSwitch = coolantLevel != 0;
+    return COOLINGLOOP_OK;
+}
+
+CoolingLoopStatus coolingLoopDoStep(CoolingLoopInstance* instance, double dt) {
+    if (!instance || !(dt >= 0.0) || !std::isfinite(dt)) {
+        return COOLINGLOOP_ERROR;
+    }
+    double end = instance->time + dt;
+    double limit = sampleLimit(end, instance->period);
+    bool stepped = false;
+    while (static_cast<double>(instance->cycles) * instance->period < limit) {
+        instance->controller.step(instance->inputs);
+        ++instance->cycles;
+        stepped = true;
+    }
+    if (stepped) {
+        instance->publish();
+    }
+    instance->time = end;
+    return COOLINGLOOP_OK;
+}
+
+CoolingLoopStatus coolingLoopGetOutputs(const CoolingLoopInstance* instance, CoolingLoopOutputs* outputs) {
+    if (!instance || !outputs) {
+        return COOLINGLOOP_ERROR;
+    }
+    *outputs = instance->outputs;
+    return COOLINGLOOP_OK;
+}
+
+double coolingLoopTime(const CoolingLoopInstance* instance) {
+    return instance ? instance->time : 0.0;
+}
+
+CoolingLoopStatus coolingLoopSerializeState(const CoolingLoopInstance* instance, unsigned char* buffer, size_t size) {
+    if (!instance || !buffer || size < COOLINGLOOP_STATE_SIZE ||
+        instance->controller.saveCheckpoint(buffer, size) != CHECKPOINT_SIZE) {
+        return COOLINGLOOP_ERROR;
+    }
+    unsigned char* out = buffer + CHECKPOINT_SIZE;
+    std::uint64_t time;
+    std::memcpy(&time, &instance->time, sizeof(time));
+    std::uint32_t voltage;
+    std::memcpy(&voltage, &instance->inputs.sensorVoltage, sizeof(voltage));
+    putBits(out, time, 8);
+    putBits(out + 8, instance->cycles, 8);
+    putBits(out + 16, voltage, 4);
+    out[20] = instance->inputs.ignitionSwitch ? 1 : 0;
+    out[21] = instance->inputs.levelSwitch ? 1 : 0;
+    return COOLINGLOOP_OK;
+}
+
+CoolingLoopStatus coolingLoopDeserializeState(CoolingLoopInstance* instance, const unsigned char* buffer,
+                                              size_t size) {
+    if (!instance || !buffer || size != COOLINGLOOP_STATE_SIZE) {
+        return COOLINGLOOP_ERROR;
+    }
+    const unsigned char* in = buffer + CHECKPOINT_SIZE;
+    std::uint64_t timeBits = getBits(in, 8);
+    double time;
+    std::memcpy(&time, &timeBits, sizeof(time));
+    std::uint32_t voltageBits = static_cast<std::uint32_t>(getBits(in + 16, 4));
+    float voltage;
+    std::memcpy(&voltage, &voltageBits, sizeof(voltage));
+    if (!(time >= 0.0) || !std::isfinite(time) || in[20] > 1 || in[21] > 1) {
+        return COOLINGLOOP_ERROR;
+    }
+    // doStep() leaves exactly the cycles whose sample instants lie before the time reached;
+    // any other count (or a snapshot taken at another period) would skip or repeat cycles
+    std::uint64_t cycles = getBits(in + 8, 8);
+    double limit = sampleLimit(time, instance->period);
+    if (!(static_cast<double>(cycles) * instance->period >= limit) ||
+        (cycles > 0 && !(static_cast<double>(cycles - 1) * instance->period < limit)) ||
+        !instance->controller.restoreCheckpoint(buffer, CHECKPOINT_SIZE, false)) {
+        return COOLINGLOOP_ERROR;
+    }
+    instance->time = time;
+    instance->cycles = cycles;
+    instance->inputs.sensorVoltage = voltage;
+    instance->inputs.ignitionSwitch = in[20] != 0;
+    instance->inputs.levelSwitch = in[21] != 0;
+    instance->publish();
+    return COOLINGLOOP_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,101 @@
+/*
+Co-simulation interface: the cooling loop controller as a black box behind a C ABI, in the
+manner of an FMI co-simulation unit, for system-level simulators that step many controllers.
+
+    coolingLoopInstantiate       one controller with its own copy of the calibration
+    coolingLoopEnableDerating    graduated derating instead of the overtemperature shutdown
+    coolingLoopSetInputs         sensor voltage, ignition and coolant level, held until changed
+    coolingLoopDoStep            advance the instance by dt seconds of simulated time
+    coolingLoopGetOutputs        pump and fan commands, CAN command frame, state, allowed power
+    coolingLoopSerializeState    opaque snapshot for rollback and restart
+    coolingLoopDeserializeState
+    coolingLoopFreeInstance
+
+The controller samples at its own control period (1 s by default). doStep() runs every
+control cycle whose sample instant falls in [t, t + dt) and holds the outputs in between,
+so a host may step with any dt, including steps far smaller or larger than the period.
+Instantiation is the only call that allocates; the others do no I/O, sleep or allocate
+and each touches only its own instance, so independent instances may be stepped from
+different threads.
+
+The serialized state is COOLINGLOOP_STATE_SIZE bytes: the controller checkpoint (see
+Checkpoint.h) followed by the simulated time, the cycle count and the held inputs, all
+little-endian. Unlike a warm restart, a restored snapshot keeps a latched SAFETY_SHUTDOWN.
+
+Header usable from C.
+*/
+
+#ifndef COOLINGLOOP_CO_SIMULATION_H
+#define COOLINGLOOP_CO_SIMULATION_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COOLINGLOOP_STATE_SIZE 91
+
+/* Exported from the coolingloop_cosim shared library, which hides everything else */
+#if defined(COOLINGLOOP_COSIM_EXPORT) && defined(_WIN32)
+#define COOLINGLOOP_API __declspec(dllexport)
+#elif defined(COOLINGLOOP_COSIM_EXPORT) && defined(__GNUC__)
+#define COOLINGLOOP_API __attribute__((visibility("default")))
+#else
+#define COOLINGLOOP_API
+#endif
+
+typedef struct CoolingLoopInstance CoolingLoopInstance;
+
+typedef enum {
+    COOLINGLOOP_OK = 0,
+    COOLINGLOOP_ERROR = 1 /* Bad argument or snapshot; the instance is unchanged */
+} CoolingLoopStatus;
+
+typedef struct {
+    float pumpSpeed;           /* Pump command (0-100%) */
+    float fanSpeed;            /* Fan command (0-100%) */
+    float measuredTemperature; /* Coolant temperature seen by the controller (°C) */
+    int state;                 /* 0 OFF, 1 ON, 2 SAFETY_SHUTDOWN, 3 AFTERRUN */
+    int cause;                 /* 0 none, 1 low coolant, 2 overtemperature */
+    unsigned int canId;        /* Pump and fan command frame, as sent on the bus */
+    unsigned char canDlc;
+    unsigned char canData[8];
+    float allowedPower;        /* Inverter and DC-DC power limit (%), below 100 only when derating */
+} CoolingLoopOutputs;
+
+/* New instance on the given calibration image (NULL: the built-in calibration), which is
+   validated and copied. setpoint and threshold (°C) of 0 take the calibration's values;
+   controlPeriod is in seconds; the calibration's per-cycle gains and limits are rescaled to
+   it. NULL if the image is invalid or memory is exhausted. */
+COOLINGLOOP_API CoolingLoopInstance* coolingLoopInstantiate(const void* calibration, size_t calibrationSize,
+                                                            float setpoint, float threshold, double controlPeriod);
+COOLINGLOOP_API void coolingLoopFreeInstance(CoolingLoopInstance* instance);
+
+/* Derate above the setpoint instead of shutting down at the threshold (see Derating.h):
+   allowed power (%) at the threshold and its largest rise per control cycle (%) */
+COOLINGLOOP_API CoolingLoopStatus coolingLoopEnableDerating(CoolingLoopInstance* instance, float minimumPower,
+                                                            float recoveryRate);
+
+COOLINGLOOP_API CoolingLoopStatus coolingLoopSetInputs(CoolingLoopInstance* instance, float sensorVoltage,
+                                                       int ignition, int coolantLevel);
+COOLINGLOOP_API CoolingLoopStatus coolingLoopDoStep(CoolingLoopInstance* instance, double dt);
+COOLINGLOOP_API CoolingLoopStatus coolingLoopGetOutputs(const CoolingLoopInstance* instance,
+                                                        CoolingLoopOutputs* outputs);
+
+/* Simulated time (s) reached by doStep() */
+COOLINGLOOP_API double coolingLoopTime(const CoolingLoopInstance* instance);
+
+/* Snapshot into buffer (at least COOLINGLOOP_STATE_SIZE bytes) and back. A snapshot only
+   restores into an instance with the same setpoint, threshold and control period, and its
+   cycle count must match its time. */
+COOLINGLOOP_API CoolingLoopStatus coolingLoopSerializeState(const CoolingLoopInstance* instance,
+                                                            unsigned char* buffer, size_t size);
+COOLINGLOOP_API CoolingLoopStatus coolingLoopDeserializeState(CoolingLoopInstance* instance,
+                                                              const unsigned char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COOLINGLOOP_CO_SIMULATION_H */
@@ -0,0 +1,28 @@
+#include "CommandLine.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+// Parse a whole argument as a float
+bool parseFloat(const char* text, float& value) {
+    char* end = nullptr;
+    errno = 0;
+    float parsed = std::strtof(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Parse a whole argument as a non-negative integer
+bool parseCount(const char* text, long& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < 0) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
@@ -0,0 +1,15 @@
+/*
+Command-line argument parsing without heap allocation or exceptions.
+*/
+
+#ifndef COOLINGLOOP_COMMAND_LINE_H
+#define COOLINGLOOP_COMMAND_LINE_H
+
+// Parse a whole argument as a float. Returns false (and leaves value untouched) on
+// empty input, trailing characters or overflow.
+bool parseFloat(const char* text, float& value);
+
+// Parse a whole argument as a non-negative integer
+bool parseCount(const char* text, long& value);
+
+#endif // COOLINGLOOP_COMMAND_LINE_H
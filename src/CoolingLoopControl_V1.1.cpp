@@ -19,72 +19,206 @@ Future Enhancements:
     Incorporate advanced error handling for CAN Bus communication.
 */
 
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include <thread> // For simulating delays
-#include <cstdlib> // For emulated data
-#include <cmath> // For PID calculations
-#include <string> // For command-line argument handling
-#include <sstream> // For parsing arguments
-
-// PID Controller class
-class PIDController {
-private:
-    float Kp, Ki, Kd;
-    float prevError, integral;
-
-public:
-    PIDController(float p, float i, float d) : Kp(p), Ki(i), Kd(d), prevError(0.0), integral(0.0) {}
-
-    float compute(float setpoint, float measuredValue) {
-        float error = setpoint - measuredValue;
-        integral += error;
-        float derivative = error - prevError;
-        prevError = error;
-        return (Kp * error) + (Ki * integral) + (Kd * derivative);
-    }
-};
-
-// State machine states
-enum class SystemState {
-    OFF,
-    ON,
-    SAFETY_SHUTDOWN
-};
-
-// Functions
-void controlPump(float speed);
-void controlFan(float speed);
-void safetyShutdown(SystemState& state);
-void CANcontrol(float pumpSpeed, float fanSpeed);
-float interpolateTemperature(float voltage);
-
-#ifndef UNIT_TEST
+#include <vector>
+
+#include "Actuators.h"
+#include "Arena.h"
+#include "CANBus.h"
+#include "Calibration.h"
+#include "Checkpoint.h"
+#include "CommandLine.h"
+#include "CoolingLoopController.h"
+#include "DriveCycle.h"
+#include "HealthEstimator.h"
+#include "IgnitionWake.h"
+#include "JunctionEstimator.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "PlantModel.h" // For emulated data
+#include "PlantServer.h"
+#include "PowerView.h"
+#include "PreCooling.h"
+#include "TimerWheel.h"
+
+// Static storage for all runtime structures, so the control loop never uses the heap
+alignas(std::max_align_t) static unsigned char runtimeMemory[1024];
+
+// Health metrics, scraped through --metrics
+static ControllerMetrics metrics;
+
+// Nanoseconds between two clock readings
+static std::uint64_t elapsedNs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+// Loop timers, in 1 ms ticks of the timer wheel
+const std::uint64_t IGNITION_DEBOUNCE_MS = 200; // Key-off accepted once the input stays off this long
+const std::uint64_t DERATE_INHIBIT_MS = 100;    // Shortest interval between two derate frames
+const std::uint64_t DERATE_HEARTBEAT_MS = 1000; // Derate frame repeated at least this often
+
+// At short periods (--period) console output and a checkpoint file every cycle would cost far
+// more than the cycle itself, so both are thinned out to these intervals
+const float STATUS_INTERVAL_MS = 1000.0f;    // Status lines, warnings and the console CAN echo
+const float CHECKPOINT_INTERVAL_MS = 100.0f; // Checkpoint file, and at every state change
+
+// Set by Ctrl+C while the Power View owns the terminal, so it can be restored on exit
+static std::atomic<bool> stopRequested(false);
+
+extern "C" void requestStop(int) {
+    stopRequested = true;
+}
+
+// Ignition wake source of the low-power OFF state (--wake); with the eventfd stand-in, SIGUSR1
+// and SIGUSR2 turn the ignition on and off
+static IgnitionWake ignitionWake;
+
+extern "C" void raiseIgnition(int) {
+    ignitionWake.raise();
+}
+
+extern "C" void lowerIgnition(int) {
+    ignitionWake.lower();
+}
+
 int main(int argc, char* argv[]) {
-    // Parse command-line arguments for setpoints
-    float tempSetpoint = 50.0; // Default setpoint
-    float safetyThreshold = 70.0; // Default safety threshold
-
-    if (argc > 1) {
-        try {
-            tempSetpoint = std::stof(argv[1]);
-            if (argc > 2) {
-                safetyThreshold = std::stof(argv[2]);
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing command-line arguments: " << e.what() << "\n";
-            return 1;
+    // Parse command-line arguments for setpoints, the calibration image and the checkpoint file
+    float tempSetpoint = 0.0f;    // Default from the calibration
+    float safetyThreshold = 0.0f; // Default from the calibration
+    const char* calibrationPath = nullptr;
+    const char* checkpointPath = nullptr;
+    const char* metricsAddress = nullptr;
+    const char* plantAddress = nullptr;
+    const char* forecastPath = nullptr;
+    const char* wakeSource = nullptr;
+    float periodMs = 1000.0f;
+    bool powerView = false;
+    bool derate = true;
+    bool afterrun = true;
+    float junctionLimit = 0.0f; // 0 = setpoint not raised for junction headroom
+    char checkpointTempPath[512] = "";
+
+    int positional = 0;
+    bool argumentsOk = true;
+    for (int i = 1; i < argc && argumentsOk; ++i) {
+        if (std::strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpointPath = argv[++i];
+            int length = std::snprintf(checkpointTempPath, sizeof(checkpointTempPath), "%s.tmp", checkpointPath);
+            argumentsOk = length > 0 && length < static_cast<int>(sizeof(checkpointTempPath));
+        } else if (std::strcmp(argv[i], "--calibration") == 0 && i + 1 < argc) {
+            calibrationPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsAddress = argv[++i];
+        } else if (std::strcmp(argv[i], "--plant") == 0 && i + 1 < argc) {
+            plantAddress = argv[++i];
+        } else if (std::strcmp(argv[i], "--forecast") == 0 && i + 1 < argc) {
+            forecastPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--wake") == 0 && i + 1 < argc) {
+            wakeSource = argv[++i];
+        } else if (std::strcmp(argv[i], "--period") == 0 && i + 1 < argc) {
+            argumentsOk = parseFloat(argv[++i], periodMs) && periodMs > 0.0f;
+        } else if (std::strcmp(argv[i], "--no-derate") == 0) {
+            derate = false;
+        } else if (std::strcmp(argv[i], "--no-afterrun") == 0) {
+            afterrun = false;
+        } else if (std::strcmp(argv[i], "--junction-limit") == 0 && i + 1 < argc) {
+            argumentsOk = parseFloat(argv[++i], junctionLimit) && junctionLimit > 0.0f;
+        } else if (std::strcmp(argv[i], "--power-view") == 0) {
+            powerView = true;
+        } else if (positional == 0) {
+            argumentsOk = parseFloat(argv[i], tempSetpoint);
+            ++positional;
+        } else if (positional == 1) {
+            argumentsOk = parseFloat(argv[i], safetyThreshold);
+            ++positional;
+        } else {
+            argumentsOk = false;
         }
     }
+    if (!argumentsOk) {
+        std::cerr << "Error parsing command-line arguments: expected [setpoint] [threshold] [--calibration file] [--checkpoint file] [--metrics port|socket] [--plant socket] [--forecast file] [--wake eventfd|gpio:path|can:interface] [--period ms] [--no-derate] [--no-afterrun] [--junction-limit celsius] [--power-view]\n";
+        return 1;
+    }
+
+    // Calibration image baked at build time, used in place from the mapping
+    const CalibrationImage* calibration = &defaultCalibration();
+    if (calibrationPath) {
+        const CalibrationImage* mapped = mapCalibrationImage(calibrationPath);
+        if (mapped) {
+            calibration = mapped;
+        } else {
+            std::cerr << "WARNING: Cannot use calibration image " << calibrationPath << ". Using the built-in calibration.\n";
+        }
+    }
+    if (positional < 1) tempSetpoint = calibration->setpoint;
+    if (positional < 2) safetyThreshold = calibration->threshold;
+    const CANLayout layout = canLayout(*calibration);
+
+    // Cooling loop controller (PID loops and state machine)
+    MonotonicArena arena(runtimeMemory, sizeof(runtimeMemory));
+    CoolingLoopController* controllerStorage = arena.create<CoolingLoopController>(*calibration, tempSetpoint, safetyThreshold);
+    if (!controllerStorage) {
+        std::cerr << "Runtime memory exhausted\n";
+        return 1;
+    }
+    CoolingLoopController& controller = *controllerStorage;
+    controller.setControlPeriod(periodMs / 1000.0f);
+
+    // Past the setpoint, limit the inverter and DC-DC power and keep cooling at maximum instead
+    // of shutting the loop down at the threshold (--no-derate: the hard shutdown)
+    if (derate) {
+        controller.enableDerating(DerateLimits{});
+    }
 
-    // PID Controllers
-    PIDController pumpPID(0.5f, 0.1f, 0.05f); // Tuned values for pump
-    PIDController fanPID(0.4f, 0.1f, 0.03f);  // Tuned values for fan
+    // After key-off a hot loop keeps cooling until the heat has soaked out of the power stage
+    // (--no-afterrun: pump and fan stop with the ignition)
+    if (afterrun) {
+        controller.enableAfterrun(AfterrunLimits{});
+    }
 
     // Emulated sensor data (replace with real inputs in actual implementation)
-    bool ignitionSwitch = false; // Ignition switch input
-    float sensorVoltage = 0.0; // Simulated voltage reading
-    bool levelSwitch = true; // Coolant level (true = sufficient, false = low)
-    float measuredTemperature = 0.0; // Actual temperature
+    SensorInputs inputs{0.0f, false, true};
+    inputs.sensorCount = 2; // Inverter-outlet and DC-DC-outlet sensors
+    PlantModel* plant = arena.create<PlantModel>(PlantParameters{}, 45.0f); // Emulated coolant loop
+    if (!plant) {
+        std::cerr << "Runtime memory exhausted\n";
+        return 1;
+    }
+
+    // Hardware-in-the-loop stand-in: the plant runs in a plant server process (see
+    // src/PlantServer.h), the actuator commands go to it and the sensor readings come back
+    static PlantLink plantLink;
+    PlantSample plantSample{};
+    const bool hil = plantAddress != nullptr;
+    if (hil) {
+        if (!plantLink.connect(plantAddress) || !plantLink.exchange(0.0f, plantSample)) {
+            std::cerr << "Cannot reach the plant server at " << plantAddress << "\n";
+            return 1;
+        }
+        setActuatorDriver(&plantLink);
+    }
+
+    // Low-power OFF: with the ignition off the loop sleeps until the wake source reports the
+    // ignition on, instead of running a cycle every period; the same source is the ignition input
+    if (wakeSource) {
+        std::string error;
+        if (hil) {
+            std::cerr << "--wake and --plant both supply the ignition. Use one of them.\n";
+            return 1;
+        }
+        if (!ignitionWake.open(wakeSource, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::signal(SIGUSR1, raiseIgnition);
+        std::signal(SIGUSR2, lowerIgnition);
+    }
 
     // Declare pumpSpeed and fanSpeed outside the loop to ensure they are accessible globally
     float pumpSpeed = 0.0;
@@ -94,126 +228,391 @@ int main(int argc, char* argv[]) {
     SystemState currentState = SystemState::OFF;
     std::cout << "Initializing cooling loop with PID control..." << std::endl;
 
-    // Main control loop
-    while (true) {
+    // Warm restart: resume from the last checkpoint instead of ramping up from cold
+    unsigned char checkpoint[CHECKPOINT_SIZE + 1]; // One spare byte to detect oversized files
+    if (checkpointPath) {
+        std::size_t bytes = readCheckpointFile(checkpointPath, checkpoint, sizeof(checkpoint));
+        if (bytes && controller.restoreCheckpoint(checkpoint, bytes)) {
+            currentState = controller.state();
+            inputs.ignitionSwitch = currentState == SystemState::ON;
+            std::cout << "Resumed from checkpoint " << checkpointPath << "\n";
+        } else if (bytes) {
+            std::cerr << "WARNING: Ignoring unusable checkpoint " << checkpointPath << ". Starting cold.\n";
+        }
+    }
+
+    // Power View: full-screen status instead of the scrolling text, which is muted
+    static Seqlock<PowerViewSnapshot> snapshot;
+    PowerViewDisplay display;
+    std::uint32_t cycle = 0;
+    if (powerView) {
+        std::cout.rdbuf(nullptr);
+        std::cerr.rdbuf(nullptr);
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        display.start(snapshot, stdout);
+    }
+
+    // Filter and pump health, estimated from the pump speed feedback and the coolant temperature rise
+    const HealthLimits healthLimits;
+    HealthState health(healthLimits);
+
+    // Inverter and DC-DC junction temperatures estimated from their losses; with --junction-limit the
+    // coolant may run warmer while the hottest junction stays clear of the limit
+    PowerStageJunctions junctions(45.0f);
+    JunctionLimits junctionLimits;
+    junctionLimits.junctionLimit = junctionLimit;
+    JunctionHeadroom headroom(junctionLimits);
+
+    // Heat-load forecast from a drive cycle read ten minutes ahead of the vehicle; the planner
+    // pre-cools ahead of load peaks. The emulated vehicle controller sends it as forecast
+    // frames, which reach the forecast through the CAN receive path, and the emulated plant
+    // plays the same drive cycle.
+    PreCoolingOptions preCooling;
+    LoadForecast forecast(preCooling.horizon, preCooling.stepSeconds, PlantParameters{}.heatLoad);
+    PreCoolingPlanner planner(PlantParameters{}, preCooling);
+    DriveCycleProfile ahead;
+    std::vector<CANFrame> forecastFrames;
+    forecastFrames.reserve(static_cast<std::size_t>(preCooling.horizon));
+    double forecastUntil = 0.0;
+    double elapsedSeconds = 0.0;
+    auto receiveForecastFrames = [&]() {
+        sendForecast(ahead, forecast, elapsedSeconds, forecastUntil, forecastFrames);
+        for (const CANFrame& frame : forecastFrames) {
+            receiveForecast(forecast, frame);
+            metrics.canFramesReceived.add();
+        }
+        forecastFrames.clear();
+    };
+    if (forecastPath) {
+        std::string error;
+        if (!ahead.open(forecastPath, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        receiveForecastFrames();
+    }
+
+    // Afterrun, ignition debounce and derate frame inhibit and heartbeat run on the timer wheel,
+    // advanced by the period after every cycle
+    static TimerWheel timers(LOOP_TIMER_COUNT);
+    TimerHandle afterrunTimer;
+    TimerHandle soakTimer;
+    TimerHandle debounceTimer;
+    TimerHandle inhibitTimer;
+    TimerHandle heartbeatTimer;
+    bool ignitionRaw = inputs.ignitionSwitch; // Ignition input before the debounce
+    bool heartbeatDue = true;
+    float derateSent = -1.0f; // Last power limit sent, none yet
+    float timerCarry = 0.0f;  // Part of a tick left over from the last advance (ms)
+    auto fire = [&](std::uint32_t, std::uint16_t kind) {
+        switch (static_cast<LoopTimer>(kind)) {
+            case LoopTimer::AFTERRUN:
+                inputs.afterrunExpired = true;
+                break;
+            case LoopTimer::SOAK:
+                inputs.afterrunSoaked = true;
+                break;
+            case LoopTimer::IGNITION_DEBOUNCE:
+                inputs.ignitionSwitch = false;
+                break;
+            case LoopTimer::HEARTBEAT:
+                heartbeatDue = true;
+                break;
+            case LoopTimer::CAN_INHIBIT:
+                break;
+        }
+    };
+
+    // Metrics endpoint for fleet monitoring (loopback port or Unix socket)
+    MetricsServer metricsServer;
+    if (metricsAddress && !metricsServer.start(metrics, metricsAddress)) {
+        std::cerr << "WARNING: Cannot serve metrics on " << metricsAddress << "\n";
+    }
+
+    // Main control loop, one cycle per period
+    const float periodSeconds = periodMs / 1000.0f;
+    const std::chrono::steady_clock::duration period =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(periodSeconds));
+    const std::uint64_t statusEvery =
+        periodMs < STATUS_INTERVAL_MS ? static_cast<std::uint64_t>(STATUS_INTERVAL_MS / periodMs + 0.5f) : 1;
+    const std::uint64_t checkpointEvery =
+        periodMs < CHECKPOINT_INTERVAL_MS ? static_cast<std::uint64_t>(CHECKPOINT_INTERVAL_MS / periodMs + 0.5f) : 1;
+    const std::uint64_t healthEvery = healthSampleEvery(periodSeconds);
+    std::uint64_t cycleCount = 0;
+    SystemState checkpointState = controller.state(); // State in the last checkpoint written
+    std::chrono::steady_clock::time_point nextCycle = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point woken;
+    bool wakePending = false; // Woken, first pump command not out yet
+    while (!stopRequested) {
+        // Parked: block until the ignition comes on, with no timeout and no periodic wakeup. The
+        // timer wheel stands still meanwhile; only the derate heartbeat can be armed in OFF.
+        if (ignitionWake.isOpen() && currentState == SystemState::OFF) {
+            std::cout << "System OFF. Waiting for the ignition.\n";
+            std::cout.flush();
+            std::string error;
+            while (!ignitionWake.wait(error) && error.empty() && !stopRequested) {
+            }
+            if (stopRequested) {
+                break;
+            }
+            if (!error.empty()) {
+                std::cerr << "ERROR: " << error << "\n";
+                return 1;
+            }
+            woken = std::chrono::steady_clock::now();
+            wakePending = true;
+            nextCycle = woken; // A new schedule from the wake, not a run of missed deadlines
+        }
+
+        std::chrono::steady_clock::time_point cycleStart = std::chrono::steady_clock::now();
+
+        if (hil) {
+            // Sensor and switch readings from the plant server
+            inputs.sensorVoltage = plantSample.sensorVoltage;
+            inputs.redundantVoltage[0] = plantSample.redundantVoltage;
+            ignitionRaw = plantSample.ignition != 0;
+            inputs.levelSwitch = plantSample.level != 0;
+        } else {
+            // Simulate sensor voltage readings (replace with real sensor inputs)
+            inputs.sensorVoltage = plant->sensorVoltage();
+            inputs.redundantVoltage[0] = plant->sensorVoltage();
+            if (ignitionWake.isOpen()) {
+                ignitionRaw = ignitionWake.ignition();
+            }
+        }
+
         switch (currentState) {
             case SystemState::OFF:
-                ignitionSwitch = !ignitionSwitch; // Simulate ignition switch toggle
-                if (ignitionSwitch) {
-                    std::cout << "System ON\n";
-                    currentState = SystemState::ON;
-                } else {
-                    std::cout << "System remains OFF\n";
+                if (!hil && !ignitionWake.isOpen()) {
+                    ignitionRaw = true; // Simulate the ignition switch turning on
                 }
                 break;
 
             case SystemState::ON:
-                // Simulate sensor voltage readings (replace with real sensor inputs)
-                sensorVoltage = 1.0f + static_cast<float>(rand() % 3); // Random voltage between 1.0-4.0V
-
-                // Interpolate temperature from voltage
-                measuredTemperature = interpolateTemperature(sensorVoltage);
-
-                // Check coolant level
-                if (!levelSwitch) {
-                    std::cerr << "ERROR: Low coolant level. Shutting down pump and fan for safety.\n";
-                    controlPump(0);
-                    controlFan(0);
-                    safetyShutdown(currentState);
-                    break;
+            case SystemState::AFTERRUN:
+                break;
+
+            case SystemState::SAFETY_SHUTDOWN:
+                std::cerr << "System in SAFETY SHUTDOWN mode. Please restart the system.\n";
+                // Keep the shutdown and its cause on the Power View until the operator quits
+                while (powerView && !stopRequested) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
                 }
+                return 0;
+        }
+
+        // Key-on is taken at once; key-off once the input has stayed off for the debounce time,
+        // so a dropout while cranking does not end the ignition cycle
+        if (ignitionRaw) {
+            timers.cancel(debounceTimer);
+            inputs.ignitionSwitch = true;
+        } else if (inputs.ignitionSwitch && !timers.armed(debounceTimer)) {
+            debounceTimer =
+                timers.arm(IGNITION_DEBOUNCE_MS, 0, static_cast<std::uint16_t>(LoopTimer::IGNITION_DEBOUNCE));
+        }
+
+        std::chrono::steady_clock::time_point sampled = std::chrono::steady_clock::now();
+        const ControlOutputs& out = controller.step(inputs);
+        inputs.afterrunExpired = false;
+        std::chrono::steady_clock::time_point controlled = std::chrono::steady_clock::now();
+        pumpSpeed = out.pumpSpeed;
+        fanSpeed = out.fanSpeed;
+        metrics.recordOutputs(out);
+        if (powerView) {
+            snapshot.store(PowerViewSnapshot{out, tempSetpoint, safetyThreshold, ++cycle});
+        }
 
-                // Compute PID outputs for pump and fan
-                pumpSpeed = pumpPID.compute(tempSetpoint, measuredTemperature);
-                fanSpeed = fanPID.compute(tempSetpoint, measuredTemperature);
+        // Checkpoint every cycle (every CHECKPOINT_INTERVAL_MS at short periods, and at every state
+        // change), so a supervised restart resumes where this one stopped
+        if (checkpointPath && (cycleCount % checkpointEvery == 0 || out.state != checkpointState)) {
+            checkpointState = out.state;
+            std::size_t bytes = controller.saveCheckpoint(checkpoint, sizeof(checkpoint));
+            if (!writeCheckpointFile(checkpointPath, checkpointTempPath, checkpoint, bytes)) {
+                std::cerr << "WARNING: Cannot write checkpoint " << checkpointPath << "\n";
+            }
+        }
 
-                // Outputs to valid ranges (0-100%)
-                if (pumpSpeed < 0.0f) pumpSpeed = 0.0f;
-                if (pumpSpeed > 100.0f) pumpSpeed = 100.0f;
+        // The afterrun and soak times are requested in the cycle AFTERRUN is entered; leaving
+        // it early (cool enough, ignition back on) cancels the timers
+        if (out.afterrunSeconds > 0.0f) {
+            afterrunTimer = timers.arm(static_cast<std::uint64_t>(out.afterrunSeconds * 1000.0f), 0,
+                                       static_cast<std::uint16_t>(LoopTimer::AFTERRUN));
+            soakTimer = timers.arm(static_cast<std::uint64_t>(out.soakSeconds * 1000.0f), 0,
+                                   static_cast<std::uint16_t>(LoopTimer::SOAK));
+            inputs.afterrunSoaked = false;
+        } else if (out.state != SystemState::AFTERRUN) {
+            timers.cancel(afterrunTimer);
+            timers.cancel(soakTimer);
+            inputs.afterrunSoaked = false;
+        }
 
-                if (fanSpeed < 0.0f) fanSpeed = 0.0f;
-                if (fanSpeed > 100.0f) fanSpeed = 100.0f;
+        // The controller already runs in the ignition cycle, so its outputs are applied at once
+        if ((currentState == SystemState::OFF || currentState == SystemState::AFTERRUN) &&
+            out.state == SystemState::ON) {
+            std::cout << "System ON\n";
+            currentState = SystemState::ON;
+        }
 
-                // Apply control outputs
+        // Per-cycle lines once per STATUS_INTERVAL_MS, and for the first pump command after a wake;
+        // state changes are always reported. The plant server gets every command.
+        const bool report = cycleCount % statusEvery == 0 || wakePending;
+        if (currentState == SystemState::OFF) {
+            if (report) std::cout << "System remains OFF\n";
+        } else if (out.cause == ShutdownCause::LOW_COOLANT) {
+            std::cerr << "ERROR: Low coolant level. Shutting down pump and fan for safety.\n";
+            controlPump(0);
+            controlFan(0);
+            safetyShutdown(currentState);
+        } else if (out.cause == ShutdownCause::OVERTEMPERATURE) {
+            std::cerr << "\033[31mCRITICAL: Overtemperature detected. Shutting down system.\033[0m\n";
+            controlPump(0);
+            controlFan(0);
+            safetyShutdown(currentState);
+        } else if (out.state == SystemState::OFF) {
+            std::cout << (currentState == SystemState::AFTERRUN ? "Afterrun finished." : "Ignition OFF.")
+                      << " Stopping pump and fan.\n";
+            controlPump(0);
+            controlFan(0);
+            currentState = SystemState::OFF;
+        } else if (out.state == SystemState::AFTERRUN) {
+            if (currentState != SystemState::AFTERRUN) {
+                std::cout << "Ignition OFF. Afterrun cooling for " << out.afterrunSeconds << " s.\n";
+                currentState = SystemState::AFTERRUN;
+            }
+            if (report || hil) {
                 controlPump(pumpSpeed);
                 controlFan(fanSpeed);
-
-                // Safety shutdown if temperature exceeds critical threshold
-                if (measuredTemperature > safetyThreshold) {
-                    std::cerr << "\033[31mCRITICAL: Overtemperature detected. Shutting down system.\033[0m\n";
-                    controlPump(0);
-                    controlFan(0);
-                    safetyShutdown(currentState);
-                    break;
+            }
+            if (report) std::cout << "Measured Temperature: " << out.measuredTemperature << "°C\n";
+        } else {
+            if (report) {
+                if (out.activeSensors == 0) {
+                    std::cerr << "WARNING: Temperature sensor " << sensorStatusName(out.sensorStatus)
+                              << ". Full cooling until the reading is plausible again.\n";
+                } else if (out.sensorStatus != SensorStatus::VALID) {
+                    std::cerr << "WARNING: Temperature sensor " << sensorStatusName(out.sensorStatus)
+                              << ". Controlling on the remaining sensor.\n";
+                }
+                if (out.sensorDisagreement) {
+                    std::cerr << "WARNING: Temperature sensors disagree. Cooling for the hottest reading.\n";
                 }
+                if (out.allowedPower < 100.0f) {
+                    std::cerr << "WARNING: Coolant at " << out.measuredTemperature
+                              << "°C. Inverter and DC-DC derated to " << out.allowedPower << "% power, full cooling.\n";
+                }
+            }
+
+            // Apply control outputs
+            if (report || hil) {
+                controlPump(pumpSpeed);
+                controlFan(fanSpeed);
+            }
+            if (wakePending) {
+                std::uint64_t latency = elapsedNs(woken, std::chrono::steady_clock::now());
+                metrics.wakeLatency.record(latency);
+                wakePending = false;
+                std::cout << "Wake to first pump command: " << latency / 1000 << " us\n";
+            }
 
-                // Display status
-                std::cout << "Measured Temperature: " << measuredTemperature << "°C\n";
+            // Display status
+            if (report) {
+                std::cout << "Measured Temperature: " << out.measuredTemperature << "°C\n";
                 std::cout << "Pump Speed: " << pumpSpeed << "%\n";
                 std::cout << "Fan Speed: " << fanSpeed << "%\n";
-                break;
-
-            case SystemState::SAFETY_SHUTDOWN:
-                std::cerr << "System in SAFETY SHUTDOWN mode. Please restart the system.\n";
-                return 0;
+            }
+        }
+        // The emulated motor controllers decode the frame every cycle (below); the console echo
+        // follows the status lines
+        if (report) {
+            CANcontrol(pumpSpeed, fanSpeed, layout);
+        }
+        metrics.canFramesSent.add();
+        // Derate frame on a change, at most once per inhibit time, and on the heartbeat
+        if (derate && ((out.allowedPower != derateSent && !timers.armed(inhibitTimer)) || heartbeatDue)) {
+            CANderate(out.allowedPower, out.allowedPower);
+            metrics.canFramesSent.add();
+            derateSent = out.allowedPower;
+            heartbeatDue = false;
+            timers.cancel(inhibitTimer);
+            inhibitTimer = timers.arm(DERATE_INHIBIT_MS, 0, static_cast<std::uint16_t>(LoopTimer::CAN_INHIBIT));
+            timers.cancel(heartbeatTimer);
+            heartbeatTimer = timers.arm(DERATE_HEARTBEAT_MS, 0, static_cast<std::uint16_t>(LoopTimer::HEARTBEAT));
+        }
+        std::cout.flush();
+
+        std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+        ++cycleCount;
+        metrics.cycles.add();
+        metrics.stageLatency[static_cast<int>(ControlStage::SAMPLE)].record(elapsedNs(cycleStart, sampled));
+        metrics.stageLatency[static_cast<int>(ControlStage::CONTROL)].record(elapsedNs(sampled, controlled));
+        metrics.stageLatency[static_cast<int>(ControlStage::OUTPUT)].record(elapsedNs(controlled, finished));
+        metrics.stageLatency[static_cast<int>(ControlStage::CYCLE)].record(elapsedNs(cycleStart, finished));
+
+        // Wait for the next period (replace with real-time loop in PLC or embedded system); an
+        // overrun counts as a deadline miss and the schedule restarts from now
+        nextCycle += period;
+        if (finished > nextCycle) {
+            metrics.deadlineMisses.add();
+            nextCycle = finished;
+        }
+        std::this_thread::sleep_until(nextCycle);
+        timerCarry += periodMs;
+        std::uint64_t ticks = static_cast<std::uint64_t>(timerCarry);
+        timerCarry -= static_cast<float>(ticks);
+        timers.advance(ticks, fire);
+
+        // Pump speed feedback and inverter inlet/outlet temperatures and losses for the health estimator
+        HealthSample feedback;
+        if (hil) {
+            // The plant server advances one period with the latched commands
+            if (!plantLink.exchange(periodSeconds, plantSample)) {
+                std::cerr << "ERROR: Plant server connection lost.\n";
+                return 1;
+            }
+            feedback = {plantLink.pumpCommand(), plantSample.pumpRpm, plantSample.inletTemperature,
+                        plantSample.outletTemperature, plantSample.heatLoad};
+        } else {
+            // Emulated pump and fan controllers receive the command frame and drive the plant
+            float pumpReceived = 0.0f;
+            float fanReceived = 0.0f;
+            decodeCANFrame(encodeCANFrame(pumpSpeed, fanSpeed, layout), pumpReceived, fanReceived, layout);
+            metrics.canFramesReceived.add();
+            if (forecastPath) {
+                plant->setHeatLoad(forecast.at(0));
+            }
+            plant->step(periodSeconds, pumpReceived, fanReceived);
+            feedback = {pumpReceived, plant->pumpRpm(), plant->inletTemperature(), plant->temperature(), plant->heatLoad()};
+        }
+        std::uint8_t previousFlags = health.flags;
+        if (cycleCount % healthEvery == 0) {
+            updateHealth(health, feedback, healthLimits);
+        }
+        for (MaintenanceFlag flag : {PUMP_DEGRADED, FILTER_CLOGGED}) {
+            if ((health.flags & flag) && !(previousFlags & flag)) {
+                std::cerr << "MAINTENANCE: " << maintenanceFlagName(flag) << ". Service the cooling loop.\n";
+            }
+        }
+        metrics.filterResistance.set(health.filterResistance(healthLimits));
+        metrics.pumpSpeedRatio.set(health.pumpSpeedRatio.theta);
+        metrics.maintenanceFlags.store(health.flags, std::memory_order_relaxed);
+
+        float hottest = junctions.update(feedback.heatLoad * INVERTER_LOSS_SHARE,
+                                         feedback.heatLoad * (1.0f - INVERTER_LOSS_SHARE), feedback.inletTemperature,
+                                         feedback.outletTemperature, periodSeconds);
+        metrics.junctionTemperature.set(hottest);
+        if (junctionLimit > 0.0f) {
+            inputs.setpointRaise = headroom.update(hottest, feedback.outletTemperature, tempSetpoint, periodSeconds);
+            metrics.setpointRaise.set(inputs.setpointRaise);
         }
 
-        // Simulate delay (replace with real-time loop in PLC or embedded system)
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        CANcontrol(pumpSpeed, fanSpeed);
+        if (forecastPath) {
+            elapsedSeconds += periodSeconds;
+            forecast.advance(periodSeconds);
+            receiveForecastFrames();
+            inputs.coolingFloor = planner.plan(feedback.outletTemperature, tempSetpoint, forecast);
+        }
     }
 
     return 0;
 }
-#endif
-// Function to control the pump
-void controlPump(float speed) {
-    std::cout << "Pump running at " << speed << "% speed.\n";
-}
-
-// Function to control the fan
-void controlFan(float speed) {
-    std::cout << "Fan running at " << speed << "% speed.\n";
-}
-
-// Function for safety shutdown
-void safetyShutdown(SystemState& state) {
-    state = SystemState::SAFETY_SHUTDOWN;
-    std::cerr << "System entering safety shutdown mode.\n";
-}
-
-// Simulate CAN Bus control messages
-void CANcontrol(float pumpSpeed, float fanSpeed) {
-    const int CANID = 0x18FF408F; // CAN ID for the message
-    const int DLC = 8; // Data Length Code
-    unsigned char msg[DLC] = {0};
-
-    // Encode speeds into CAN message
-    msg[2] = static_cast<unsigned char>(pumpSpeed / 100 * 255); // Scale pump speed to 0-255
-    msg[6] = static_cast<unsigned char>(fanSpeed / 100 * 255);  // Scale fan speed to 0-255
-
-    // Print CAN message
-    std::cout << "CANID: 0x" << std::hex << std::uppercase << CANID << "\n";
-    std::cout << "MSG: ";
-    for (int i = 0; i < DLC; ++i) {
-        std::cout << "0x" << std::hex << std::uppercase << static_cast<int>(msg[i]) << " ";
-    }
-    std::cout << "\n";
-}
-
-// Interpolate temperature from voltage based on sensor data table
-float interpolateTemperature(float voltage) {
-    // Example mapping based on the provided table (simplified linear interpolation)
-    if (voltage >= 4.771) return -20.0;
-    if (voltage >= 4.642) return -10.0;
-    if (voltage >= 4.438) return 0.0;
-    if (voltage >= 4.141) return 10.0;
-    if (voltage >= 3.751) return 20.0;
-    if (voltage >= 3.325) return 30.0;
-    if (voltage >= 2.838) return 40.0;
-    if (voltage >= 2.500) return 50.0;
-    if (voltage >= 1.915) return 60.0;
-    if (voltage >= 1.212) return 80.0;
-    if (voltage >= 0.749) return 100.0;
-    return 120.0; // Default for lower voltages
-}
\ No newline at end of file
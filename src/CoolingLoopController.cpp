@@ -0,0 +1,219 @@
+#include "CoolingLoopController.h"
+#include "TemperatureSensor.h"
+
+#include <iostream>
+
+// Check every raw sample before trusting it, then vote over the plausible ones; false if no
+// channel is plausible
+inline bool CoolingLoopController::measureTemperature(const SensorInputs& inputs, float& measured) {
+    int channels = inputs.sensorCount;
+    if (channels < 1) channels = 1;
+    if (channels > MAX_SENSOR_CHANNELS) channels = MAX_SENSOR_CHANNELS;
+    const float voltage[MAX_SENSOR_CHANNELS] = {inputs.sensorVoltage, inputs.redundantVoltage[0],
+                                                inputs.redundantVoltage[1]};
+    float temperature[MAX_SENSOR_CHANNELS] = {0.0f, 0.0f, 0.0f};
+    bool valid[MAX_SENSOR_CHANNELS] = {false, false, false};
+    outputs.sensorStatus = SensorStatus::VALID;
+    for (int ch = channels - 1; ch >= 0; --ch) { // Backwards: report the first bad channel
+        float previous = hasPreviousVoltage ? previousVoltage[ch] : voltage[ch];
+        std::uint8_t status = classifySensorSample(voltage[ch], previous, sensorLimits);
+        previousVoltage[ch] = voltage[ch];
+        valid[ch] = status == 0;
+        if (status) {
+            outputs.sensorStatus = static_cast<SensorStatus>(status);
+        } else {
+            temperature[ch] = interpolateTemperature(voltage[ch], temperatureTable);
+        }
+    }
+    hasPreviousVoltage = true;
+    SensorVote result = voteSensorChannels(temperature[0], temperature[1], temperature[2], valid[0], valid[1],
+                                         valid[2], votingLimits);
+    outputs.activeSensors = result.usedMask;
+    outputs.sensorDisagreement = result.disagreement != 0;
+    measured = result.temperature;
+    return result.usedMask != 0;
+}
+
+// Pump and fan stop; the sensor history restarts with the next ignition cycle
+inline void CoolingLoopController::switchOff() {
+    outputs.state = SystemState::OFF;
+    outputs.pumpSpeed = 0.0f;
+    outputs.fanSpeed = 0.0f;
+    outputs.allowedPower = 100.0f;
+    outputs.afterrunSeconds = 0.0f;
+    outputs.soakSeconds = 0.0f;
+    hasPreviousVoltage = false;
+}
+
+// One afterrun cycle with the ignition off, kept out of step() so the ON cycle stays compact:
+// runs out on the owner's timer, or early once the heat has soaked out and the coolant is cool
+// enough; the coolant is cooler than the power stage until then
+void CoolingLoopController::stepAfterrun(const SensorInputs& inputs) {
+    if (!inputs.levelSwitch) {
+        outputs.state = SystemState::SAFETY_SHUTDOWN;
+        outputs.cause = ShutdownCause::LOW_COOLANT;
+        outputs.pumpSpeed = 0.0f;
+        outputs.fanSpeed = 0.0f;
+        return;
+    }
+    float temperature = 0.0f;
+    if (measureTemperature(inputs, temperature)) {
+        outputs.measuredTemperature = temperature;
+        if (temperature > safetyThreshold) {
+            // Still heating up with the cooling on: full cooling while derating is
+            // enabled (nothing to derate with the ignition off) up to its trip margin, else
+            // shut down as in ON
+            if (derating && !(temperature > safetyThreshold + derateLimits.tripMargin)) {
+                outputs.pumpSpeed = 100.0f;
+                outputs.fanSpeed = 100.0f;
+                return;
+            }
+            outputs.state = SystemState::SAFETY_SHUTDOWN;
+            outputs.cause = ShutdownCause::OVERTEMPERATURE;
+            outputs.pumpSpeed = 0.0f;
+            outputs.fanSpeed = 0.0f;
+            return;
+        }
+        outputs.pumpSpeed = afterrunLimits.pumpSpeed;
+        outputs.fanSpeed = afterrunLimits.fanSpeed;
+        if (inputs.afterrunSoaked && !(temperature > afterrunLimits.endTemperature)) {
+            switchOff();
+            return;
+        }
+    }
+    if (inputs.afterrunExpired) {
+        switchOff();
+    }
+}
+
+// Run one control cycle: advance the state machine and compute pump and fan commands
+const ControlOutputs& CoolingLoopController::step(const SensorInputs& inputs) {
+    switch (outputs.state) {
+        case SystemState::AFTERRUN:
+            outputs.afterrunSeconds = 0.0f;
+            outputs.soakSeconds = 0.0f;
+            if (!inputs.ignitionSwitch) {
+                stepAfterrun(inputs);
+                break;
+            }
+            // Ignition back on: start as from OFF
+            [[fallthrough]];
+
+        case SystemState::OFF:
+            if (!inputs.ignitionSwitch) {
+                break;
+            }
+            // Start controlling in the ignition cycle itself, not one cycle later
+            outputs.state = SystemState::ON;
+            [[fallthrough]];
+
+        case SystemState::ON: {
+            if (!inputs.ignitionSwitch) {
+                // A hot loop keeps cooling after key-off, for a time fixed now
+                float seconds = afterrun ? afterrunDuration(afterrunLimits, outputs.measuredTemperature) : 0.0f;
+                if (seconds > 0.0f) {
+                    outputs.state = SystemState::AFTERRUN;
+                    outputs.afterrunSeconds = seconds;
+                    outputs.soakSeconds = afterrunLimits.soakSeconds < seconds ? afterrunLimits.soakSeconds : seconds;
+                    outputs.pumpSpeed = afterrunLimits.pumpSpeed;
+                    outputs.fanSpeed = afterrunLimits.fanSpeed;
+                    outputs.allowedPower = 100.0f;
+                    break;
+                }
+                switchOff();
+                break;
+            }
+
+            float temperature = 0.0f;
+            bool plausible = measureTemperature(inputs, temperature);
+
+            // Check coolant level
+            if (!inputs.levelSwitch) {
+                outputs.state = SystemState::SAFETY_SHUTDOWN;
+                outputs.cause = ShutdownCause::LOW_COOLANT;
+                outputs.pumpSpeed = 0.0f;
+                outputs.fanSpeed = 0.0f;
+                if (derating) {
+                    outputs.allowedPower = derateLimits.minimumPower; // No cooling, no load
+                }
+                break;
+            }
+
+            // No plausible channel left: keep the last good temperature, hold the PID loops and
+            // command full cooling for this cycle (safe for both the inverter and the DC-DC)
+            if (!plausible) {
+                outputs.pumpSpeed = 100.0f;
+                outputs.fanSpeed = 100.0f;
+                break;
+            }
+
+            // Hottest plausible channel drives the cooling
+            outputs.measuredTemperature = temperature;
+
+            // Junction headroom lets the coolant run warmer, but never past half way to the threshold
+            float setpoint = tempSetpoint;
+            if (inputs.setpointRaise > 0.0f && safetyThreshold > tempSetpoint) {
+                float raise = inputs.setpointRaise;
+                float limit = 0.5f * (safetyThreshold - tempSetpoint);
+                setpoint += raise < limit ? raise : limit;
+            }
+
+            // Compute PID outputs for pump and fan
+            float pumpSpeed = pumpPID.compute(setpoint, outputs.measuredTemperature);
+            float fanSpeed = fanPID.compute(setpoint, outputs.measuredTemperature);
+
+            // Outputs to valid ranges (0-100%), raised to the pre-cooling floor ahead of a
+            // forecast load; one lower bound for both, so the floor costs no extra compare
+            float lowest = inputs.coolingFloor > 0.0f ? inputs.coolingFloor : 0.0f;
+            if (pumpSpeed < lowest) pumpSpeed = lowest;
+            if (pumpSpeed > 100.0f) pumpSpeed = 100.0f;
+
+            if (fanSpeed < lowest) fanSpeed = lowest;
+            if (fanSpeed > 100.0f) fanSpeed = 100.0f;
+
+            outputs.pumpSpeed = pumpSpeed;
+            outputs.fanSpeed = fanSpeed;
+
+            // Derating: limits fall at once and recover at a bounded rate, cooling at maximum
+            if (derating) {
+                float allowed = deratedPower(outputs.measuredTemperature, setpoint, safetyThreshold,
+                                             derateLimits.minimumPower);
+                float recovered = outputs.allowedPower + derateLimits.recoveryRate;
+                outputs.allowedPower = allowed < recovered ? allowed : recovered;
+                if (outputs.allowedPower < 100.0f) {
+                    outputs.pumpSpeed = 100.0f;
+                    outputs.fanSpeed = 100.0f;
+                }
+                // Last resort: derating is not bringing the coolant back (failed pump, limit
+                // ignored)
+                if (outputs.measuredTemperature > safetyThreshold + derateLimits.tripMargin) {
+                    outputs.state = SystemState::SAFETY_SHUTDOWN;
+                    outputs.cause = ShutdownCause::OVERTEMPERATURE;
+                    outputs.pumpSpeed = 0.0f;
+                    outputs.fanSpeed = 0.0f;
+                }
+                break;
+            }
+
+            // Safety shutdown if temperature exceeds critical threshold
+            if (outputs.measuredTemperature > safetyThreshold) {
+                outputs.state = SystemState::SAFETY_SHUTDOWN;
+                outputs.cause = ShutdownCause::OVERTEMPERATURE;
+                outputs.pumpSpeed = 0.0f;
+                outputs.fanSpeed = 0.0f;
+            }
+            break;
+        }
+
+        case SystemState::SAFETY_SHUTDOWN:
+            // Latched until the system is restarted
+            break;
+    }
+    return outputs;
+}
+
+// Function for safety shutdown
+void safetyShutdown(SystemState& state) {
+    state = SystemState::SAFETY_SHUTDOWN;
+    std::cerr << "System entering safety shutdown mode.\n";
+}
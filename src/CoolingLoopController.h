@@ -0,0 +1,154 @@
+/*
+Cooling loop controller: state machine and PID loops for the pump and fan.
+*/
+
+#ifndef COOLINGLOOP_CONTROLLER_H
+#define COOLINGLOOP_CONTROLLER_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Afterrun.h"
+#include "Calibration.h"
+#include "Derating.h"
+#include "PIDController.h"
+#include "SensorDiagnostics.h"
+#include "SensorVoting.h"
+
+// State machine states
+enum class SystemState {
+    OFF,
+    ON,
+    SAFETY_SHUTDOWN,
+    AFTERRUN // Ignition off, still cooling (see Afterrun.h)
+};
+
+// Reason the controller entered SAFETY_SHUTDOWN
+enum class ShutdownCause {
+    NONE,
+    LOW_COOLANT,
+    OVERTEMPERATURE
+};
+
+// Inputs sampled once per control cycle
+struct SensorInputs {
+    float sensorVoltage; // Inverter-outlet temperature sensor voltage (V)
+    bool ignitionSwitch; // Ignition switch input
+    bool levelSwitch;    // Coolant level (true = sufficient, false = low)
+    float redundantVoltage[MAX_SENSOR_CHANNELS - 1] = {0.0f, 0.0f}; // DC-DC outlet, optional third (V)
+    int sensorCount = 1; // Temperature channels fitted (1-3)
+    float setpointRaise = 0.0f; // Junction headroom: coolant may run this much above the setpoint (K),
+                                // at most half way to the threshold (see JunctionEstimator.h)
+    float coolingFloor = 0.0f;  // Predictive pre-cooling: pump and fan run at least this fast (%),
+                                // ahead of a forecast load (see PreCooling.h)
+    bool afterrunExpired = false; // The owner's afterrun timer has fired
+    bool afterrunSoaked = false;  // The owner's soak timer has fired; stays set until the afterrun ends
+};
+
+// Result of one control cycle
+struct ControlOutputs {
+    SystemState state;
+    ShutdownCause cause;
+    float measuredTemperature; // Interpolated coolant temperature (°C)
+    float pumpSpeed;           // Pump command (0-100%)
+    float fanSpeed;            // Fan command (0-100%)
+    SensorStatus sensorStatus; // First implausible channel this cycle (VALID if none)
+    std::uint8_t activeSensors; // Bit i set when channel i drives the control temperature
+    bool sensorDisagreement;   // Plausible channels differ by more than the voting spread
+    float allowedPower = 100.0f; // Inverter and DC-DC power limit (%), below 100 only when derating
+    float afterrunSeconds = 0.0f; // Set in the cycle AFTERRUN is entered: how long it should last (s)
+    float soakSeconds = 0.0f;     // Set with afterrunSeconds: no early end before this time (s)
+};
+
+// Cooling loop controller: state machine and PID loops for one cycle, without any I/O.
+// main() feeds it sensor inputs and applies the returned outputs to the pump, fan and CAN bus.
+class CoolingLoopController {
+private:
+    PIDController pumpPID;
+    PIDController fanPID;
+    float tempSetpoint;
+    float safetyThreshold;
+    SensorLimits sensorLimits;
+    float maxStepRate; // Sensor rate-of-change limit (V/s), sensorLimits.maxStep at the period
+    VotingLimits votingLimits;
+    SensorTable temperatureTable; // Points into the calibration image
+    float previousVoltage[MAX_SENSOR_CHANNELS]; // Last raw samples, for the rate-of-change check
+    bool hasPreviousVoltage;
+    bool derating; // Derate above the setpoint instead of shutting down at the threshold
+    DerateLimits derateLimits;
+    bool afterrun; // Keep cooling after key-off
+    AfterrunLimits afterrunLimits;
+    float periodRatio; // Control period over CALIBRATION_PERIOD
+    ControlOutputs outputs;
+
+    bool measureTemperature(const SensorInputs& inputs, float& measured);
+    void switchOff();
+    void stepAfterrun(const SensorInputs& inputs);
+
+public:
+    // Gains, sensor table and limits come from the calibration image, which must outlive the
+    // controller (the built-in one or a mapped file)
+    CoolingLoopController(const CalibrationImage& calibration, float setpoint, float threshold)
+        : pumpPID(calibration.pumpGains[0], calibration.pumpGains[1], calibration.pumpGains[2]),
+          fanPID(calibration.fanGains[0], calibration.fanGains[1], calibration.fanGains[2]),
+          tempSetpoint(setpoint), safetyThreshold(threshold),
+          sensorLimits{calibration.openVoltage, calibration.shortVoltage, calibration.maxStep},
+          maxStepRate(calibration.maxStep / CALIBRATION_PERIOD),
+          votingLimits{calibration.maxSpread}, temperatureTable(sensorTable(calibration)),
+          previousVoltage{0.0f, 0.0f, 0.0f}, hasPreviousVoltage(false), derating(false), afterrun(false),
+          periodRatio(1.0f), outputs{SystemState::OFF, ShutdownCause::NONE, 0.0f, 0.0f, 0.0f, SensorStatus::VALID, 0, false} {
+        // Cooling is reverse-acting (demand rises above the setpoint), hence the negative gains
+        pumpPID.setOutputLimits(0.0f, 100.0f);
+        fanPID.setOutputLimits(0.0f, 100.0f);
+    }
+
+    CoolingLoopController(float setpoint, float threshold)
+        : CoolingLoopController(defaultCalibration(), setpoint, threshold) {}
+
+    // Graduated derating (see Derating.h): above the setpoint the allowed power falls and the
+    // cooling runs at full speed, and the threshold no longer latches SAFETY_SHUTDOWN. Low
+    // coolant still shuts down, with the allowed power at the minimum.
+    void enableDerating(const DerateLimits& limits) {
+        derating = true;
+        derateLimits = limits;
+        derateLimits.recoveryRate *= periodRatio;
+    }
+
+    // Control period (s). The integral and derivative gains and the sensor rate-of-change
+    // limit of the calibration, and the derating recovery rate, are per cycle of
+    // CALIBRATION_PERIOD; at another period they are rescaled so the loop behaves the same per
+    // second. The rate-of-change limit keeps SENSOR_NOISE_FLOOR per sample at short periods.
+    void setControlPeriod(float seconds) {
+        float ratio = seconds / CALIBRATION_PERIOD;
+        float change = ratio / periodRatio;
+        pumpPID.scalePeriod(change);
+        fanPID.scalePeriod(change);
+        sensorLimits.maxStep = std::max(maxStepRate * seconds, SENSOR_NOISE_FLOOR);
+        derateLimits.recoveryRate *= change;
+        periodRatio = ratio;
+    }
+
+    // Afterrun (see Afterrun.h): at key-off a loop above the end temperature goes to AFTERRUN
+    // instead of OFF, for the time reported in ControlOutputs::afterrunSeconds
+    void enableAfterrun(const AfterrunLimits& limits) {
+        afterrun = true;
+        afterrunLimits = limits;
+    }
+
+    const ControlOutputs& step(const SensorInputs& inputs);
+    SystemState state() const { return outputs.state; }
+    const ControlOutputs& lastOutputs() const { return outputs; }
+
+    // Versioned binary snapshot of the whole dynamic state (see Checkpoint.h). save returns the
+    // bytes written, 0 if the buffer is too small; restore returns false and leaves the
+    // controller untouched if the snapshot is damaged, of another version or was taken with
+    // other setpoints. A warm restart clears a latched shutdown; a rollback (warmRestart
+    // false, as in co-simulation) keeps it.
+    std::size_t saveCheckpoint(unsigned char* buffer, std::size_t size) const;
+    bool restoreCheckpoint(const unsigned char* buffer, std::size_t size, bool warmRestart = true);
+};
+
+// Function for safety shutdown
+void safetyShutdown(SystemState& state);
+
+#endif // COOLINGLOOP_CONTROLLER_H
@@ -0,0 +1,38 @@
+/*
+Graduated thermal derating: instead of switching the cooling off at the safety threshold,
+the controller asks the inverter and the DC-DC converter to limit their power, so their
+losses fall and the coolant recovers while the vehicle keeps moving.
+
+The allowed power is 100 % up to the setpoint and falls along a smoothstep to the minimum
+at the threshold: flat at both ends, so the small overshoots of normal regulation around
+the setpoint cost almost nothing, and continuous with a continuous slope, so the drivetrain
+sees no steps. A lower limit takes effect at once; a higher one is granted at most
+recoveryRate per control cycle, so power does not oscillate with the coolant temperature.
+While derating, pump and fan stay at 100 %.
+
+Derating replaces the overtemperature shutdown only as long as it can work. If the pump has
+failed or the inverter ignores the limit, the coolant keeps rising past the threshold; at
+tripMargin above it SAFETY_SHUTDOWN latches as without derating, as a last resort.
+
+The allowed power goes out on its own CAN message (encodeDerateFrame() in CANBus.h).
+*/
+
+#ifndef COOLINGLOOP_DERATING_H
+#define COOLINGLOOP_DERATING_H
+
+struct DerateLimits {
+    float minimumPower = 0.0f; // Allowed power at and above the threshold (%)
+    float recoveryRate = 2.0f; // Largest rise of the allowed power per control cycle (%)
+    float tripMargin = 10.0f;  // Overtemperature shutdown this far above the threshold (K)
+};
+
+// Allowed inverter and DC-DC power (%) at a coolant temperature (°C)
+inline float deratedPower(float temperature, float setpoint, float threshold, float minimumPower) {
+    if (temperature <= setpoint) return 100.0f;
+    if (temperature >= threshold) return minimumPower;
+    float t = (temperature - setpoint) / (threshold - setpoint);
+    float fall = t * t * (3.0f - 2.0f * t);
+    return 100.0f - fall * (100.0f - minimumPower);
+}
+
+#endif // COOLINGLOOP_DERATING_H
@@ -0,0 +1,291 @@
+#include "DriveCycle.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Read-ahead window in front of the reader, and how far it moves before it is renewed
+const std::size_t READ_AHEAD = 4 << 20;
+const std::size_t ADVISE_STRIDE = 1 << 20;
+
+// Column offsets within a block of the binary format
+const std::size_t TIME_COLUMN = 0;
+const std::size_t SPEED_COLUMN = DRIVE_CYCLE_BLOCK * sizeof(double);
+const std::size_t INVERTER_COLUMN = SPEED_COLUMN + DRIVE_CYCLE_BLOCK * sizeof(float);
+const std::size_t DCDC_COLUMN = INVERTER_COLUMN + DRIVE_CYCLE_BLOCK * sizeof(float);
+const std::size_t AMBIENT_COLUMN = DCDC_COLUMN + DRIVE_CYCLE_BLOCK * sizeof(float);
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+// One CSV field and the comma after it (or the end of the line for the last one); nullptr
+// if it is not a number
+template <class Value>
+const char* parseField(const char* p, const char* end, Value& value, bool last) {
+    p = skipSpaces(p, end);
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return nullptr;
+    p = skipSpaces(result.ptr, end);
+    if (last) return p == end ? p : nullptr;
+    return p < end && *p == ',' ? p + 1 : nullptr;
+}
+
+std::size_t binarySize(std::uint64_t samples) {
+    std::uint64_t blocks = (samples + DRIVE_CYCLE_BLOCK - 1) / DRIVE_CYCLE_BLOCK;
+    return sizeof(DriveCycleHeader) + static_cast<std::size_t>(blocks) * DRIVE_CYCLE_BLOCK_BYTES;
+}
+
+} // namespace
+
+DriveCycleReader::DriveCycleReader()
+    : data(nullptr), size(0), offset(0), adviseAt(0), released(0), mapped(false), isBinary(false), samples(0),
+      index(0), lastTime(-std::numeric_limits<double>::infinity()) {}
+
+bool DriveCycleReader::open(const char* path, std::string& error) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        error = std::string(path) + ": cannot open";
+        return false;
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        size = static_cast<std::size_t>(info.st_size);
+        mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        size = 0;
+        error = std::string(path) + ": empty or cannot be mapped";
+        return false;
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapping);
+    mapped = true;
+#else
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        error = std::string(path) + ": cannot open";
+        return false;
+    }
+    char chunk[1 << 16];
+    std::size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) buffer.insert(buffer.end(), chunk, chunk + got);
+    std::fclose(file);
+    if (buffer.empty()) {
+        error = std::string(path) + ": empty";
+        return false;
+    }
+    data = buffer.data();
+    size = buffer.size();
+#endif
+
+    DriveCycleHeader header;
+    if (size >= sizeof(header)) {
+        std::memcpy(&header, data, sizeof(header));
+        isBinary = header.magic == DRIVE_CYCLE_MAGIC;
+    }
+    if (isBinary) {
+        // Bound the sample count by the file first, so a crafted count cannot wrap the size
+        // computation around to the real size and let reads run past the mapping
+        const std::uint64_t fits = (size - sizeof(header)) / DRIVE_CYCLE_BLOCK_BYTES * DRIVE_CYCLE_BLOCK;
+        if (header.version != DRIVE_CYCLE_VERSION || header.blockSamples != DRIVE_CYCLE_BLOCK ||
+            header.samples > fits || size != binarySize(header.samples)) {
+            close();
+            error = std::string(path) + ": damaged or unsupported drive cycle file";
+            return false;
+        }
+        samples = header.samples;
+    }
+    advance(0);
+    return true;
+}
+
+void DriveCycleReader::close() {
+#ifndef _WIN32
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+    buffer.clear();
+    data = nullptr;
+    size = offset = adviseAt = released = 0;
+    mapped = isBinary = false;
+    samples = index = 0;
+    lastTime = -std::numeric_limits<double>::infinity();
+    failure.clear();
+}
+
+// Move the read-ahead window to position and drop the pages before it
+void DriveCycleReader::advance(std::size_t position) {
+    if (position < adviseAt) {
+        return;
+    }
+    adviseAt = position + ADVISE_STRIDE;
+#ifndef _WIN32
+    if (mapped) {
+        std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t start = position / page * page;
+        char* base = const_cast<char*>(data);
+        ::madvise(base + start, std::min(size - start, READ_AHEAD), MADV_WILLNEED);
+        if (start > released) {
+            ::madvise(base + released, start - released, MADV_DONTNEED);
+            released = start;
+        }
+    }
+#endif
+}
+
+bool DriveCycleReader::fail(const std::string& message) {
+    failure = message;
+    return false;
+}
+
+bool DriveCycleReader::next(DriveCycleSample& sample) {
+    if (!failure.empty() || !(isBinary ? nextBinary(sample) : nextCsv(sample))) {
+        return false;
+    }
+    if (!(sample.time > lastTime)) {
+        return fail("sample " + std::to_string(index + 1) + ": time does not increase");
+    }
+    lastTime = sample.time;
+    ++index;
+    return true;
+}
+
+bool DriveCycleReader::nextBinary(DriveCycleSample& sample) {
+    if (index >= samples) {
+        return false;
+    }
+    std::size_t lane = static_cast<std::size_t>(index % DRIVE_CYCLE_BLOCK);
+    std::size_t blockStart = sizeof(DriveCycleHeader) + static_cast<std::size_t>(index / DRIVE_CYCLE_BLOCK) * DRIVE_CYCLE_BLOCK_BYTES;
+    if (lane == 0) advance(blockStart);
+    const char* block = data + blockStart;
+    std::memcpy(&sample.time, block + TIME_COLUMN + lane * sizeof(double), sizeof(double));
+    std::memcpy(&sample.speed, block + SPEED_COLUMN + lane * sizeof(float), sizeof(float));
+    std::memcpy(&sample.inverterLoss, block + INVERTER_COLUMN + lane * sizeof(float), sizeof(float));
+    std::memcpy(&sample.dcdcLoss, block + DCDC_COLUMN + lane * sizeof(float), sizeof(float));
+    std::memcpy(&sample.ambient, block + AMBIENT_COLUMN + lane * sizeof(float), sizeof(float));
+    return true;
+}
+
+bool DriveCycleReader::nextCsv(DriveCycleSample& sample) {
+    const char* end = data + size;
+    while (offset < size) {
+        const char* line = data + offset;
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', size - offset));
+        if (!eol) eol = end;
+        advance(offset);
+        offset = static_cast<std::size_t>(eol - data) + (eol < end ? 1 : 0);
+
+        const char* p = skipSpaces(line, eol);
+        if (p == eol || *p == '#') continue;
+        if (index == 0 && std::isalpha(static_cast<unsigned char>(*p))) continue; // Header
+
+        p = parseField(p, eol, sample.time, false);
+        if (p) p = parseField(p, eol, sample.speed, false);
+        if (p) p = parseField(p, eol, sample.inverterLoss, false);
+        if (p) p = parseField(p, eol, sample.dcdcLoss, false);
+        if (p) p = parseField(p, eol, sample.ambient, true);
+        if (!p) {
+            return fail("sample " + std::to_string(index + 1) +
+                        ": expected time, speed, inverter loss, DC-DC loss, ambient");
+        }
+        return true;
+    }
+    return false;
+}
+
+DriveCycleWriter::~DriveCycleWriter() {
+    if (file) std::fclose(file);
+}
+
+bool DriveCycleWriter::open(const char* path) {
+    if (file) std::fclose(file);
+    file = std::fopen(path, "wb");
+    block.assign(DRIVE_CYCLE_BLOCK_BYTES, 0);
+    filled = 0;
+    samples = 0;
+    // Sample count 0 until close(), so an unfinished file fails the size check
+    DriveCycleHeader header{DRIVE_CYCLE_MAGIC, DRIVE_CYCLE_VERSION, DRIVE_CYCLE_BLOCK, 0, 0, 0};
+    return file && std::fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+bool DriveCycleWriter::write(const DriveCycleSample& sample) {
+    if (!file) {
+        return false;
+    }
+    char* base = block.data();
+    std::memcpy(base + TIME_COLUMN + filled * sizeof(double), &sample.time, sizeof(double));
+    std::memcpy(base + SPEED_COLUMN + filled * sizeof(float), &sample.speed, sizeof(float));
+    std::memcpy(base + INVERTER_COLUMN + filled * sizeof(float), &sample.inverterLoss, sizeof(float));
+    std::memcpy(base + DCDC_COLUMN + filled * sizeof(float), &sample.dcdcLoss, sizeof(float));
+    std::memcpy(base + AMBIENT_COLUMN + filled * sizeof(float), &sample.ambient, sizeof(float));
+    ++samples;
+    return ++filled < DRIVE_CYCLE_BLOCK || flushBlock();
+}
+
+bool DriveCycleWriter::flushBlock() {
+    bool ok = std::fwrite(block.data(), block.size(), 1, file) == 1;
+    std::fill(block.begin(), block.end(), 0);
+    filled = 0;
+    return ok;
+}
+
+bool DriveCycleWriter::close() {
+    if (!file) {
+        return false;
+    }
+    bool ok = filled == 0 || flushBlock();
+    DriveCycleHeader header{DRIVE_CYCLE_MAGIC, DRIVE_CYCLE_VERSION, DRIVE_CYCLE_BLOCK, 0, samples, 0};
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+bool DriveCycleProfile::open(const char* path, std::string& error) {
+    if (!reader.open(path, error)) {
+        return false;
+    }
+    if (!reader.next(before)) {
+        error = std::string(path) + ": " + (reader.error().empty() ? "no samples" : reader.error());
+        return false;
+    }
+    after = before;
+    return true;
+}
+
+bool DriveCycleProfile::at(double seconds, DriveCycleSample& sample) {
+    while (seconds > after.time) {
+        before = after;
+        if (!reader.next(after)) {
+            return false;
+        }
+    }
+    sample = before;
+    if (seconds > before.time) {
+        float f = static_cast<float>((seconds - before.time) / (after.time - before.time));
+        sample.speed += f * (after.speed - before.speed);
+        sample.inverterLoss += f * (after.inverterLoss - before.inverterLoss);
+        sample.dcdcLoss += f * (after.dcdcLoss - before.dcdcLoss);
+        sample.ambient += f * (after.ambient - before.ambient);
+    }
+    sample.time = seconds;
+    return true;
+}
@@ -0,0 +1,142 @@
+/*
+Drive-cycle heat-load profiles: vehicle speed, inverter and DC-DC losses and ambient
+temperature over time, recorded on a vehicle or exported from a fleet log, played back
+through the plant model at the control rate.
+
+Two file formats are read:
+  * CSV, one sample per line: time (s), speed (km/h), inverter loss (W), DC-DC loss (W),
+    ambient (°C). A header line, blank lines and '#' comments are skipped.
+  * The binary column format written by DriveCycleConvert: a 32-byte header, then blocks of
+    DRIVE_CYCLE_BLOCK samples, each stored as five columns (time as double, the others as
+    float, little-endian). The last block is padded.
+
+Either file is mapped read-only and streamed forward, never loaded: as the reader moves on
+it asks the kernel to read the next few megabytes ahead (MADV_WILLNEED) and drops the pages
+it has passed (MADV_DONTNEED), so a multi-gigabyte fleet log plays back in a few megabytes
+of resident memory. Without mmap (Windows) the file is read into memory instead.
+
+DriveCycleProfile interpolates the samples linearly to the control times, which must not
+go backwards.
+*/
+
+#ifndef COOLINGLOOP_DRIVE_CYCLE_H
+#define COOLINGLOOP_DRIVE_CYCLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+const std::uint32_t DRIVE_CYCLE_MAGIC = 0x43444C43; // "CLDC"
+const std::uint32_t DRIVE_CYCLE_VERSION = 1;
+const std::uint32_t DRIVE_CYCLE_BLOCK = 4096; // Samples per block of the binary format
+
+struct DriveCycleSample {
+    double time;        // s
+    float speed;        // Vehicle speed (km/h)
+    float inverterLoss; // W
+    float dcdcLoss;     // W
+    float ambient;      // Air temperature at the radiator (°C)
+};
+
+struct DriveCycleHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t blockSamples; // DRIVE_CYCLE_BLOCK
+    std::uint32_t reserved;
+    std::uint64_t samples;
+    std::uint64_t reserved2;
+};
+
+static_assert(sizeof(DriveCycleHeader) == 32, "drive cycle header layout is part of the file format");
+
+// Bytes of one block of the binary format
+const std::size_t DRIVE_CYCLE_BLOCK_BYTES = DRIVE_CYCLE_BLOCK * (sizeof(double) + 4 * sizeof(float));
+
+// Forward-only reader of a CSV or binary drive-cycle file
+class DriveCycleReader {
+private:
+    const char* data;    // Mapped file
+    std::size_t size;
+    std::size_t offset;  // CSV: start of the next line
+    std::size_t adviseAt; // Offset at which to move the read-ahead window on
+    std::size_t released; // Pages before this offset have been dropped
+    bool mapped;
+    bool isBinary;
+    std::uint64_t samples; // Binary: samples in the file
+    std::uint64_t index;   // Samples read so far
+    double lastTime;
+    std::string failure;
+    std::vector<char> buffer; // Without mmap
+
+    bool nextBinary(DriveCycleSample& sample);
+    bool nextCsv(DriveCycleSample& sample);
+    void advance(std::size_t position);
+    bool fail(const std::string& message);
+
+public:
+    DriveCycleReader();
+    ~DriveCycleReader() { close(); }
+
+    DriveCycleReader(const DriveCycleReader&) = delete;
+    DriveCycleReader& operator=(const DriveCycleReader&) = delete;
+
+    // Map a file; the format is taken from its first bytes
+    bool open(const char* path, std::string& error);
+    void close();
+
+    // Next sample; false at the end of the file or on a malformed sample, with error() set
+    // in the second case. Times must increase strictly.
+    bool next(DriveCycleSample& sample);
+
+    const std::string& error() const { return failure; }
+    bool binary() const { return isBinary; }
+    std::uint64_t position() const { return index; }
+};
+
+// Writer of the binary column format, one block buffered at a time
+class DriveCycleWriter {
+private:
+    std::FILE* file;
+    std::vector<char> block;
+    std::uint32_t filled; // Samples in block
+    std::uint64_t samples;
+
+    bool flushBlock();
+
+public:
+    DriveCycleWriter() : file(nullptr), filled(0), samples(0) {}
+    ~DriveCycleWriter();
+
+    DriveCycleWriter(const DriveCycleWriter&) = delete;
+    DriveCycleWriter& operator=(const DriveCycleWriter&) = delete;
+
+    bool open(const char* path);
+    bool write(const DriveCycleSample& sample);
+
+    // Pad and write the last block and the sample count; false if anything failed to write
+    bool close();
+};
+
+// Drive cycle interpolated to the control rate
+class DriveCycleProfile {
+private:
+    DriveCycleReader reader;
+    DriveCycleSample before; // Last sample at or before the requested time
+    DriveCycleSample after;  // First sample after it
+
+public:
+    DriveCycleProfile() : before{0.0, 0.0f, 0.0f, 0.0f, 0.0f}, after(before) {}
+
+    // Open the file and read its first sample
+    bool open(const char* path, std::string& error);
+
+    // Sample at seconds, interpolated linearly (the first sample before it starts). False
+    // after the last sample or on a malformed one (error()).
+    bool at(double seconds, DriveCycleSample& sample);
+
+    const std::string& error() const { return reader.error(); }
+};
+
+#endif // COOLINGLOOP_DRIVE_CYCLE_H
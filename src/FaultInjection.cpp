@@ -0,0 +1,353 @@
+#include "FaultInjection.h"
+
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <sstream>
+
+#include "CANBus.h"
+#include "CommandLine.h"
+#include "HealthEstimator.h"
+
+namespace {
+
+const char* const FAULT_TYPE_NAMES[FAULT_TYPE_COUNT] = {
+    "stuck_sensor", "open_circuit", "short_circuit", "level_chatter", "can_frame_loss", "ignition_glitch",
+    "filter_clog",  "pump_wear"};
+
+const char* const FAULT_OUTCOME_NAMES[FAULT_OUTCOME_COUNT] = {
+    "ON", "OFF", "LOW_COOLANT_SHUTDOWN", "OVERTEMP_SHUTDOWN", "SENSOR_FALLBACK", "UNDETECTED_OVERTEMP",
+    "MAINTENANCE_FLAG"};
+
+bool parseFaultType(const std::string& text, FaultType& type) {
+    for (int i = 0; i < FAULT_TYPE_COUNT; ++i) {
+        if (text == FAULT_TYPE_NAMES[i]) {
+            type = static_cast<FaultType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseFaultOutcome(const std::string& text, FaultOutcome& outcome) {
+    for (int i = 0; i < FAULT_OUTCOME_COUNT; ++i) {
+        if (text == FAULT_OUTCOME_NAMES[i]) {
+            outcome = static_cast<FaultOutcome>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Split "key=value"; returns false if there is no '='
+bool splitOption(const std::string& token, std::string& key, std::string& value) {
+    std::string::size_type eq = token.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+    key = token.substr(0, eq);
+    value = token.substr(eq + 1);
+    return true;
+}
+
+bool parseFaultLine(std::istringstream& line, FaultSpec& fault, std::string& error) {
+    std::string typeName, token, key, value;
+    if (!(line >> typeName) || !parseFaultType(typeName, fault.type)) {
+        error = "unknown fault type '" + typeName + "'";
+        return false;
+    }
+    fault.start = 0;
+    fault.duration = -1;
+    fault.value = NAN;
+    fault.period = 1;
+    fault.channel = 0;
+    while (line >> token) {
+        bool ok = splitOption(token, key, value);
+        if (ok && key == "start") {
+            ok = parseCount(value.c_str(), fault.start);
+        } else if (ok && key == "duration") {
+            ok = parseCount(value.c_str(), fault.duration);
+        } else if (ok && key == "value") {
+            ok = parseFloat(value.c_str(), fault.value);
+        } else if (ok && key == "period") {
+            ok = parseCount(value.c_str(), fault.period) && fault.period > 0;
+        } else if (ok && key == "channel") {
+            long channel = 0;
+            ok = parseCount(value.c_str(), channel) && channel >= 0 && channel < MAX_SENSOR_CHANNELS;
+            fault.channel = static_cast<int>(channel);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = "bad fault option '" + token + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseExpectLine(std::istringstream& line, FaultExpectation& expectation, std::string& error) {
+    std::string token, key, value;
+    while (line >> token) {
+        bool ok = splitOption(token, key, value);
+        if (ok && key == "reach") {
+            ok = parseFaultOutcome(value, expectation.reach);
+            expectation.hasReach = true;
+        } else if (ok && key == "within") {
+            ok = parseCount(value.c_str(), expectation.within);
+        } else if (ok && key == "never") {
+            ok = parseFaultOutcome(value, expectation.never);
+            expectation.hasNever = true;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = "bad expectation '" + token + "'";
+            return false;
+        }
+    }
+    if (!expectation.hasReach && !expectation.hasNever) {
+        error = "expectation needs reach= or never=";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+const char* faultTypeName(FaultType type) {
+    return FAULT_TYPE_NAMES[static_cast<int>(type)];
+}
+
+const char* faultOutcomeName(FaultOutcome outcome) {
+    return FAULT_OUTCOME_NAMES[static_cast<int>(outcome)];
+}
+
+// Parse a scenario file
+bool parseFaultScenario(std::istream& in, FaultScenario& scenario, std::string& error) {
+    std::string text;
+    int lineNumber = 0;
+    while (std::getline(in, text)) {
+        ++lineNumber;
+        std::string::size_type comment = text.find('#');
+        if (comment != std::string::npos) {
+            text.erase(comment);
+        }
+        std::istringstream line(text);
+        std::string keyword, value;
+        if (!(line >> keyword)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (keyword == "fault") {
+            FaultSpec fault;
+            ok = parseFaultLine(line, fault, error);
+            scenario.faults.push_back(fault);
+        } else if (keyword == "expect") {
+            FaultExpectation expectation;
+            ok = parseExpectLine(line, expectation, error);
+            scenario.expectations.push_back(expectation);
+        } else if (!(line >> value)) {
+            ok = false;
+            error = "missing value for '" + keyword + "'";
+        } else if (keyword == "name") {
+            scenario.name = value;
+        } else if (keyword == "cycles") {
+            ok = parseCount(value.c_str(), scenario.cycles);
+        } else if (keyword == "dt") {
+            ok = parseFloat(value.c_str(), scenario.dt);
+        } else if (keyword == "load") {
+            ok = parseFloat(value.c_str(), scenario.heatLoad);
+        } else if (keyword == "initial") {
+            ok = parseFloat(value.c_str(), scenario.initialTemperature);
+        } else if (keyword == "setpoint") {
+            ok = parseFloat(value.c_str(), scenario.setpoint);
+        } else if (keyword == "threshold") {
+            ok = parseFloat(value.c_str(), scenario.threshold);
+        } else if (keyword == "sensors") {
+            long sensors = 0;
+            ok = parseCount(value.c_str(), sensors) && sensors >= 1 && sensors <= MAX_SENSOR_CHANNELS;
+            scenario.sensors = static_cast<int>(sensors);
+        } else {
+            ok = false;
+            error = "unknown keyword '" + keyword + "'";
+        }
+
+        if (!ok) {
+            if (error.empty()) {
+                error = "bad value '" + value + "' for '" + keyword + "'";
+            }
+            error = "line " + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rewrite the sampled inputs for this cycle
+SensorInputs FaultInjector::applySensorFaults(long cycle, const SensorInputs& sampled) {
+    SensorInputs inputs = sampled;
+    for (const FaultSpec& fault : *faults) {
+        if (!fault.activeAt(cycle)) {
+            continue;
+        }
+        bool hasValue = !std::isnan(fault.value);
+        float& voltage = fault.channel == 0 ? inputs.sensorVoltage : inputs.redundantVoltage[fault.channel - 1];
+        switch (fault.type) {
+            case FaultType::STUCK_SENSOR:
+                if (cycle == fault.start) {
+                    stuckVoltage[fault.channel] = hasValue ? fault.value : voltage;
+                }
+                voltage = stuckVoltage[fault.channel];
+                break;
+            case FaultType::OPEN_CIRCUIT:
+                voltage = hasValue ? fault.value : 5.0f;
+                break;
+            case FaultType::SHORT_CIRCUIT:
+                voltage = hasValue ? fault.value : 0.0f;
+                break;
+            case FaultType::LEVEL_CHATTER:
+                inputs.levelSwitch = ((cycle - fault.start) / fault.period) % 2 == 1;
+                break;
+            case FaultType::IGNITION_GLITCH:
+                inputs.ignitionSwitch = false;
+                break;
+            case FaultType::CAN_FRAME_LOSS:
+                break; // CAN path, see dropCANFrame()
+            case FaultType::FILTER_CLOG:
+            case FaultType::PUMP_WEAR:
+                break; // Plant, see applyPlantFaults()
+        }
+    }
+    return inputs;
+}
+
+// True if the CAN frame transmitted in this cycle is lost on the bus
+bool FaultInjector::dropCANFrame(long cycle) const {
+    for (const FaultSpec& fault : *faults) {
+        if (fault.type == FaultType::CAN_FRAME_LOSS && fault.activeAt(cycle) &&
+            (cycle - fault.start) % fault.period == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Set the filter and pump degradation of the plant for this cycle
+void FaultInjector::applyPlantFaults(long cycle, PlantModel& plant) const {
+    float resistance = 1.0f;
+    float wear = 0.0f;
+    for (const FaultSpec& fault : *faults) {
+        bool hasValue = !std::isnan(fault.value);
+        if (fault.type == FaultType::FILTER_CLOG) {
+            resistance += ((hasValue ? fault.value : 20.0f) - 1.0f) * fault.severityAt(cycle);
+        } else if (fault.type == FaultType::PUMP_WEAR) {
+            wear += (hasValue ? fault.value : 0.3f) * fault.severityAt(cycle);
+        }
+    }
+    plant.setFilterResistance(resistance);
+    plant.setPumpWear(wear < 1.0f ? wear : 1.0f);
+}
+
+long FaultRunResult::latency(FaultOutcome outcome) const {
+    long reached = reachedAt[static_cast<int>(outcome)];
+    return reached < 0 ? -1 : reached - firstFault;
+}
+
+// Run a scenario closed-loop against the plant model
+FaultRunResult runFaultScenario(const FaultScenario& scenario) {
+    FaultRunResult result;
+    for (long& reached : result.reachedAt) {
+        reached = -1;
+    }
+    result.firstFault = scenario.faults.empty() ? 0 : scenario.cycles;
+    for (const FaultSpec& fault : scenario.faults) {
+        if (fault.start < result.firstFault) result.firstFault = fault.start;
+    }
+
+    CoolingLoopController controller(scenario.setpoint, scenario.threshold);
+    controller.setControlPeriod(scenario.dt);
+    PlantParameters parameters;
+    parameters.heatLoad = scenario.heatLoad;
+    PlantModel plant(parameters, scenario.initialTemperature);
+    FaultInjector injector(scenario.faults);
+    HealthLimits healthLimits;
+    HealthState health(healthLimits);
+    const long healthEvery = static_cast<long>(healthSampleEvery(scenario.dt));
+
+    // Commands as last received by the pump and fan motor controllers
+    float appliedPump = 0.0f;
+    float appliedFan = 0.0f;
+    result.peakTemperature = plant.temperature();
+
+    for (long cycle = 0; cycle < scenario.cycles; ++cycle) {
+        float voltage = plant.sensorVoltage();
+        SensorInputs inputs = injector.applySensorFaults(
+            cycle, {voltage, true, true, {voltage, voltage}, scenario.sensors});
+        const ControlOutputs& out = controller.step(inputs);
+
+        CANFrame frame = encodeCANFrame(out.pumpSpeed, out.fanSpeed);
+        if (!injector.dropCANFrame(cycle)) {
+            decodeCANFrame(frame, appliedPump, appliedFan);
+        }
+        injector.applyPlantFaults(cycle, plant);
+        plant.step(scenario.dt, appliedPump, appliedFan);
+        if (cycle % healthEvery == 0) {
+            updateHealth(health,
+                         {appliedPump, plant.pumpRpm(), plant.inletTemperature(), plant.temperature(), plant.heatLoad()},
+                         healthLimits);
+        }
+        if (plant.temperature() > result.peakTemperature) result.peakTemperature = plant.temperature();
+
+        // Record the outcomes seen from the first fault on
+        if (cycle >= result.firstFault) {
+            bool seen[FAULT_OUTCOME_COUNT] = {false};
+            seen[static_cast<int>(FaultOutcome::MAINTENANCE_FLAG)] = health.flags != 0;
+            switch (out.state) {
+                case SystemState::OFF:
+                    seen[static_cast<int>(FaultOutcome::OFF)] = true;
+                    break;
+                case SystemState::ON:
+                case SystemState::AFTERRUN: // Not enabled in the scenarios
+                    seen[static_cast<int>(FaultOutcome::ON)] = true;
+                    seen[static_cast<int>(FaultOutcome::SENSOR_FALLBACK)] = out.activeSensors == 0;
+                    seen[static_cast<int>(FaultOutcome::UNDETECTED_OVERTEMP)] = plant.temperature() > scenario.threshold;
+                    break;
+                case SystemState::SAFETY_SHUTDOWN:
+                    seen[static_cast<int>(out.cause == ShutdownCause::LOW_COOLANT ? FaultOutcome::LOW_COOLANT_SHUTDOWN
+                                                                                 : FaultOutcome::OVERTEMP_SHUTDOWN)] = true;
+                    break;
+            }
+            for (int i = 0; i < FAULT_OUTCOME_COUNT; ++i) {
+                if (seen[i] && result.reachedAt[i] < 0) result.reachedAt[i] = cycle;
+            }
+        }
+        result.finalOutputs = out;
+
+        // Shutdown is latched, nothing changes after it
+        if (out.state == SystemState::SAFETY_SHUTDOWN) {
+            break;
+        }
+    }
+
+    // Check the expectations
+    for (const FaultExpectation& expectation : scenario.expectations) {
+        if (expectation.hasReach) {
+            long latency = result.latency(expectation.reach);
+            if (latency < 0) {
+                result.passed = false;
+                result.failure += std::string("never reached ") + faultOutcomeName(expectation.reach) + "; ";
+            } else if (expectation.within >= 0 && latency > expectation.within) {
+                result.passed = false;
+                result.failure += std::string("reached ") + faultOutcomeName(expectation.reach) + " after " +
+                                  std::to_string(latency) + " cycles; ";
+            }
+        }
+        if (expectation.hasNever && result.latency(expectation.never) >= 0) {
+            result.passed = false;
+            result.failure += std::string("reached ") + faultOutcomeName(expectation.never) + "; ";
+        }
+    }
+    return result;
+}
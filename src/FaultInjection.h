@@ -0,0 +1,139 @@
+/*
+Fault injection for the sensor and CAN paths.
+
+A scenario file declares which faults hit the loop and when, for example:
+
+    # Open temperature sensor wire ten minutes into a drive
+    name   open_sensor
+    cycles 3600
+    load   2500
+    fault  open_circuit start=600 duration=300
+    expect reach=SENSOR_FALLBACK within=0
+
+The injector rewrites the sampled SensorInputs and drops transmitted CAN frames while a
+fault is active, and degrades the plant (clogging filter, wearing pump); runFaultScenario()
+closes the loop through the plant model and records which states the controller and the
+health estimator reached after the first fault and how many cycles it took.
+*/
+
+#ifndef COOLINGLOOP_FAULT_INJECTION_H
+#define COOLINGLOOP_FAULT_INJECTION_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "CoolingLoopController.h"
+#include "PlantModel.h"
+
+// Faults that can be injected
+enum class FaultType {
+    STUCK_SENSOR,    // Voltage frozen at the value sampled at onset (or value=)
+    OPEN_CIRCUIT,    // Sensor wire open, input pulled up to the supply (value= overrides 5 V)
+    SHORT_CIRCUIT,   // Sensor shorted to ground (value= overrides 0 V)
+    LEVEL_CHATTER,   // Level switch toggles every period= cycles
+    CAN_FRAME_LOSS,  // Every period=-th pump/fan frame is lost (default: all of them)
+    IGNITION_GLITCH, // Ignition input drops out
+    FILTER_CLOG,     // Loop resistance ramps to value= x clean over duration= and stays (default 20)
+    PUMP_WEAR        // Pump loses value= of its speed, ramped over duration= and kept (default 0.3)
+};
+
+const int FAULT_TYPE_COUNT = 8;
+
+// Controller outcomes tracked by the coverage report
+enum class FaultOutcome {
+    ON,
+    OFF,
+    LOW_COOLANT_SHUTDOWN,
+    OVERTEMP_SHUTDOWN,
+    SENSOR_FALLBACK,    // No plausible temperature channel, full cooling commanded
+    UNDETECTED_OVERTEMP, // Real coolant above the safety threshold while the controller stays ON
+    MAINTENANCE_FLAG     // Health estimator raised a maintenance flag
+};
+
+const int FAULT_OUTCOME_COUNT = 7;
+
+const char* faultTypeName(FaultType type);
+const char* faultOutcomeName(FaultOutcome outcome);
+
+struct FaultSpec {
+    FaultType type;
+    long start;    // First cycle the fault is active
+    long duration; // Cycles the fault stays active (-1 = until the end)
+    float value;   // Override voltage for sensor faults (NaN = fault default)
+    long period;   // Toggle/drop period for chatter and frame loss
+    int channel = 0; // Temperature channel hit by sensor faults (0 = inverter outlet)
+
+    bool activeAt(long cycle) const {
+        return cycle >= start && (duration < 0 || cycle < start + duration);
+    }
+
+    // Ramp of a plant degradation from 0 at start to 1 after duration (kept at 1 afterwards)
+    float severityAt(long cycle) const {
+        if (cycle < start) return 0.0f;
+        if (duration <= 0 || cycle >= start + duration) return 1.0f;
+        return static_cast<float>(cycle - start) / static_cast<float>(duration);
+    }
+};
+
+// Expected behaviour; a scenario fails when any given expectation is not met
+struct FaultExpectation {
+    bool hasReach = false;
+    FaultOutcome reach = FaultOutcome::ON; // Outcome that must be reached after the first fault
+    long within = -1;                      // ... at most this many cycles after it (-1 = any time)
+    bool hasNever = false;
+    FaultOutcome never = FaultOutcome::ON; // Outcome that must never be reached
+};
+
+struct FaultScenario {
+    std::string name;
+    long cycles = 3600;
+    float dt = 1.0f;
+    float heatLoad = 2000.0f;
+    float initialTemperature = 25.0f;
+    float setpoint = 50.0f;
+    float threshold = 70.0f;
+    int sensors = 1; // Redundant temperature channels, all reading the plant coolant
+    std::vector<FaultSpec> faults;
+    std::vector<FaultExpectation> expectations;
+};
+
+// Parse a scenario file. Returns false and fills error (with the line number) on bad input.
+bool parseFaultScenario(std::istream& in, FaultScenario& scenario, std::string& error);
+
+// Applies the active faults of a scenario to the sensor and CAN paths
+class FaultInjector {
+private:
+    const std::vector<FaultSpec>* faults;
+    float stuckVoltage[MAX_SENSOR_CHANNELS];
+
+public:
+    explicit FaultInjector(const std::vector<FaultSpec>& scenarioFaults)
+        : faults(&scenarioFaults), stuckVoltage{0.0f, 0.0f, 0.0f} {}
+
+    // Rewrite the sampled inputs for this cycle
+    SensorInputs applySensorFaults(long cycle, const SensorInputs& sampled);
+
+    // True if the CAN frame transmitted in this cycle is lost on the bus
+    bool dropCANFrame(long cycle) const;
+
+    // Set the filter and pump degradation of the plant for this cycle
+    void applyPlantFaults(long cycle, PlantModel& plant) const;
+};
+
+// What one scenario run did
+struct FaultRunResult {
+    long firstFault = -1;                     // Cycle the first fault became active
+    long reachedAt[FAULT_OUTCOME_COUNT];      // First cycle each outcome was seen (-1 = never)
+    float peakTemperature = 0.0f;             // Real coolant peak (°C)
+    ControlOutputs finalOutputs{};
+    bool passed = true;
+    std::string failure;
+
+    long latency(FaultOutcome outcome) const;  // Cycles from the first fault, -1 if not reached
+};
+
+// Run a scenario closed-loop against the plant model (no I/O, no sleeps)
+FaultRunResult runFaultScenario(const FaultScenario& scenario);
+
+#endif // COOLINGLOOP_FAULT_INJECTION_H
@@ -0,0 +1,297 @@
+#include "FleetRuntime.h"
+
+#include <algorithm>
+#include <new>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(COOLINGLOOP_HAVE_NUMA)
+#include <numa.h>
+#endif
+
+namespace {
+
+// Spacing of the loops' drive profile offsets (s), coprime with the 30 minute profile
+const float PROFILE_SPACING = 97.0f;
+const float PROFILE_PERIOD = 1800.0f;
+
+// CPUs in the affinity mask of the process
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned count = std::thread::hardware_concurrency();
+        for (unsigned cpu = 0; cpu < (count ? count : 1); ++cpu) cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+bool pinToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Shard memory on a NUMA node; nullptr if exhausted
+void* allocateOnNode(std::size_t bytes, int node) {
+#if defined(COOLINGLOOP_HAVE_NUMA)
+    if (numa_available() >= 0) {
+        return numa_alloc_onnode(bytes, node);
+    }
+#endif
+    (void)node;
+    return ::operator new(bytes, std::align_val_t(64), std::nothrow);
+}
+
+void freeOnNode(void* memory, std::size_t bytes) {
+#if defined(COOLINGLOOP_HAVE_NUMA)
+    if (numa_available() >= 0) {
+        numa_free(memory, bytes);
+        return;
+    }
+#endif
+    (void)bytes;
+    ::operator delete(memory, std::align_val_t(64));
+}
+
+// Seed of a loop's stream: distinct, well mixed starting points rather than neighbouring
+// states of one sequence, which would make the streams of adjacent loops overlap
+std::uint64_t streamSeed(std::uint64_t seed, std::size_t index) {
+    std::uint64_t z = seed ^ (static_cast<std::uint64_t>(index) * 0xD1B54A32D192ED03ull);
+    z = (z ^ (z >> 32)) * 0xD6E8FEB86659FD93ull;
+    z = (z ^ (z >> 32)) * 0xD6E8FEB86659FD93ull;
+    return z ^ (z >> 32);
+}
+
+// Pairwise sum of value(i) over [0, count): the same tree, and so the same rounding, for a
+// given count, with an error growing with log(count) instead of count
+template <class Value>
+double pairwiseSum(std::size_t count, Value value, std::size_t first = 0) {
+    if (count <= 8) {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < count; ++i) sum += value(first + i);
+        return sum;
+    }
+    std::size_t half = count / 2;
+    return pairwiseSum(half, value, first) + pairwiseSum(count - half, value, first + half);
+}
+
+} // namespace
+
+float fleetProfileOffset(std::size_t index) {
+    float offset = static_cast<float>(index % 10000) * PROFILE_SPACING;
+    return offset - PROFILE_PERIOD * static_cast<int>(offset / PROFILE_PERIOD);
+}
+
+FleetLoop::FleetLoop(const FleetOptions& options, std::size_t index)
+    : controller(options.setpoint, options.threshold), plant(PlantParameters{}, 25.0f),
+      profileOffset(fleetProfileOffset(index)), loadNoise(options.loadNoise),
+      random(streamSeed(options.seed, index)), energy(0.0), energyCompensation(0.0) {}
+
+// Nodes with at least one usable CPU
+std::vector<NumaNode> numaNodes() {
+    std::vector<int> allowed = allowedCpus();
+    std::vector<NumaNode> nodes;
+#if defined(COOLINGLOOP_HAVE_NUMA)
+    if (numa_available() >= 0) {
+        struct bitmask* mask = numa_allocate_cpumask();
+        for (int node = 0; node <= numa_max_node(); ++node) {
+            std::vector<int> cpus;
+            if (numa_node_to_cpus(node, mask) == 0) {
+                for (int cpu : allowed) {
+                    if (numa_bitmask_isbitset(mask, static_cast<unsigned>(cpu))) cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) nodes.push_back(NumaNode{node, cpus});
+        }
+        numa_free_cpumask(mask);
+    }
+#endif
+    if (nodes.empty()) {
+        nodes.push_back(NumaNode{0, allowed});
+    }
+    return nodes;
+}
+
+FleetRuntime::FleetRuntime()
+    : nodesUsed(0), generation(0), pendingCycles(0), busy(0), quitting(false) {}
+
+bool FleetRuntime::start(const FleetOptions& fleetOptions) {
+    stop();
+    options = fleetOptions;
+
+    // The first options.nodes nodes
+    std::vector<NumaNode> nodes = numaNodes();
+    int nodeTotal = static_cast<int>(nodes.size());
+    nodesUsed = options.nodes > 0 && options.nodes < nodeTotal ? options.nodes : nodeTotal;
+    int cores = 0;
+    for (int n = 0; n < nodesUsed; ++n) cores += static_cast<int>(nodes[n].cpus.size());
+    int shardTotal = options.shards > 0 ? options.shards : cores;
+
+    // Contiguous loop ranges (whole reduction blocks in deterministic mode); shards in blocks
+    // per node, cores round robin within a node
+    std::size_t unit = options.deterministic ? FLEET_BLOCK : 1;
+    std::size_t units = (options.loops + unit - 1) / unit;
+    blockEnergy.assign(options.deterministic ? units : 0, 0.0);
+    shards = std::vector<Shard>(static_cast<std::size_t>(shardTotal));
+    for (int s = 0; s < shardTotal; ++s) {
+        Shard& shard = shards[s];
+        shard.first = std::min(options.loops, units * static_cast<std::size_t>(s) / static_cast<std::size_t>(shardTotal) * unit);
+        std::size_t end = std::min(options.loops, units * static_cast<std::size_t>(s + 1) / static_cast<std::size_t>(shardTotal) * unit);
+        shard.count = end - shard.first;
+        int n = s * nodesUsed / shardTotal;
+        int firstOfNode = (n * shardTotal + nodesUsed - 1) / nodesUsed;
+        shard.node = nodes[n].id;
+        shard.cpu = options.pin ? nodes[n].cpus[(s - firstOfNode) % nodes[n].cpus.size()] : -1;
+    }
+
+    // Each worker builds its own shard; wait until all are ready
+    quitting = false;
+    busy = shardTotal;
+    for (int s = 0; s < shardTotal; ++s) {
+        workers.emplace_back(&FleetRuntime::work, this, s);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+    }
+    for (const Shard& shard : shards) {
+        if (!shard.allocated) {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+void FleetRuntime::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    shards.clear();
+    blockEnergy.clear();
+    nodesUsed = 0;
+}
+
+void FleetRuntime::run(long cycles) {
+    if (workers.empty() || cycles <= 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    pendingCycles = cycles;
+    busy = static_cast<int>(workers.size());
+    ++generation;
+    wake.notify_all();
+    done.wait(lock, [this] { return busy == 0; });
+}
+
+// Worker: pin, allocate and first-touch the shard on this node, then step on request
+void FleetRuntime::work(int index) {
+    Shard& shard = shards[index];
+    if (shard.cpu >= 0 && !pinToCpu(shard.cpu)) {
+        shard.cpu = -1;
+    }
+    std::size_t bytes = shard.count * sizeof(FleetLoop);
+    void* memory = bytes ? allocateOnNode(bytes, shard.node) : nullptr;
+    if (memory) {
+        shard.loops = static_cast<FleetLoop*>(memory);
+        for (std::size_t i = 0; i < shard.count; ++i) {
+            new (&shard.loops[i]) FleetLoop(options, shard.first + i);
+        }
+    }
+    shard.allocated = memory != nullptr || bytes == 0;
+
+    std::uint64_t seen;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen = generation;
+        if (--busy == 0) done.notify_all();
+    }
+    for (;;) {
+        long cycles;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quitting || generation != seen; });
+            if (quitting) break;
+            seen = generation;
+            cycles = pendingCycles;
+        }
+        stepShard(shard, cycles);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) done.notify_all();
+    }
+
+    if (memory) {
+        for (std::size_t i = 0; i < shard.count; ++i) {
+            shard.loops[i].~FleetLoop();
+        }
+        freeOnNode(memory, bytes);
+    }
+}
+
+// Cycle by cycle over the whole shard, so every loop sees the same fleet time
+void FleetRuntime::stepShard(Shard& shard, long cycles) {
+    FleetSummary summary = shard.summary;
+    for (long c = 0; c < cycles; ++c) {
+        float seconds = static_cast<float>(shard.cycle + c) * options.dt;
+        for (std::size_t i = 0; i < shard.count; ++i) {
+            FleetLoop& loop = shard.loops[i];
+            summary.shutdowns += loop.step(seconds, options.dt);
+            summary.peakTemperature = std::max(summary.peakTemperature, loop.plant.temperature());
+        }
+    }
+    shard.cycle += cycles;
+    summary.loopCycles += static_cast<std::uint64_t>(cycles) * shard.count;
+
+    // Heat energy: per block for the fixed tree, or the shard's loops in order
+    const FleetLoop* loops = shard.loops;
+    if (options.deterministic) {
+        for (std::size_t first = 0; first < shard.count; first += FLEET_BLOCK) {
+            std::size_t count = std::min(FLEET_BLOCK, shard.count - first);
+            blockEnergy[(shard.first + first) / FLEET_BLOCK] =
+                pairwiseSum(count, [loops](std::size_t i) { return loops[i].energy; }, first);
+        }
+    } else {
+        double energy = 0.0;
+        for (std::size_t i = 0; i < shard.count; ++i) energy += loops[i].energy;
+        summary.heatEnergy = energy;
+    }
+    shard.summary = summary;
+}
+
+FleetSummary FleetRuntime::summary() const {
+    FleetSummary total{0, 0, 0.0f, 0.0};
+    for (const Shard& shard : shards) {
+        total.loopCycles += shard.summary.loopCycles;
+        total.shutdowns += shard.summary.shutdowns;
+        total.peakTemperature = std::max(total.peakTemperature, shard.summary.peakTemperature);
+        total.heatEnergy += shard.summary.heatEnergy;
+    }
+    if (options.deterministic) {
+        const std::vector<double>& blocks = blockEnergy;
+        total.heatEnergy = pairwiseSum(blocks.size(), [&blocks](std::size_t b) { return blocks[b]; });
+    }
+    return total;
+}
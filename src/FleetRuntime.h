@@ -0,0 +1,169 @@
+/*
+Fleet runtime: steps very large numbers of simulated cooling loops on all cores.
+
+The loops (controller with its PIDs, state machine and sensor history, plus the plant) are
+split into contiguous shards, one per worker thread. Shards are spread over the NUMA nodes
+in blocks and each worker is pinned to a core of its node. The worker allocates its shard
+on that node (libnuma when available) and constructs the loops itself, so every page is
+first touched by the thread that steps it, and a cycle never reads remote memory.
+
+run() advances every loop by a number of cycles and returns when all shards are done;
+shards only meet at the start and end of run(), never inside it.
+
+Every loop draws its own heat load variation from a private random stream seeded by the
+fleet seed and the loop index, and keeps its own compensated heat energy total, so a
+loop's trajectory does not depend on the shard it is in. Shutdown counts and the peak
+temperature are exact whatever the split. In deterministic mode the shards are also cut on
+FLEET_BLOCK boundaries and the heat energy is summed pairwise, first over the loops of
+each block and then over the blocks, so the tree and with it every aggregate is the same
+bit for bit for any number of shards. Otherwise each shard sums its loops in order and
+the result depends in its last bits on the split.
+
+Without libnuma the runtime treats the machine as one node; pinning needs Linux.
+*/
+
+#ifndef COOLINGLOOP_FLEET_RUNTIME_H
+#define COOLINGLOOP_FLEET_RUNTIME_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CoolingLoopController.h"
+#include "PlantModel.h"
+
+struct FleetOptions {
+    std::size_t loops = 1024;
+    int shards = 0;          // Worker threads, 0 for one per core of the nodes in use
+    int nodes = 0;           // NUMA nodes to use, 0 for all
+    bool pin = true;         // Pin each worker to a core of its node
+    float setpoint = 50.0f;  // °C
+    float threshold = 70.0f; // °C
+    float dt = 1.0f;         // Control period (s)
+    bool deterministic = false; // Same aggregates for any number of shards (see above)
+    float loadNoise = 0.0f;  // Per-cycle heat load variation of each loop (0.1 for ±10 %)
+    std::uint64_t seed = 1;  // Seed of the loops' random streams
+};
+
+// Loops per reduction block in deterministic mode
+const std::size_t FLEET_BLOCK = 1024;
+
+// Offset (s) of loop index into the drive profile
+float fleetProfileOffset(std::size_t index);
+
+// One simulated loop, driven through the drive profile with its own time offset so the
+// fleet is not in lockstep
+struct FleetLoop {
+    CoolingLoopController controller;
+    PlantModel plant;
+    float profileOffset; // s
+    float loadNoise;
+    std::uint64_t random;      // SplitMix64 stream state
+    double energy;             // Heat put into the coolant so far (J)
+    double energyCompensation; // Kahan compensation of energy
+
+    FleetLoop(const FleetOptions& options, std::size_t index);
+
+    // One control cycle at fleet time seconds; returns true when it entered a shutdown
+    bool step(float seconds, float dt) {
+        bool wasShutdown = controller.state() == SystemState::SAFETY_SHUTDOWN;
+        float heatLoad = driveProfileHeatLoad(seconds + profileOffset);
+        if (loadNoise > 0.0f) heatLoad *= 1.0f + loadNoise * nextUniform();
+        plant.setHeatLoad(heatLoad);
+        const ControlOutputs& out = controller.step({plant.sensorVoltage(), true, true});
+        plant.step(dt, out.pumpSpeed, out.fanSpeed);
+
+        double added = static_cast<double>(heatLoad) * dt - energyCompensation;
+        double total = energy + added;
+        energyCompensation = (total - energy) - added;
+        energy = total;
+        return !wasShutdown && out.state == SystemState::SAFETY_SHUTDOWN;
+    }
+
+    // Next number of the loop's stream, uniform in [-1, 1)
+    float nextUniform() {
+        std::uint64_t z = (random += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return static_cast<float>(z >> 40) * 0x1p-23f - 1.0f;
+    }
+};
+
+// Fleet-level aggregates
+struct FleetSummary {
+    std::uint64_t loopCycles;  // Loops x cycles stepped
+    std::uint64_t shutdowns;   // Entries into SAFETY_SHUTDOWN
+    float peakTemperature;     // Hottest coolant seen after any cycle (°C)
+    double heatEnergy;         // Heat put into the coolant by all loops (J)
+};
+
+// A NUMA node and the CPUs of it this process may run on
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+// Nodes with at least one usable CPU; a single node 0 without libnuma
+std::vector<NumaNode> numaNodes();
+
+class FleetRuntime {
+private:
+    struct alignas(64) Shard {
+        FleetLoop* loops = nullptr;
+        std::size_t first = 0; // Index of the first loop in the fleet
+        std::size_t count = 0;
+        int node = 0;          // NUMA node id
+        int cpu = -1;
+        long cycle = 0;        // Cycles stepped so far
+        FleetSummary summary{0, 0, 0.0f, 0.0};
+        bool allocated = false;
+    };
+
+    FleetOptions options;
+    std::vector<Shard> shards;
+    std::vector<double> blockEnergy; // Deterministic mode: heat energy of each FLEET_BLOCK loops
+    std::vector<std::thread> workers;
+    int nodesUsed;
+
+    // Work hand-off: run() bumps the generation and waits until no shard is busy
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t generation;
+    long pendingCycles;
+    int busy;
+    bool quitting;
+
+    void work(int shard);
+    void stepShard(Shard& shard, long cycles);
+
+public:
+    FleetRuntime();
+    ~FleetRuntime() { stop(); }
+
+    FleetRuntime(const FleetRuntime&) = delete;
+    FleetRuntime& operator=(const FleetRuntime&) = delete;
+
+    // Spawn the workers and build the shards; false (and nothing running) if a shard could
+    // not be allocated
+    bool start(const FleetOptions& fleetOptions);
+    void stop();
+
+    // Advance every loop by cycles control cycles
+    void run(long cycles);
+
+    int shardCount() const { return static_cast<int>(shards.size()); }
+    int nodeCount() const { return nodesUsed; }
+    int shardNode(int shard) const { return shards[shard].node; }
+    int shardCpu(int shard) const { return shards[shard].cpu; } // -1 if not pinned
+    std::size_t shardLoops(int shard) const { return shards[shard].count; }
+
+    // Aggregates over all shards since start()
+    FleetSummary summary() const;
+};
+
+#endif // COOLINGLOOP_FLEET_RUNTIME_H
@@ -0,0 +1,111 @@
+#include "FleetStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Deviation of the reference: sample standard deviation, floored relative to the mean
+inline float referenceDeviation(float n, float mean, float m2, float minRelativeDeviation) {
+    float variance = m2 / std::max(n - 1.0f, 1.0f);
+    return std::max(std::max(std::sqrt(variance), minRelativeDeviation * std::fabs(mean)), 1e-6f);
+}
+
+// One cycle for loops [0, count). Every statistic is computed for every loop and masked
+// with 0/1 factors instead of branches, and the arrays are declared non-overlapping, so the
+// loop compiles to vector code without run-time alias checks.
+void updateStatistics(const float* __restrict pumpDuty, const float* __restrict heatLoad,
+                      float* __restrict counts, float* __restrict means, float* __restrict m2s,
+                      float* __restrict ewmas, float* __restrict highs, float* __restrict lows,
+                      std::size_t count, const FleetStatisticsLimits& limits) {
+    const FleetStatisticsLimits local = limits;
+    for (std::size_t i = 0; i < count; ++i) {
+        float load = heatLoad[i];
+        float x = pumpDuty[i] * 1000.0f / std::max(load, local.minHeatLoad); // %/kW
+        float n = counts[i];
+        float oldMean = means[i];
+        float oldM2 = m2s[i];
+        float oldEwma = ewmas[i];
+        float valid = static_cast<float>(load >= local.minHeatLoad);
+
+        // Welford update while the reference is being learned
+        float learning = valid * static_cast<float>(n < local.baselineSamples);
+        float delta = x - oldMean;
+        float step = learning * delta / (n + 1.0f);
+        counts[i] = n + learning;
+        means[i] = oldMean + step;
+        m2s[i] = oldM2 + step * (n * delta); // delta * (x - new mean) = n * delta^2 / (n + 1)
+
+        // The first sample starts the EWMA
+        float first = static_cast<float>(n == 0.0f);
+        float weight = valid * (first + (1.0f - first) * local.ewmaWeight);
+        ewmas[i] = oldEwma + weight * (x - oldEwma);
+
+        // CUSUM against the finished reference
+        float ready = valid * static_cast<float>(n >= local.baselineSamples);
+        float z = delta / referenceDeviation(n, oldMean, oldM2, local.minRelativeDeviation);
+        highs[i] = std::max(highs[i] + ready * (z - local.cusumSlack), 0.0f);
+        lows[i] = std::max(lows[i] - ready * (z + local.cusumSlack), 0.0f);
+    }
+}
+
+// Min-heap on the score, so the weakest of the current top K sits at the front
+bool strongerAnomaly(const FleetAnomaly& a, const FleetAnomaly& b) {
+    return a.score > b.score || (a.score == b.score && a.loop < b.loop);
+}
+
+} // namespace
+
+FleetStatistics::FleetStatistics(std::size_t loops, const FleetStatisticsLimits& limits)
+    : limits(limits), loopCount(loops), count(loops, 0.0f), mean(loops, 0.0f), m2(loops, 0.0f), ewma(loops, 0.0f),
+      cusumHigh(loops, 0.0f), cusumLow(loops, 0.0f) {}
+
+void FleetStatistics::update(const float* pumpDuty, const float* heatLoad) {
+    updateStatistics(pumpDuty, heatLoad, count.data(), mean.data(), m2.data(), ewma.data(), cusumHigh.data(),
+                     cusumLow.data(), loopCount, limits);
+}
+
+void FleetStatistics::reset(std::size_t loop) {
+    count[loop] = 0.0f;
+    mean[loop] = 0.0f;
+    m2[loop] = 0.0f;
+    ewma[loop] = 0.0f;
+    cusumHigh[loop] = 0.0f;
+    cusumLow[loop] = 0.0f;
+}
+
+float FleetStatistics::deviation(std::size_t loop) const {
+    return referenceDeviation(count[loop], mean[loop], m2[loop], limits.minRelativeDeviation);
+}
+
+float FleetStatistics::score(std::size_t loop) const {
+    return std::max(cusumHigh[loop], cusumLow[loop]);
+}
+
+// Bounded heap of the k strongest so far: O(loops log k)
+std::size_t FleetStatistics::topAnomalies(FleetAnomaly* out, std::size_t k) const {
+    if (k == 0) {
+        return 0;
+    }
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < loopCount; ++i) {
+        float value = std::max(cusumHigh[i], cusumLow[i]);
+        if (value <= 0.0f) {
+            continue;
+        }
+        FleetAnomaly candidate{static_cast<std::uint32_t>(i), value, 0.0f, mean[i], ewma[i]};
+        if (size < k) {
+            out[size++] = candidate;
+            std::push_heap(out, out + size, strongerAnomaly);
+        } else if (strongerAnomaly(candidate, out[0])) {
+            std::pop_heap(out, out + size, strongerAnomaly);
+            out[size - 1] = candidate;
+            std::push_heap(out, out + size, strongerAnomaly);
+        }
+    }
+    std::sort_heap(out, out + size, strongerAnomaly);
+    for (std::size_t i = 0; i < size; ++i) {
+        out[i].drift = (out[i].current - out[i].baseline) / deviation(out[i].loop);
+    }
+    return size;
+}
@@ -0,0 +1,82 @@
+/*
+Streaming anomaly detection over fleet telemetry.
+
+For every loop of a fleet (simulated or replayed), each cycle feeds the pump duty and the
+heat load it had to carry. Their ratio, pump duty per kW, stays put on a healthy loop and
+drifts upwards as the loop loses cooling capacity. Three statistics run on it per loop:
+
+  * Welford mean and variance over the first baselineSamples valid samples, then frozen:
+    the loop's own reference, so vehicles with different plumbing are not compared
+    against each other.
+  * EWMA of the ratio, the current level; (EWMA - mean) / deviation is the drift in
+    standard deviations that the report shows.
+  * Two-sided CUSUM of the standardised samples against the reference. Its larger side
+    is the anomaly score, which picks up a persistent shift of half a standard deviation
+    within a few hundred samples while ignoring single outliers.
+
+The state is kept as structure of arrays (one float array per statistic), and update()
+steps every loop for one cycle in a single branch-free pass that the compiler turns into
+vector code. Samples below minHeatLoad carry no information and leave a loop unchanged.
+topAnomalies() selects the K highest scores with a bounded heap in the caller's buffer.
+*/
+
+#ifndef COOLINGLOOP_FLEET_STATISTICS_H
+#define COOLINGLOOP_FLEET_STATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FleetStatisticsLimits {
+    float minHeatLoad = 200.0f;           // Lighter loads carry too little information (W)
+    float baselineSamples = 600.0f;       // Valid samples in the reference (1 minute at 10 Hz)
+    float ewmaWeight = 0.01f;             // Weight of the newest sample in the EWMA
+    float cusumSlack = 0.5f;              // Allowed shift before CUSUM accumulates (standard deviations)
+    float alarmScore = 10.0f;             // CUSUM score that marks a loop anomalous
+    float minRelativeDeviation = 0.02f;   // Floor of the reference deviation, relative to its mean
+};
+
+// One line of the anomaly report
+struct FleetAnomaly {
+    std::uint32_t loop;
+    float score;    // CUSUM, larger side
+    float drift;    // (EWMA - mean) / deviation
+    float baseline; // Reference pump duty per kW (%/kW)
+    float current;  // EWMA of the pump duty per kW (%/kW)
+};
+
+class FleetStatistics {
+private:
+    FleetStatisticsLimits limits;
+    std::size_t loopCount;
+    // One array per statistic, indexed by loop
+    std::vector<float> count; // Valid samples in the reference (stops at baselineSamples)
+    std::vector<float> mean;
+    std::vector<float> m2;    // Sum of squared differences from the mean (Welford)
+    std::vector<float> ewma;
+    std::vector<float> cusumHigh;
+    std::vector<float> cusumLow;
+
+public:
+    explicit FleetStatistics(std::size_t loops, const FleetStatisticsLimits& limits = FleetStatisticsLimits());
+
+    // One cycle for every loop: pumpDuty[i] (%) and heatLoad[i] (W) belong to loop i
+    void update(const float* pumpDuty, const float* heatLoad);
+
+    // Forget one loop, e.g. after maintenance
+    void reset(std::size_t loop);
+
+    std::size_t loops() const { return loopCount; }
+    float samples(std::size_t loop) const { return count[loop]; }
+    float baseline(std::size_t loop) const { return mean[loop]; }
+    float current(std::size_t loop) const { return ewma[loop]; }
+    float deviation(std::size_t loop) const;
+    float score(std::size_t loop) const;
+    bool anomalous(std::size_t loop) const { return score(loop) >= limits.alarmScore; }
+
+    // The up to k loops with the highest non-zero scores, highest first (ties by loop
+    // index). Returns how many were written. Does not allocate.
+    std::size_t topAnomalies(FleetAnomaly* out, std::size_t k) const;
+};
+
+#endif // COOLINGLOOP_FLEET_STATISTICS_H
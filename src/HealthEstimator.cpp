@@ -0,0 +1,18 @@
+#include "HealthEstimator.h"
+
+// Update count independent loops
+void updateHealthBatch(HealthState* states, const HealthSample* samples, std::size_t count,
+                       const HealthLimits& limits) {
+    const HealthLimits local = limits;
+    for (std::size_t i = 0; i < count; ++i) {
+        updateHealth(states[i], samples[i], local);
+    }
+}
+
+const char* maintenanceFlagName(MaintenanceFlag flag) {
+    switch (flag) {
+        case PUMP_DEGRADED: return "pump degraded";
+        case FILTER_CLOGGED: return "filter clogged";
+    }
+    return "unknown";
+}
@@ -0,0 +1,143 @@
+/*
+Online estimation of pump and filter health.
+
+Two scalar recursive least-squares fits with exponential forgetting run on every sample:
+
+  * pump speed ratio: rpm feedback / maxPumpRpm against the command fraction. A healthy
+    brushless pump reaches the commanded speed (ratio 1); bearing or motor wear shows up
+    as a falling ratio.
+  * flow capacity: heat load against (rpm fraction x coolant temperature rise across the
+    inverter). The fit is the coolant's effective thermal conductance (flow x heat
+    capacity, W/K) at full pump speed. The flow through the filter and orifice falls with
+    the square root of their resistance, so (nominal / estimate)^2 is the loop resistance
+    relative to a clean filter.
+
+Because the flow fit is normalised by the measured rpm, a worn pump does not read as a
+clogged filter and the other way round. Maintenance flags are raised with hysteresis once
+enough informative samples (pump running, measurable temperature rise) went in, long
+before a clogging filter costs enough flow to trip the overtemperature shutdown.
+
+The forgetting factor and the sample minimum count samples of HEALTH_SAMPLE_PERIOD. An owner
+running a shorter control period feeds every healthSampleEvery()-th cycle, so the fits
+remember the same time and the flags wait as long whatever the period.
+
+Each update is a handful of multiply-adds (constant time and no allocation), and
+updateHealthBatch() runs many loops of a fleet side by side.
+*/
+
+#ifndef COOLINGLOOP_HEALTH_ESTIMATOR_H
+#define COOLINGLOOP_HEALTH_ESTIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Sample period the limits below are given for (s)
+const float HEALTH_SAMPLE_PERIOD = 1.0f;
+
+// Cycles of a control period per health sample (1 at HEALTH_SAMPLE_PERIOD and longer)
+inline std::uint32_t healthSampleEvery(float periodSeconds) {
+    return periodSeconds < HEALTH_SAMPLE_PERIOD ? static_cast<std::uint32_t>(HEALTH_SAMPLE_PERIOD / periodSeconds + 0.5f)
+                                                : 1;
+}
+
+// Nominal loop data and flag thresholds
+struct HealthLimits {
+    float forgetting = 0.99f;            // Per sample (time constant about 100 samples, 100 s)
+    float maxPumpRpm = 6000.0f;          // Pump speed at 100% command
+    float nominalFlowCapacity = 1800.0f; // Flow x heat capacity at full speed, clean filter (W/K)
+    float minPumpCommand = 10.0f;        // Samples below this command carry too little information (%)
+    float minTemperatureRise = 0.2f;     // ... and so do smaller rises across the inverter (K)
+    float pumpDegradedBelow = 0.85f;     // Speed ratio that raises PUMP_DEGRADED
+    float filterCloggedAbove = 1.5f;     // Resistance ratio that raises FILTER_CLOGGED
+    float hysteresis = 0.05f;            // Flags clear this far back inside the limit
+    std::uint32_t minSamples = 60;       // Informative samples before any flag is raised (60 s)
+};
+
+// Maintenance flags (bit mask)
+enum MaintenanceFlag : std::uint8_t {
+    PUMP_DEGRADED = 1,
+    FILTER_CLOGGED = 2
+};
+
+// One sample of the loop
+struct HealthSample {
+    float pumpCommand;       // %
+    float pumpRpm;           // Speed feedback
+    float inletTemperature;  // Coolant into the inverter (°C)
+    float outletTemperature; // Coolant out of the DC-DC (°C)
+    float heatLoad;          // Inverter and DC-DC losses as reported by the inverter (W)
+};
+
+// Scalar least squares y = theta * phi with exponential forgetting
+struct RecursiveLeastSquares {
+    float theta;
+    float covariance;
+
+    void update(float phi, float y, float forgetting) {
+        float gain = covariance * phi / (forgetting + phi * covariance * phi);
+        theta += gain * (y - phi * theta);
+        covariance = (covariance - gain * phi * covariance) / forgetting;
+    }
+};
+
+struct HealthState {
+    RecursiveLeastSquares pumpSpeedRatio;
+    RecursiveLeastSquares flowCapacity; // W/K at full pump speed
+    std::uint32_t pumpSamples;
+    std::uint32_t flowSamples;
+    std::uint8_t flags;
+
+    // Starts at the nominal values with a wide covariance, so the first samples dominate
+    explicit HealthState(const HealthLimits& limits)
+        : pumpSpeedRatio{1.0f, 100.0f}, flowCapacity{limits.nominalFlowCapacity, 1e6f}, pumpSamples(0),
+          flowSamples(0), flags(0) {}
+
+    // Loop flow resistance relative to a clean filter
+    float filterResistance(const HealthLimits& limits) const {
+        float ratio = limits.nominalFlowCapacity / flowCapacity.theta;
+        return ratio * ratio;
+    }
+};
+
+// Feed one sample and update the flags
+inline void updateHealth(HealthState& state, const HealthSample& sample, const HealthLimits& limits) {
+    if (sample.pumpCommand < limits.minPumpCommand) {
+        return; // Pump (nearly) off: neither fit is excited
+    }
+    float commandFraction = sample.pumpCommand / 100.0f;
+    float rpmFraction = sample.pumpRpm / limits.maxPumpRpm;
+    state.pumpSpeedRatio.update(commandFraction, rpmFraction, limits.forgetting);
+    ++state.pumpSamples;
+
+    float rise = sample.outletTemperature - sample.inletTemperature;
+    if (rise >= limits.minTemperatureRise && sample.heatLoad > 0.0f) {
+        state.flowCapacity.update(rpmFraction * rise, sample.heatLoad, limits.forgetting);
+        ++state.flowSamples;
+    }
+
+    // Raise at the limit, clear only once back inside it by the hysteresis
+    if (state.pumpSamples >= limits.minSamples) {
+        float ratio = state.pumpSpeedRatio.theta;
+        if (ratio < limits.pumpDegradedBelow) {
+            state.flags |= PUMP_DEGRADED;
+        } else if (ratio > limits.pumpDegradedBelow + limits.hysteresis) {
+            state.flags &= ~PUMP_DEGRADED;
+        }
+    }
+    if (state.flowSamples >= limits.minSamples) {
+        float resistance = state.filterResistance(limits);
+        if (resistance > limits.filterCloggedAbove) {
+            state.flags |= FILTER_CLOGGED;
+        } else if (resistance < limits.filterCloggedAbove - limits.hysteresis) {
+            state.flags &= ~FILTER_CLOGGED;
+        }
+    }
+}
+
+// Update count independent loops (fleet twin); samples[i] belongs to states[i]
+void updateHealthBatch(HealthState* states, const HealthSample* samples, std::size_t count,
+                       const HealthLimits& limits);
+
+const char* maintenanceFlagName(MaintenanceFlag flag);
+
+#endif // COOLINGLOOP_HEALTH_ESTIMATOR_H
@@ -0,0 +1,221 @@
+#include "IgnitionWake.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#endif
+
+#ifndef _WIN32
+
+bool IgnitionWake::open(const char* name, std::string& error) {
+    close();
+    level = false;
+    if (std::strcmp(name, "eventfd") == 0) {
+#if defined(__linux__)
+        fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        notifyFd = fd;
+#else
+        int ends[2];
+        if (::pipe(ends) == 0) {
+            ::fcntl(ends[0], F_SETFL, O_NONBLOCK);
+            ::fcntl(ends[1], F_SETFL, O_NONBLOCK);
+            fd = ends[0];
+            notifyFd = ends[1];
+        }
+#endif
+        if (fd < 0) {
+            error = "eventfd: cannot create";
+            return false;
+        }
+        source = Source::EVENT;
+        return true;
+    }
+#if defined(__linux__)
+    if (std::strncmp(name, "gpio:", 5) == 0) {
+        const char* path = name + 5;
+        // Interrupt on both edges; the edge file sits next to the value file. Ignored if the
+        // pin was configured beforehand and the file is not writable.
+        std::string edge(path);
+        std::size_t slash = edge.rfind('/');
+        edge = (slash == std::string::npos ? std::string() : edge.substr(0, slash + 1)) + "edge";
+        int edgeFd = ::open(edge.c_str(), O_WRONLY | O_CLOEXEC);
+        if (edgeFd >= 0) {
+            ssize_t written = ::write(edgeFd, "both", 4);
+            (void)written;
+            ::close(edgeFd);
+        }
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = std::string(path) + ": cannot open";
+            return false;
+        }
+        source = Source::GPIO;
+        if (!readLevel(error)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    if (std::strncmp(name, "can:", 4) == 0) {
+        const char* interface = name + 4;
+        fd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, CAN_RAW);
+        if (fd < 0) {
+            error = std::string(interface) + ": SocketCAN not available";
+            return false;
+        }
+        // Only the wake frame reaches the process; everything else is dropped in the kernel
+        can_filter filter{IGNITION_WAKE_ID | CAN_EFF_FLAG, CAN_EFF_FLAG | CAN_EFF_MASK};
+        sockaddr_can address{};
+        address.can_family = AF_CAN;
+        address.can_ifindex = static_cast<int>(::if_nametoindex(interface));
+        if (::setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter)) != 0 || address.can_ifindex == 0 ||
+            ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close();
+            error = std::string(interface) + ": cannot bind to the CAN interface";
+            return false;
+        }
+        source = Source::CAN; // Ignition off until the body controller says otherwise
+        return true;
+    }
+#endif
+    error = std::string(name) + ": unknown wake source (eventfd, gpio:PATH or can:IFNAME)";
+    return false;
+}
+
+void IgnitionWake::close() {
+    if (notifyFd >= 0 && notifyFd != fd) {
+        ::close(notifyFd);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    notifyFd = -1;
+    source = Source::NONE;
+}
+
+bool IgnitionWake::readLevel(std::string& error) {
+    switch (source) {
+        case Source::NONE:
+            error = "wake source not open";
+            return false;
+
+        case Source::EVENT: {
+            // The level is set by raise() and lower(); the counter only wakes poll()
+            unsigned char drain[64];
+            while (::read(fd, drain, sizeof(drain)) > 0) {
+            }
+            return true;
+        }
+
+        case Source::GPIO: {
+            // Reading the value also re-arms the edge interrupt
+            char value = '0';
+            if (::lseek(fd, 0, SEEK_SET) < 0 || ::read(fd, &value, 1) != 1) {
+                error = "GPIO value cannot be read";
+                return false;
+            }
+            level = value == '1';
+            return true;
+        }
+
+        case Source::CAN: {
+#if defined(__linux__)
+            can_frame frame;
+            while (::read(fd, &frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame))) {
+                if (frame.can_dlc >= 1) {
+                    level = frame.data[0] != 0;
+                }
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                error = std::string("CAN read failed: ") + std::strerror(errno);
+                return false;
+            }
+#endif
+            return true;
+        }
+    }
+    return true;
+}
+
+bool IgnitionWake::wait(std::string& error) {
+    for (;;) {
+        if (!readLevel(error)) {
+            return false;
+        }
+        if (level.load()) {
+            return true;
+        }
+        // A GPIO edge shows as an exceptional condition, the others as readable data
+        pollfd event{fd, static_cast<short>(source == Source::GPIO ? POLLPRI | POLLERR : POLLIN), 0};
+        if (::poll(&event, 1, -1) < 0) {
+            if (errno != EINTR) {
+                error = std::string("wait for the ignition failed: ") + std::strerror(errno);
+            }
+            return false;
+        }
+    }
+}
+
+bool IgnitionWake::ignition() {
+    std::string error;
+    readLevel(error);
+    return level.load();
+}
+
+void IgnitionWake::raise() {
+    level = true;
+    if (notifyFd >= 0) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(notifyFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void IgnitionWake::lower() {
+    level = false;
+}
+
+#else
+
+bool IgnitionWake::open(const char*, std::string& error) {
+    error = "Ignition wake sources need a POSIX system";
+    return false;
+}
+
+void IgnitionWake::close() {}
+
+bool IgnitionWake::readLevel(std::string&) {
+    return true;
+}
+
+bool IgnitionWake::wait(std::string& error) {
+    error = "Ignition wake sources need a POSIX system";
+    return false;
+}
+
+bool IgnitionWake::ignition() {
+    return level.load();
+}
+
+void IgnitionWake::raise() {
+    level = true;
+}
+
+void IgnitionWake::lower() {
+    level = false;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+Ignition wake source for the low-power OFF state.
+
+With the ignition off there is nothing to control, yet the loop used to run a cycle every
+period just to look at the ignition input, waking the CPU (and keeping the ECU out of its
+sleep states) on the 12 V battery for the whole time the vehicle is parked. IgnitionWake
+instead blocks in poll() without a timeout until the ignition comes on, so a parked
+controller is never scheduled at all. Sources:
+
+    eventfd        stand-in for the hardware: raise() and lower() set the ignition, from
+                   another thread or a signal handler (SIGUSR1 and SIGUSR2 in the application)
+    gpio:PATH      sysfs GPIO value file, e.g. /sys/class/gpio/gpio17/value; its edge file is
+                   set to "both" and the ignition is on while the value reads 1
+    can:IFNAME     SocketCAN interface; the kernel filters for the wake frame of the body
+                   controller (IGNITION_WAKE_ID, byte 0 non-zero for ignition on, 0 for off)
+
+ignition() reads the current level without blocking, so the same source drives the
+ignition input while the loop runs. POSIX only (eventfd, GPIO and CAN on Linux, a pipe for
+the stand-in elsewhere); open() returns false on other systems.
+*/
+
+#ifndef COOLINGLOOP_IGNITION_WAKE_H
+#define COOLINGLOOP_IGNITION_WAKE_H
+
+#include <atomic>
+#include <string>
+
+// Ignition state frame of the body controller: byte 0 is 1 with the ignition on, 0 with it off
+const unsigned int IGNITION_WAKE_ID = 0x18FF438F;
+
+class IgnitionWake {
+private:
+    enum class Source { NONE, EVENT, GPIO, CAN };
+
+    Source source;
+    int fd;                 // eventfd (or the read end of a pipe), GPIO value file or CAN socket
+    int notifyFd;           // Written by raise() and lower(): the eventfd or the write end of the pipe
+    std::atomic<bool> level; // Ignition as last seen or set
+
+    bool readLevel(std::string& error); // Consume what fd has to say, without blocking
+
+public:
+    IgnitionWake() : source(Source::NONE), fd(-1), notifyFd(-1), level(false) {}
+    ~IgnitionWake() { close(); }
+
+    IgnitionWake(const IgnitionWake&) = delete;
+    IgnitionWake& operator=(const IgnitionWake&) = delete;
+
+    // "eventfd", "gpio:PATH" or "can:IFNAME"; false with error set if the source cannot be used
+    bool open(const char* name, std::string& error);
+    void close();
+    bool isOpen() const { return source != Source::NONE; }
+
+    // Block until the ignition is on, with no timeout. Returns false if a signal interrupted
+    // the wait (check the stop flag and call again) or on an error (error set).
+    bool wait(std::string& error);
+
+    // Ignition now, without blocking
+    bool ignition();
+
+    // Stand-in source: ignition on and off. Async-signal-safe.
+    void raise();
+    void lower();
+};
+
+#endif // COOLINGLOOP_IGNITION_WAKE_H
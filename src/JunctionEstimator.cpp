@@ -0,0 +1,93 @@
+#include "JunctionEstimator.h"
+
+#include <cmath>
+
+// Exact update coefficients for one step size
+FosterStep fosterStep(const FosterNetwork& network, float dt) {
+    FosterStep step{network.nodes, {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}};
+    for (int n = 0; n < network.nodes; ++n) {
+        step.decay[n] = std::exp(-dt / network.tau[n]);
+        step.gain[n] = network.resistance[n] * (1.0f - step.decay[n]);
+    }
+    return step;
+}
+
+// Steady-state junction rise
+float steadyJunctionRise(const FosterNetwork& network, float power) {
+    float resistance = 0.0f;
+    for (int n = 0; n < network.nodes; ++n) {
+        resistance += network.resistance[n];
+    }
+    return power * resistance;
+}
+
+JunctionEstimator::JunctionEstimator(const FosterNetwork& thermalNetwork, float coolantTemperature)
+    : network(thermalNetwork), step(fosterStep(thermalNetwork, 0.0f)), stepDt(0.0f),
+      rise{0.0f, 0.0f, 0.0f, 0.0f}, junction(coolantTemperature) {}
+
+// Advance one device
+float JunctionEstimator::update(float power, float coolantTemperature, float dt) {
+    if (dt != stepDt) {
+        step = fosterStep(network, dt);
+        stepDt = dt;
+    }
+    float temperature = coolantTemperature;
+    for (int n = 0; n < step.nodes; ++n) {
+        rise[n] = rise[n] * step.decay[n] + step.gain[n] * power;
+        temperature += rise[n];
+    }
+    junction = temperature;
+    return junction;
+}
+
+JunctionEstimatorArray::JunctionEstimatorArray(const FosterNetwork& thermalNetwork, std::size_t devices,
+                                               float coolantTemperature)
+    : network(thermalNetwork), step(fosterStep(thermalNetwork, 0.0f)), stepDt(0.0f), count(devices),
+      junction(devices, coolantTemperature) {
+    for (int n = 0; n < network.nodes; ++n) {
+        rise[n].assign(devices, 0.0f);
+    }
+}
+
+// Advance every device, one pass per node. Same operations in the same order as
+// JunctionEstimator::update(), so the results are bit-identical.
+void JunctionEstimatorArray::update(const float* power, const float* coolantTemperature, float dt) {
+    if (dt != stepDt) {
+        step = fosterStep(network, dt);
+        stepDt = dt;
+    }
+    float* out = junction.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = coolantTemperature[i];
+    }
+    for (int n = 0; n < step.nodes; ++n) {
+        float* node = rise[n].data();
+        const float decay = step.decay[n];
+        const float gain = step.gain[n];
+        for (std::size_t i = 0; i < count; ++i) {
+            node[i] = node[i] * decay + gain * power[i];
+            out[i] += node[i];
+        }
+    }
+}
+
+// Both converters of a loop; the DC-DC sees the coolant warmed by the inverter loss
+float PowerStageJunctions::update(float inverterLoss, float dcdcLoss, float inletTemperature, float outletTemperature,
+                                  float dt) {
+    float total = inverterLoss + dcdcLoss;
+    float share = total > 0.0f ? inverterLoss / total : INVERTER_LOSS_SHARE;
+    float between = inletTemperature + share * (outletTemperature - inletTemperature);
+    float hottestInverter = inverter.update(inverterLoss / INVERTER_SWITCHES, inletTemperature, dt);
+    float hottestDcdc = dcdc.update(dcdcLoss / DCDC_SWITCHES, between, dt);
+    return hottestInverter > hottestDcdc ? hottestInverter : hottestDcdc;
+}
+
+// Setpoint raise from the junction headroom
+float JunctionHeadroom::update(float junctionTemperature, float coolantTemperature, float setpoint, float dt) {
+    float allowedCoolant = coolantTemperature + (limits.junctionLimit - limits.margin - junctionTemperature);
+    float target = allowedCoolant - setpoint;
+    if (target < 0.0f) target = 0.0f;
+    float rising = raise + limits.riseRate * dt;
+    raise = target < rising ? target : rising;
+    return raise;
+}
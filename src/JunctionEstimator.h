@@ -0,0 +1,143 @@
+/*
+Junction temperature estimator: the IGBT and MOSFET junction temperatures that actually
+limit the inverter and the DC-DC converter, estimated from their power loss and the coolant
+temperature at their cold plate.
+
+Each device type has a Foster thermal network from its datasheet, junction to coolant: N
+parallel RC terms in series, Zth(t) = sum R_i (1 - exp(-t / tau_i)). (A Cauer network from
+a physical model converts to this form.) The junction rise over the coolant is the sum of
+the terms, and each term is a first-order lag of the loss, so with the loss held over a
+step of dt the update is exact:
+
+    rise_i' = rise_i * exp(-dt / tau_i) + P * R_i * (1 - exp(-dt / tau_i))
+
+The exponentials are computed once per step size (FosterStep), leaving a multiply-add per
+term and device, for any dt; fast terms settle within one step instead of going unstable.
+
+JunctionEstimator steps one device. JunctionEstimatorArray steps many devices of one type
+(devices of many loops) with the terms stored node by node, so each term is one vectorised
+pass; both give bit-identical temperatures.
+
+JunctionHeadroom turns the estimate into the setpoint raise the controller accepts (see
+SensorInputs::setpointRaise): while the junctions are far below their limit, the coolant
+may run warmer and the pump and fan slow down.
+*/
+
+#ifndef COOLINGLOOP_JUNCTION_ESTIMATOR_H
+#define COOLINGLOOP_JUNCTION_ESTIMATOR_H
+
+#include <cstddef>
+#include <vector>
+
+const int MAX_FOSTER_NODES = 4;
+
+// Foster network, junction to coolant
+struct FosterNetwork {
+    int nodes;
+    float resistance[MAX_FOSTER_NODES]; // K/W
+    float tau[MAX_FOSTER_NODES];        // Time constant R C (s)
+};
+
+// Inverter IGBT, pin-fin baseplate module: Rth(j-f) 0.11 K/W
+const FosterNetwork INVERTER_IGBT_NETWORK = {4, {0.007f, 0.028f, 0.052f, 0.023f}, {0.001f, 0.015f, 0.08f, 0.9f}};
+
+// DC-DC SiC MOSFET on the cold plate: Rth(j-f) 0.5 K/W
+const FosterNetwork DCDC_MOSFET_NETWORK = {4, {0.05f, 0.12f, 0.2f, 0.13f}, {0.0005f, 0.01f, 0.2f, 3.0f}};
+
+// Exact update coefficients of a network for one step size
+struct FosterStep {
+    int nodes;
+    float decay[MAX_FOSTER_NODES]; // exp(-dt / tau)
+    float gain[MAX_FOSTER_NODES];  // R (1 - decay), K/W
+};
+
+FosterStep fosterStep(const FosterNetwork& network, float dt);
+
+// Steady-state junction rise over the coolant at a constant loss (K)
+float steadyJunctionRise(const FosterNetwork& network, float power);
+
+// One device
+class JunctionEstimator {
+private:
+    FosterNetwork network;
+    FosterStep step;
+    float stepDt; // Step size the coefficients are for
+    float rise[MAX_FOSTER_NODES];
+    float junction;
+
+public:
+    explicit JunctionEstimator(const FosterNetwork& network, float coolantTemperature = 25.0f);
+
+    // Advance dt seconds with the loss (W) and coolant temperature (°C) held; returns the
+    // junction temperature (°C) at the end
+    float update(float power, float coolantTemperature, float dt);
+    float temperature() const { return junction; }
+};
+
+// Many devices of one type
+class JunctionEstimatorArray {
+private:
+    FosterNetwork network;
+    FosterStep step;
+    float stepDt;
+    std::size_t count;
+    std::vector<float> rise[MAX_FOSTER_NODES]; // rise[node][device]
+    std::vector<float> junction;
+
+public:
+    JunctionEstimatorArray(const FosterNetwork& network, std::size_t devices, float coolantTemperature = 25.0f);
+
+    // JunctionEstimator::update() for every device: power and coolant hold one value per device
+    void update(const float* power, const float* coolantTemperature, float dt);
+
+    std::size_t size() const { return count; }
+    float temperature(std::size_t device) const { return junction[device]; }
+    const float* temperatures() const { return junction.data(); }
+};
+
+// Power stage of one loop: the inverter IGBTs take the coolant first, the DC-DC MOSFETs after
+// them; the switches of a converter share its loss equally
+const int INVERTER_SWITCHES = 6;
+const int DCDC_SWITCHES = 4;
+const float INVERTER_LOSS_SHARE = 0.8f; // Of the total loss, when only the total is known
+
+class PowerStageJunctions {
+private:
+    JunctionEstimator inverter;
+    JunctionEstimator dcdc;
+
+public:
+    explicit PowerStageJunctions(float coolantTemperature = 25.0f)
+        : inverter(INVERTER_IGBT_NETWORK, coolantTemperature), dcdc(DCDC_MOSFET_NETWORK, coolantTemperature) {}
+
+    // Advance dt seconds with the converter losses (W) and the coolant into and out of the
+    // power stage (°C); returns the hottest junction
+    float update(float inverterLoss, float dcdcLoss, float inletTemperature, float outletTemperature, float dt);
+    float inverterJunction() const { return inverter.temperature(); }
+    float dcdcJunction() const { return dcdc.temperature(); }
+};
+
+// How far the coolant may run above its setpoint for the junction estimate
+struct JunctionLimits {
+    float junctionLimit = 150.0f; // Highest junction temperature to operate at (°C)
+    float margin = 15.0f;         // Kept below the limit for estimation error and load steps (K)
+    float riseRate = 0.1f;        // Largest increase of the raise (K/s); decreases are immediate
+};
+
+class JunctionHeadroom {
+private:
+    JunctionLimits limits;
+    float raise;
+
+public:
+    explicit JunctionHeadroom(const JunctionLimits& junctionLimits = JunctionLimits{})
+        : limits(junctionLimits), raise(0.0f) {}
+
+    // Setpoint raise (K) from the hottest junction and the coolant temperature under it: the
+    // junction moves with the coolant, so the coolant may warm by the headroom left. dt is the
+    // time since the last update (s).
+    float update(float junctionTemperature, float coolantTemperature, float setpoint, float dt);
+    float value() const { return raise; }
+};
+
+#endif // COOLINGLOOP_JUNCTION_ESTIMATOR_H
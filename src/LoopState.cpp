@@ -0,0 +1,99 @@
+#include "LoopState.h"
+
+#include <cmath>
+
+#include "Calibration.h"
+#include "PIDController.h"
+
+LoopStateArray::LoopStateArray(std::size_t loops, const FleetOptions& options)
+    : setpoint(options.setpoint), threshold(options.threshold), dt(options.dt), plant(),
+      loopCount(loops), hot((loops + LOOP_LANES - 1) / LOOP_LANES), cold(hot.size()) {
+    const CalibrationImage& calibration = defaultCalibration();
+    for (int i = 0; i < 3; ++i) {
+        pumpGains[i] = calibration.pumpGains[i];
+        fanGains[i] = calibration.fanGains[i];
+    }
+    sensorLimits = SensorLimits{calibration.openVoltage, calibration.shortVoltage, calibration.maxStep};
+    table = sensorTable(calibration);
+
+    // Same initial state as a new FleetLoop
+    for (std::size_t b = 0; b < hot.size(); ++b) {
+        LoopHotBlock& h = hot[b];
+        LoopColdBlock& c = cold[b];
+        for (int l = 0; l < LOOP_LANES; ++l) {
+            h.previousVoltage[l] = 0.0f;
+            h.temperature[l] = 0.0f;
+            h.pumpPrevError[l] = 0.0f;
+            h.pumpIntegral[l] = 0.0f;
+            h.fanPrevError[l] = 0.0f;
+            h.fanIntegral[l] = 0.0f;
+            h.pumpSpeed[l] = 0.0f;
+            h.fanSpeed[l] = 0.0f;
+            h.coolant[l] = 25.0f;
+            h.profileOffset[l] = fleetProfileOffset(b * LOOP_LANES + static_cast<std::size_t>(l));
+            h.state[l] = static_cast<std::uint8_t>(SystemState::OFF);
+            c.sensorFaults[l] = 0;
+            c.shutdownTime[l] = 0.0f;
+            c.sensorStatus[l] = static_cast<std::uint8_t>(SensorStatus::VALID);
+            c.cause[l] = static_cast<std::uint8_t>(ShutdownCause::NONE);
+        }
+    }
+}
+
+// CoolingLoopController::step for one sensor channel with the ignition on and the level
+// good, followed by PlantModel::step, lane by lane through the blocks
+std::size_t LoopStateArray::step(float seconds) {
+    const float filterScale = std::sqrt(plant.filterResistance);
+    std::size_t entered = 0;
+    for (std::size_t b = 0; b < hot.size(); ++b) {
+        LoopHotBlock& h = hot[b];
+        std::size_t remaining = loopCount - b * LOOP_LANES;
+        int lanes = remaining < LOOP_LANES ? static_cast<int>(remaining) : LOOP_LANES;
+        for (int l = 0; l < lanes; ++l) {
+            float voltage = temperatureToVoltage(h.coolant[l]);
+            float heatLoad = driveProfileHeatLoad(seconds + h.profileOffset[l]);
+            float pumpSpeed = h.pumpSpeed[l];
+            float fanSpeed = h.fanSpeed[l];
+
+            SystemState state = static_cast<SystemState>(h.state[l]);
+            if (state != SystemState::SAFETY_SHUTDOWN) {
+                float previous = state == SystemState::OFF ? voltage : h.previousVoltage[l];
+                state = SystemState::ON;
+                std::uint8_t status = classifySensorSample(voltage, previous, sensorLimits);
+                h.previousVoltage[l] = voltage;
+                if (status) {
+                    // Implausible sample: keep the last temperature and cool fully
+                    LoopColdBlock& c = cold[b];
+                    ++c.sensorFaults[l];
+                    c.sensorStatus[l] = status;
+                    pumpSpeed = 100.0f;
+                    fanSpeed = 100.0f;
+                } else {
+                    float temperature = interpolateTemperature(voltage, table);
+                    h.temperature[l] = temperature;
+                    pumpSpeed = computePID(pumpGains[0], pumpGains[1], pumpGains[2], 0.0f, 100.0f, setpoint,
+                                           temperature, h.pumpPrevError[l], h.pumpIntegral[l]);
+                    fanSpeed = computePID(fanGains[0], fanGains[1], fanGains[2], 0.0f, 100.0f, setpoint,
+                                          temperature, h.fanPrevError[l], h.fanIntegral[l]);
+                    if (temperature > threshold) {
+                        LoopColdBlock& c = cold[b];
+                        state = SystemState::SAFETY_SHUTDOWN;
+                        c.cause[l] = static_cast<std::uint8_t>(ShutdownCause::OVERTEMPERATURE);
+                        c.shutdownTime[l] = seconds;
+                        pumpSpeed = 0.0f;
+                        fanSpeed = 0.0f;
+                        ++entered;
+                    }
+                }
+                h.state[l] = static_cast<std::uint8_t>(state);
+                h.pumpSpeed[l] = pumpSpeed;
+                h.fanSpeed[l] = fanSpeed;
+            }
+
+            float flowFraction = pumpSpeedFraction(plant, pumpSpeed) / filterScale;
+            h.coolant[l] = coolantTemperatureAfter(plant, h.coolant[l], heatLoad,
+                                                   radiatorConductance(plant, flowFraction, fanSpeed), dt);
+        }
+    }
+    return entered;
+}
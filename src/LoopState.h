@@ -0,0 +1,102 @@
+/*
+Cache-line aware structure-of-arrays state for many simulated loops.
+
+A simulated loop (FleetLoop) is a CoolingLoopController and a PlantModel side by side, about
+220 bytes, of which a cycle needs 44: most of the controller is configuration (gains,
+limits, the sensor table) that every loop of a fleet shares, plus diagnostics that change
+only when something goes wrong. LoopStateArray keeps one copy of the configuration and
+splits the per-loop state:
+
+  * hot blocks: 16 loops per block, one 64-byte line per field (previous sensor sample,
+    measured temperature, PID integrators and errors, pump and fan commands, coolant
+    temperature, drive profile offset) plus one line of state bytes. A cycle streams
+    through them in order, and every byte it loads is used.
+  * cold blocks: sensor fault counts, the last fault, shutdown cause and time. They are
+    written only when a sample is implausible or a loop shuts down.
+
+step() runs exactly the controller and plant arithmetic of FleetLoop (same PID and plant
+functions), so both layouts produce bit-identical loops for single-sensor fleets with the
+ignition on, the coolant level good and no heat load noise.
+*/
+
+#ifndef COOLINGLOOP_LOOP_STATE_H
+#define COOLINGLOOP_LOOP_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FleetRuntime.h"
+#include "SensorDiagnostics.h"
+#include "TemperatureSensor.h"
+
+const int LOOP_LANES = 16; // Loops per block: one cache line of floats
+
+// Fields read and written every cycle
+struct alignas(64) LoopHotBlock {
+    float previousVoltage[LOOP_LANES]; // Last raw sample, for the rate-of-change check (V)
+    float temperature[LOOP_LANES];     // Measured coolant temperature (°C)
+    float pumpPrevError[LOOP_LANES];
+    float pumpIntegral[LOOP_LANES];
+    float fanPrevError[LOOP_LANES];
+    float fanIntegral[LOOP_LANES];
+    float pumpSpeed[LOOP_LANES];       // %
+    float fanSpeed[LOOP_LANES];        // %
+    float coolant[LOOP_LANES];         // Plant coolant temperature (°C)
+    float profileOffset[LOOP_LANES];   // s into the drive profile
+    std::uint8_t state[LOOP_LANES];    // SystemState
+};
+
+// Diagnostics, written only on a fault or shutdown
+struct LoopColdBlock {
+    std::uint32_t sensorFaults[LOOP_LANES]; // Implausible samples so far
+    float shutdownTime[LOOP_LANES];         // Fleet time of the safety shutdown (s)
+    std::uint8_t sensorStatus[LOOP_LANES];  // Last implausible classification
+    std::uint8_t cause[LOOP_LANES];         // ShutdownCause
+};
+
+static_assert(sizeof(LoopHotBlock) == 11 * 64, "hot fields must fill whole cache lines");
+
+class LoopStateArray {
+private:
+    // Shared configuration, from the built-in calibration like CoolingLoopController's
+    float pumpGains[3];
+    float fanGains[3];
+    float setpoint;
+    float threshold;
+    float dt;
+    SensorLimits sensorLimits;
+    SensorTable table;
+    PlantParameters plant;
+
+    std::size_t loopCount;
+    std::vector<LoopHotBlock> hot;
+    std::vector<LoopColdBlock> cold;
+
+public:
+    LoopStateArray(std::size_t loops, const FleetOptions& options);
+
+    // One control cycle of every loop at fleet time seconds; returns the loops that entered
+    // a safety shutdown
+    std::size_t step(float seconds);
+
+    std::size_t loops() const { return loopCount; }
+    std::size_t bytes() const { return hot.size() * (sizeof(LoopHotBlock) + sizeof(LoopColdBlock)); }
+    SystemState state(std::size_t loop) const {
+        return static_cast<SystemState>(hot[loop / LOOP_LANES].state[loop % LOOP_LANES]);
+    }
+    float measuredTemperature(std::size_t loop) const { return hot[loop / LOOP_LANES].temperature[loop % LOOP_LANES]; }
+    float pumpSpeed(std::size_t loop) const { return hot[loop / LOOP_LANES].pumpSpeed[loop % LOOP_LANES]; }
+    float fanSpeed(std::size_t loop) const { return hot[loop / LOOP_LANES].fanSpeed[loop % LOOP_LANES]; }
+    float coolantTemperature(std::size_t loop) const { return hot[loop / LOOP_LANES].coolant[loop % LOOP_LANES]; }
+    std::uint32_t sensorFaults(std::size_t loop) const { return cold[loop / LOOP_LANES].sensorFaults[loop % LOOP_LANES]; }
+    SensorStatus sensorStatus(std::size_t loop) const {
+        return static_cast<SensorStatus>(cold[loop / LOOP_LANES].sensorStatus[loop % LOOP_LANES]);
+    }
+    ShutdownCause cause(std::size_t loop) const {
+        return static_cast<ShutdownCause>(cold[loop / LOOP_LANES].cause[loop % LOOP_LANES]);
+    }
+    float shutdownTime(std::size_t loop) const { return cold[loop / LOOP_LANES].shutdownTime[loop % LOOP_LANES]; }
+};
+
+#endif // COOLINGLOOP_LOOP_STATE_H
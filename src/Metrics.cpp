@@ -0,0 +1,238 @@
+#include "Metrics.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "HealthEstimator.h"
+
+namespace {
+
+std::atomic<int> nextShard(0);
+
+// Lower bound (ns) of a latency bucket; bucket i < 8 holds exactly i
+double bucketLowerBound(int bucket) {
+    if (bucket < 8) {
+        return static_cast<double>(bucket);
+    }
+    int exponent = bucket / 4 + 1;
+    return static_cast<double>(static_cast<std::uint64_t>(4 + bucket % 4) << (exponent - 2));
+}
+
+double bucketWidth(int bucket) {
+    return bucket < 8 ? 1.0 : static_cast<double>(std::uint64_t(1) << (bucket / 4 - 1));
+}
+
+// printf onto the end of the output; false once it no longer fits
+struct Writer {
+    char* out;
+    std::size_t capacity;
+    std::size_t length;
+
+    bool print(const char* format, ...) {
+        if (length >= capacity) {
+            return false;
+        }
+        va_list args;
+        va_start(args, format);
+        int written = std::vsnprintf(out + length, capacity - length, format, args);
+        va_end(args);
+        if (written < 0 || static_cast<std::size_t>(written) >= capacity - length) {
+            length = capacity;
+            return false;
+        }
+        length += static_cast<std::size_t>(written);
+        return true;
+    }
+
+    void header(const char* name, const char* type, const char* help) {
+        print("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+};
+
+} // namespace
+
+int metricShard() {
+    thread_local int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return shard;
+}
+
+std::uint64_t ShardedCounter::value() const {
+    std::uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Four buckets per power of two: the exponent and the two bits below the leading one
+int latencyBucket(std::uint64_t nanoseconds) {
+    if (nanoseconds < 8) {
+        return static_cast<int>(nanoseconds);
+    }
+#if defined(__GNUC__)
+    int exponent = 63 - __builtin_clzll(nanoseconds);
+#else
+    int exponent = 3;
+    while (nanoseconds >> (exponent + 1)) ++exponent;
+#endif
+    int bucket = 4 * (exponent - 1) + static_cast<int>((nanoseconds >> (exponent - 2)) & 3u);
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+LatencyHistogram::LatencyHistogram() {
+    for (Shard& shard : shards) {
+        for (std::atomic<std::uint64_t>& bucket : shard.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    std::uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        total += shard.count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double LatencyHistogram::sumSeconds() const {
+    std::uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        total += shard.sum.load(std::memory_order_relaxed);
+    }
+    return static_cast<double>(total) * 1e-9;
+}
+
+// Merge the shards and interpolate linearly inside the bucket holding the quantile
+double LatencyHistogram::percentile(double quantile) const {
+    std::uint64_t merged[LATENCY_BUCKETS] = {};
+    std::uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            std::uint64_t count = shard.buckets[i].load(std::memory_order_relaxed);
+            merged[i] += count;
+            total += count;
+        }
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    double rank = quantile * static_cast<double>(total);
+    double below = 0.0;
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+        double count = static_cast<double>(merged[i]);
+        if (count > 0.0 && below + count >= rank) {
+            double within = (rank - below) / count;
+            return (bucketLowerBound(i) + within * bucketWidth(i)) * 1e-9;
+        }
+        below += count;
+    }
+    return (bucketLowerBound(LATENCY_BUCKETS - 1) + bucketWidth(LATENCY_BUCKETS - 1)) * 1e-9;
+}
+
+const char* controlStageName(ControlStage stage) {
+    switch (stage) {
+        case ControlStage::SAMPLE: return "sample";
+        case ControlStage::CONTROL: return "control";
+        case ControlStage::OUTPUT: return "output";
+        case ControlStage::CYCLE: return "cycle";
+    }
+    return "unknown";
+}
+
+void ControllerMetrics::recordOutputs(const ControlOutputs& outputs) {
+    temperature.set(outputs.measuredTemperature);
+    pumpSpeed.set(outputs.pumpSpeed);
+    fanSpeed.set(outputs.fanSpeed);
+    allowedPower.set(outputs.allowedPower);
+    int previous = state.exchange(static_cast<int>(outputs.state), std::memory_order_relaxed);
+    if (outputs.state == SystemState::SAFETY_SHUTDOWN && previous != static_cast<int>(SystemState::SAFETY_SHUTDOWN)) {
+        if (outputs.cause == ShutdownCause::LOW_COOLANT) {
+            lowCoolantShutdowns.add();
+        } else if (outputs.cause == ShutdownCause::OVERTEMPERATURE) {
+            overtemperatureShutdowns.add();
+        }
+    }
+}
+
+// Prometheus text exposition format 0.0.4
+std::size_t formatMetrics(const ControllerMetrics& metrics, char* out, std::size_t capacity) {
+    Writer writer{out, capacity, 0};
+
+    writer.header("coolingloop_cycles_total", "counter", "Control cycles run.");
+    writer.print("coolingloop_cycles_total %llu\n", static_cast<unsigned long long>(metrics.cycles.value()));
+    writer.header("coolingloop_deadline_misses_total", "counter", "Control cycles that overran their period.");
+    writer.print("coolingloop_deadline_misses_total %llu\n",
+                 static_cast<unsigned long long>(metrics.deadlineMisses.value()));
+
+    writer.header("coolingloop_shutdowns_total", "counter", "Safety shutdowns by cause.");
+    writer.print("coolingloop_shutdowns_total{cause=\"low_coolant\"} %llu\n",
+                 static_cast<unsigned long long>(metrics.lowCoolantShutdowns.value()));
+    writer.print("coolingloop_shutdowns_total{cause=\"overtemperature\"} %llu\n",
+                 static_cast<unsigned long long>(metrics.overtemperatureShutdowns.value()));
+
+    writer.header("coolingloop_can_frames_total", "counter", "CAN frames by direction (rate() gives frames per second).");
+    writer.print("coolingloop_can_frames_total{direction=\"tx\"} %llu\n",
+                 static_cast<unsigned long long>(metrics.canFramesSent.value()));
+    writer.print("coolingloop_can_frames_total{direction=\"rx\"} %llu\n",
+                 static_cast<unsigned long long>(metrics.canFramesReceived.value()));
+
+    writer.header("coolingloop_stage_latency_seconds", "summary", "Latency of each control cycle stage.");
+    const double quantiles[3] = {0.5, 0.9, 0.99};
+    for (int s = 0; s < CONTROL_STAGE_COUNT; ++s) {
+        const LatencyHistogram& histogram = metrics.stageLatency[s];
+        const char* stage = controlStageName(static_cast<ControlStage>(s));
+        for (double quantile : quantiles) {
+            writer.print("coolingloop_stage_latency_seconds{stage=\"%s\",quantile=\"%g\"} %.9g\n", stage, quantile,
+                         histogram.percentile(quantile));
+        }
+        writer.print("coolingloop_stage_latency_seconds_sum{stage=\"%s\"} %.9g\n", stage, histogram.sumSeconds());
+        writer.print("coolingloop_stage_latency_seconds_count{stage=\"%s\"} %llu\n", stage,
+                     static_cast<unsigned long long>(histogram.count()));
+    }
+
+    writer.header("coolingloop_wake_latency_seconds", "summary",
+                  "Ignition wake to the first pump command, from the low-power OFF state.");
+    for (double quantile : quantiles) {
+        writer.print("coolingloop_wake_latency_seconds{quantile=\"%g\"} %.9g\n", quantile,
+                     metrics.wakeLatency.percentile(quantile));
+    }
+    writer.print("coolingloop_wake_latency_seconds_sum %.9g\n", metrics.wakeLatency.sumSeconds());
+    writer.print("coolingloop_wake_latency_seconds_count %llu\n",
+                 static_cast<unsigned long long>(metrics.wakeLatency.count()));
+
+    writer.header("coolingloop_temperature_celsius", "gauge", "Control temperature.");
+    writer.print("coolingloop_temperature_celsius %g\n", metrics.temperature.value());
+    writer.header("coolingloop_pump_speed_percent", "gauge", "Pump command.");
+    writer.print("coolingloop_pump_speed_percent %g\n", metrics.pumpSpeed.value());
+    writer.header("coolingloop_fan_speed_percent", "gauge", "Fan command.");
+    writer.print("coolingloop_fan_speed_percent %g\n", metrics.fanSpeed.value());
+    writer.header("coolingloop_allowed_power_percent", "gauge", "Inverter and DC-DC power limit (below 100 while derating).");
+    writer.print("coolingloop_allowed_power_percent %g\n", metrics.allowedPower.value());
+    writer.header("coolingloop_junction_temperature_celsius", "gauge", "Hottest estimated inverter or DC-DC junction.");
+    writer.print("coolingloop_junction_temperature_celsius %g\n", metrics.junctionTemperature.value());
+    writer.header("coolingloop_setpoint_raise_kelvin", "gauge", "Coolant setpoint raise from the junction headroom.");
+    writer.print("coolingloop_setpoint_raise_kelvin %g\n", metrics.setpointRaise.value());
+
+    writer.header("coolingloop_filter_resistance_ratio", "gauge", "Estimated loop flow resistance relative to a clean filter.");
+    writer.print("coolingloop_filter_resistance_ratio %g\n", metrics.filterResistance.value());
+    writer.header("coolingloop_pump_speed_ratio", "gauge", "Estimated reached over commanded pump speed.");
+    writer.print("coolingloop_pump_speed_ratio %g\n", metrics.pumpSpeedRatio.value());
+    int flags = metrics.maintenanceFlags.load(std::memory_order_relaxed);
+    writer.header("coolingloop_maintenance_flag", "gauge", "Maintenance flags raised by the health estimator.");
+    writer.print("coolingloop_maintenance_flag{flag=\"pump_degraded\"} %d\n", (flags & PUMP_DEGRADED) != 0);
+    writer.print("coolingloop_maintenance_flag{flag=\"filter_clogged\"} %d\n", (flags & FILTER_CLOGGED) != 0);
+
+    int state = metrics.state.load(std::memory_order_relaxed);
+    writer.header("coolingloop_state", "gauge", "State machine state (1 for the current one).");
+    writer.print("coolingloop_state{state=\"off\"} %d\n", state == static_cast<int>(SystemState::OFF));
+    writer.print("coolingloop_state{state=\"on\"} %d\n", state == static_cast<int>(SystemState::ON));
+    writer.print("coolingloop_state{state=\"afterrun\"} %d\n", state == static_cast<int>(SystemState::AFTERRUN));
+    if (!writer.print("coolingloop_state{state=\"safety_shutdown\"} %d\n",
+                      state == static_cast<int>(SystemState::SAFETY_SHUTDOWN))) {
+        return 0;
+    }
+    return writer.length;
+}
@@ -0,0 +1,124 @@
+/*
+Controller health metrics in the Prometheus text format.
+
+Every counter and latency histogram is split into cache-line sized shards; a thread always
+updates its own shard with a relaxed atomic add, so control threads never contend on a
+metric and never take a lock. Shards are only summed when the metrics are scraped
+(formatMetrics(), served by MetricsServer). Gauges hold the latest value as a relaxed
+atomic and are simply overwritten.
+
+Latencies go into log-linear buckets (four per power of two, so within 19 % of the real
+value) from which the scrape computes the 50th, 90th and 99th percentiles.
+*/
+
+#ifndef COOLINGLOOP_METRICS_H
+#define COOLINGLOOP_METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "CoolingLoopController.h"
+
+const int METRIC_SHARDS = 16;
+const int LATENCY_BUCKETS = 160; // 1 ns up to about half an hour
+
+// Shard of the calling thread, assigned round robin on first use
+int metricShard();
+
+// Monotonic counter, one shard per thread
+class ShardedCounter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+    Shard shards[METRIC_SHARDS];
+
+public:
+    void add(std::uint64_t count = 1) { shards[metricShard()].value.fetch_add(count, std::memory_order_relaxed); }
+    std::uint64_t value() const; // Sum over the shards (scrape time only)
+};
+
+// Latest value of a measurement
+class Gauge {
+private:
+    std::atomic<float> current;
+
+public:
+    explicit Gauge(float initial = 0.0f) : current(initial) {}
+
+    void set(float value) { current.store(value, std::memory_order_relaxed); }
+    float value() const { return current.load(std::memory_order_relaxed); }
+};
+
+// Bucket of a latency in nanoseconds
+int latencyBucket(std::uint64_t nanoseconds);
+
+// Latency distribution, one shard per thread
+class LatencyHistogram {
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> buckets[LATENCY_BUCKETS];
+        std::atomic<std::uint64_t> count;
+        std::atomic<std::uint64_t> sum; // ns
+    };
+    Shard shards[METRIC_SHARDS];
+
+public:
+    LatencyHistogram();
+
+    void record(std::uint64_t nanoseconds) {
+        Shard& shard = shards[metricShard()];
+        shard.buckets[latencyBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    // Merged over the shards (scrape time only). percentile() returns seconds, 0 if empty.
+    std::uint64_t count() const;
+    double sumSeconds() const;
+    double percentile(double quantile) const;
+};
+
+// Stages timed in every control cycle
+enum class ControlStage {
+    SAMPLE,  // Sensor inputs
+    CONTROL, // Controller step
+    OUTPUT,  // Pump, fan, CAN and checkpoint
+    CYCLE    // Whole cycle without the idle wait
+};
+
+const int CONTROL_STAGE_COUNT = 4;
+
+const char* controlStageName(ControlStage stage);
+
+// Everything the application exports
+struct ControllerMetrics {
+    ShardedCounter cycles;
+    ShardedCounter deadlineMisses; // Cycles that overran their period
+    ShardedCounter lowCoolantShutdowns;
+    ShardedCounter overtemperatureShutdowns;
+    ShardedCounter canFramesSent;
+    ShardedCounter canFramesReceived;
+    LatencyHistogram stageLatency[CONTROL_STAGE_COUNT];
+    LatencyHistogram wakeLatency; // Ignition wake to the first pump command (low-power OFF)
+    Gauge temperature; // °C
+    Gauge pumpSpeed;   // %
+    Gauge fanSpeed;    // %
+    Gauge allowedPower{100.0f}; // Inverter and DC-DC power limit while derating (%)
+    Gauge junctionTemperature;  // Hottest estimated power-stage junction (°C), 0 without an estimate
+    Gauge setpointRaise;        // Junction headroom granted to the coolant setpoint (K)
+    std::atomic<int> state{static_cast<int>(SystemState::OFF)};
+    Gauge filterResistance{1.0f}; // Relative to a clean filter (HealthEstimator)
+    Gauge pumpSpeedRatio{1.0f};   // Reached / commanded pump speed
+    std::atomic<int> maintenanceFlags{0};
+
+    // Gauges and shutdown counters from one cycle's outputs (shutdowns once per entry)
+    void recordOutputs(const ControlOutputs& outputs);
+};
+
+// Write the metrics in the Prometheus text exposition format (version 0.0.4). Returns the
+// length, or 0 if capacity is too small. Does not allocate.
+std::size_t formatMetrics(const ControllerMetrics& metrics, char* out, std::size_t capacity);
+
+#endif // COOLINGLOOP_METRICS_H
@@ -0,0 +1,187 @@
+#include "MetricsServer.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "CommandLine.h"
+#include "SocketPath.h"
+
+#ifndef _WIN32
+
+namespace {
+
+// Send everything, ignoring a peer that hung up early
+void sendAll(int connection, const char* data, std::size_t length) {
+    while (length > 0) {
+        ssize_t sent = ::send(connection, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return;
+        }
+        data += sent;
+        length -= static_cast<std::size_t>(sent);
+    }
+}
+
+} // namespace
+
+bool MetricsServer::start(const ControllerMetrics& source, const char* address) {
+    stop();
+    metrics = &source;
+    boundPort = 0;
+    unixPath[0] = '\0';
+
+    long port = 0;
+    if (parseCount(address, port)) {
+        if (port < 0 || port > 65535) {
+            return false;
+        }
+        listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listenSocket < 0) {
+            return false;
+        }
+        int reuse = 1;
+        ::setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Never reachable from outside the ECU
+        local.sin_port = htons(static_cast<std::uint16_t>(port));
+        socklen_t length = sizeof(local);
+        if (::bind(listenSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+            ::getsockname(listenSocket, reinterpret_cast<sockaddr*>(&local), &length) != 0) {
+            stop();
+            return false;
+        }
+        boundPort = ntohs(local.sin_port);
+    } else {
+        sockaddr_un local{};
+        if (std::strlen(address) >= sizeof(local.sun_path) || !clearSocketPath(address)) {
+            return false;
+        }
+        listenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenSocket < 0) {
+            return false;
+        }
+        local.sun_family = AF_UNIX;
+        std::strcpy(local.sun_path, address);
+        if (::bind(listenSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            stop();
+            return false;
+        }
+        std::strcpy(unixPath, address);
+    }
+
+    if (::listen(listenSocket, 8) != 0 || ::pipe(stopPipe) != 0) {
+        stop();
+        return false;
+    }
+    running = true;
+    thread = std::thread(&MetricsServer::run, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    running = false;
+    if (thread.joinable()) {
+        ssize_t written = ::write(stopPipe[1], "", 1);
+        (void)written;
+        thread.join();
+    }
+    for (int& end : stopPipe) {
+        if (end >= 0) {
+            ::close(end);
+            end = -1;
+        }
+    }
+    if (listenSocket >= 0) {
+        ::close(listenSocket);
+        listenSocket = -1;
+    }
+    if (unixPath[0]) {
+        ::unlink(unixPath);
+        unixPath[0] = '\0';
+    }
+}
+
+// Accept loop; sleeps until a connection or stop()
+void MetricsServer::run() {
+    while (running.load(std::memory_order_relaxed)) {
+        pollfd events[2] = {{listenSocket, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        if (::poll(events, 2, -1) <= 0 || !(events[0].revents & POLLIN)) {
+            continue;
+        }
+        int connection = ::accept(listenSocket, nullptr, nullptr);
+        if (connection >= 0) {
+            serve(connection);
+            ::close(connection);
+        }
+    }
+}
+
+// Read the request head (at most 2 s), then answer GET /metrics (or /) with the metrics
+void MetricsServer::serve(int connection) {
+    char request[2048];
+    std::size_t received = 0;
+    while (received < sizeof(request) - 1) {
+        pollfd readable{connection, POLLIN, 0};
+        if (::poll(&readable, 1, 2000) <= 0) {
+            return;
+        }
+        ssize_t count = ::recv(connection, request + received, sizeof(request) - 1 - received, 0);
+        if (count <= 0) {
+            return;
+        }
+        received += static_cast<std::size_t>(count);
+        request[received] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) {
+            break;
+        }
+    }
+    request[received] = '\0';
+
+    const char* status = "200 OK";
+    const char* contentType = "text/plain; version=0.0.4; charset=utf-8";
+    std::size_t bodyLength = 0;
+    if (std::strncmp(request, "GET /metrics ", 13) == 0 || std::strncmp(request, "GET / ", 6) == 0) {
+        bodyLength = formatMetrics(*metrics, response, sizeof(response));
+        if (bodyLength == 0) {
+            status = "500 Internal Server Error";
+        }
+    } else {
+        status = "404 Not Found";
+    }
+    if (bodyLength == 0) {
+        contentType = "text/plain";
+        bodyLength = static_cast<std::size_t>(
+            std::snprintf(response, sizeof(response), "%s\n", status));
+    }
+
+    char header[256];
+    int headerLength = std::snprintf(header, sizeof(header),
+                                     "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                                     status, contentType, bodyLength);
+    sendAll(connection, header, static_cast<std::size_t>(headerLength));
+    sendAll(connection, response, bodyLength);
+}
+
+#else
+
+bool MetricsServer::start(const ControllerMetrics&, const char*) {
+    return false;
+}
+
+void MetricsServer::stop() {}
+
+void MetricsServer::run() {}
+
+void MetricsServer::serve(int) {}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+Scrape endpoint for the controller metrics.
+
+Serves formatMetrics() over plain HTTP on a loopback TCP port or a Unix domain socket
+from its own thread, one request per connection:
+
+    curl http://127.0.0.1:9100/metrics
+    curl --unix-socket /run/coolingloop.sock http://localhost/metrics
+
+The server only reads the sharded metrics, so scrapes never block the control loop. Between
+scrapes its thread sleeps in poll() without a timeout (stop() wakes it through a pipe), so
+it adds no wakeups to a parked controller.
+POSIX only; start() returns false elsewhere.
+*/
+
+#ifndef COOLINGLOOP_METRICS_SERVER_H
+#define COOLINGLOOP_METRICS_SERVER_H
+
+#include <atomic>
+#include <thread>
+
+#include "Metrics.h"
+
+const std::size_t METRICS_RESPONSE_SIZE = 16384;
+
+class MetricsServer {
+private:
+    const ControllerMetrics* metrics;
+    int listenSocket;
+    int stopPipe[2]; // Written by stop() to end the accept loop
+    int boundPort;
+    char unixPath[108]; // Removed again by stop()
+    std::atomic<bool> running;
+    std::thread thread;
+    char response[METRICS_RESPONSE_SIZE];
+
+    void run();
+    void serve(int connection);
+
+public:
+    MetricsServer() : metrics(nullptr), listenSocket(-1), stopPipe{-1, -1}, boundPort(0), unixPath{}, running(false) {}
+    ~MetricsServer() { stop(); }
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Listen on 127.0.0.1:port if address is a number (0 picks a free port), otherwise on a
+    // Unix socket at that path, replacing a stale socket there but nothing else. Returns false
+    // if the socket cannot be set up.
+    bool start(const ControllerMetrics& source, const char* address);
+    void stop();
+
+    int port() const { return boundPort; } // TCP port actually bound (0 for a Unix socket)
+};
+
+#endif // COOLINGLOOP_METRICS_SERVER_H
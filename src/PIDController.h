@@ -0,0 +1,76 @@
+/*
+PID controller used for the pump and fan loops.
+*/
+
+#ifndef COOLINGLOOP_PID_CONTROLLER_H
+#define COOLINGLOOP_PID_CONTROLLER_H
+
+#include <limits>
+
+// Dynamic state of a PID loop (the gains and limits are configuration)
+struct PIDState {
+    float prevError;
+    float integral;
+};
+
+// One PID step on a loop's dynamic state. The output is clamped to [outputMin, outputMax],
+// and integration stops while saturated (anti-windup). Shared by PIDController and the
+// structure-of-arrays loop state (LoopState.h), so both compute bit-identical commands.
+inline float computePID(float Kp, float Ki, float Kd, float outputMin, float outputMax, float setpoint,
+                        float measuredValue, float& prevError, float& integral) {
+    float error = setpoint - measuredValue;
+    integral += error;
+    float derivative = error - prevError;
+    prevError = error;
+    float output = (Kp * error) + (Ki * integral) + (Kd * derivative);
+
+    // Undo this cycle's integration if it pushes further into saturation
+    if (output > outputMax) {
+        if (Ki * error > 0.0f) integral -= error;
+        output = outputMax;
+    } else if (output < outputMin) {
+        if (Ki * error < 0.0f) integral -= error;
+        output = outputMin;
+    }
+    return output;
+}
+
+// PID Controller class
+class PIDController {
+private:
+    float Kp, Ki, Kd;
+    float prevError, integral;
+    float outputMin, outputMax;
+
+public:
+    PIDController(float p, float i, float d)
+        : Kp(p), Ki(i), Kd(d), prevError(0.0), integral(0.0),
+          outputMin(std::numeric_limits<float>::lowest()), outputMax(std::numeric_limits<float>::max()) {}
+
+    // Clamp the output to [min, max] and stop integrating while saturated (anti-windup)
+    void setOutputLimits(float min, float max) {
+        outputMin = min;
+        outputMax = max;
+    }
+
+    // Run every ratio times the period the gains were tuned for. The integral sums one error
+    // and the derivative takes one difference per cycle, so Ki and Kd are rescaled to keep
+    // the response per second.
+    void scalePeriod(float ratio) {
+        Ki *= ratio;
+        Kd /= ratio;
+    }
+
+    float compute(float setpoint, float measuredValue) {
+        return computePID(Kp, Ki, Kd, outputMin, outputMax, setpoint, measuredValue, prevError, integral);
+    }
+
+    // Snapshot and restore for checkpointing
+    PIDState state() const { return PIDState{prevError, integral}; }
+    void restore(const PIDState& state) {
+        prevError = state.prevError;
+        integral = state.integral;
+    }
+};
+
+#endif // COOLINGLOOP_PID_CONTROLLER_H
@@ -0,0 +1,156 @@
+#include "PerformanceMap.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "CommandLine.h"
+
+namespace {
+
+// Points per pass of evaluateBatch, small enough for the scratch arrays to stay in L1
+const std::size_t BATCH_CHUNK = 256;
+
+const long MAX_AXIS_POINTS = 1024;
+
+bool parseAxis(std::istringstream& line, MapAxis& axis) {
+    std::string start, step, count, extra;
+    long points = 0;
+    if (!(line >> start >> step >> count) || (line >> extra) || !parseFloat(start.c_str(), axis.start) ||
+        !parseFloat(step.c_str(), axis.step) || !parseCount(count.c_str(), points) || points > MAX_AXIS_POINTS) {
+        return false;
+    }
+    axis.count = static_cast<int>(points);
+    return true;
+}
+
+} // namespace
+
+bool PerformanceMap::assign(const MapAxis& x, const MapAxis& y, const std::vector<float>& grid) {
+    if (x.count < 2 || y.count < 2 || !(x.step > 0.0f) || !(y.step > 0.0f) ||
+        grid.size() != static_cast<std::size_t>(x.count) * static_cast<std::size_t>(y.count)) {
+        return false;
+    }
+    x0 = x.start;
+    xScale = 1.0f / x.step;
+    xLast = static_cast<float>(x.count - 1);
+    y0 = y.start;
+    yScale = 1.0f / y.step;
+    yLast = static_cast<float>(y.count - 1);
+    nx = x.count;
+    ny = y.count;
+    values = grid;
+    return true;
+}
+
+// Same arithmetic as evaluate(), split into passes per chunk
+void PerformanceMap::evaluateBatch(const float* x, const float* y, float* out, std::size_t count) const {
+    int offset[BATCH_CHUNK];
+    float tx[BATCH_CHUNK];
+    float ty[BATCH_CHUNK];
+    float low[BATCH_CHUNK];
+    float high[BATCH_CHUNK];
+    bool finite[BATCH_CHUNK];
+    const float* table = values.data();
+    const int row = nx;
+
+    for (std::size_t first = 0; first < count; first += BATCH_CHUNK) {
+        std::size_t n = std::min(BATCH_CHUNK, count - first);
+        const float* __restrict xs = x + first;
+        const float* __restrict ys = y + first;
+
+        // Cell and weights. A NaN coordinate lands in the first cell (max with 0 first) so the
+        // gather stays in the table; its result is replaced by NaN in the last pass.
+        for (std::size_t i = 0; i < n; ++i) {
+            finite[i] = std::isfinite(xs[i]) && std::isfinite(ys[i]);
+            float fx = std::min(std::max(0.0f, (xs[i] - x0) * xScale), xLast);
+            float fy = std::min(std::max(0.0f, (ys[i] - y0) * yScale), yLast);
+            int ix = std::min(static_cast<int>(fx), nx - 2);
+            int iy = std::min(static_cast<int>(fy), ny - 2);
+            tx[i] = fx - static_cast<float>(ix);
+            ty[i] = fy - static_cast<float>(iy);
+            offset[i] = iy * row + ix;
+        }
+
+        // Corners, interpolated along x
+        for (std::size_t i = 0; i < n; ++i) {
+            const float* cell = table + offset[i];
+            low[i] = cell[0] + tx[i] * (cell[1] - cell[0]);
+            high[i] = cell[row] + tx[i] * (cell[row + 1] - cell[row]);
+        }
+
+        // Along y
+        float* __restrict result = out + first;
+        for (std::size_t i = 0; i < n; ++i) {
+            float value = low[i] + ty[i] * (high[i] - low[i]);
+            result[i] = finite[i] ? value : std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+}
+
+// Parse a radiator map file
+bool parseRadiatorMap(std::istream& in, RadiatorMap& map, std::string& error) {
+    RadiatorMap parsed;
+    MapAxis flow{0.0f, 0.0f, 0};
+    MapAxis air{0.0f, 0.0f, 0};
+    std::vector<float> grid;
+    std::string text;
+    int lineNumber = 0;
+    while (std::getline(in, text)) {
+        ++lineNumber;
+        std::string::size_type comment = text.find('#');
+        if (comment != std::string::npos) text.erase(comment);
+        std::istringstream line(text);
+        std::string keyword;
+        if (!(line >> keyword)) continue;
+
+        bool ok = true;
+        std::string token;
+        if (keyword == "flow_axis") {
+            ok = parseAxis(line, flow);
+        } else if (keyword == "air_axis") {
+            ok = parseAxis(line, air);
+        } else if (keyword == "row") {
+            int points = 0;
+            while (ok && line >> token) {
+                float value = 0.0f;
+                ok = parseFloat(token.c_str(), value) && value >= 0.0f;
+                if (ok) {
+                    grid.push_back(value);
+                    ++points;
+                }
+            }
+            ok = ok && points == flow.count;
+        } else if (keyword == "fan_air_velocity" || keyword == "ram_air_fraction") {
+            float& field = keyword == "fan_air_velocity" ? parsed.fanAirVelocity : parsed.ramAirFraction;
+            ok = (line >> token) && parseFloat(token.c_str(), field) && field >= 0.0f && !(line >> token);
+        } else {
+            error = "line " + std::to_string(lineNumber) + ": unknown keyword '" + keyword + "'";
+            return false;
+        }
+        if (!ok) {
+            error = "line " + std::to_string(lineNumber) + ": bad value for '" + keyword + "'";
+            return false;
+        }
+    }
+
+    if (!parsed.conductance.assign(flow, air, grid)) {
+        error = "flow_axis and air_axis need at least 2 points and a positive step, and there must be one "
+                "row of flow_axis values per air_axis point";
+        return false;
+    }
+    map = parsed;
+    return true;
+}
+
+bool loadRadiatorMap(const char* path, RadiatorMap& map, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = std::string(path) + ": cannot open";
+        return false;
+    }
+    if (!parseRadiatorMap(in, map, error)) {
+        error = std::string(path) + ": " + error;
+        return false;
+    }
+    return true;
+}
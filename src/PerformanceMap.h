@@ -0,0 +1,95 @@
+/*
+Radiator and fan performance map: heat rejected per kelvin between the coolant and the air
+(W/K) over coolant flow and air velocity at the radiator face, from the radiator and fan
+datasheets (config/radiator_map.txt).
+
+PerformanceMap is a value table on a regular grid, evaluated by bilinear interpolation and
+clamped to the grid edges. The grid spacing is stored as its reciprocal, so locating a
+point is a multiply and a truncation, not a search. evaluate() is inline for the plant
+model; evaluateBatch() runs many points in chunks: cell indices and weights in one
+branch-free pass, the four corners gathered in a second, the blend in a third, so the first
+and last passes vectorise even on targets without gather instructions.
+
+The air velocity combines the fan with the ram air of the moving vehicle (see
+radiatorAirVelocity()).
+*/
+
+#ifndef COOLINGLOOP_PERFORMANCE_MAP_H
+#define COOLINGLOOP_PERFORMANCE_MAP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Regular axis: count points start, start + step, ...
+struct MapAxis {
+    float start;
+    float step;
+    int count;
+};
+
+class PerformanceMap {
+private:
+    float x0, xScale, xLast; // First point, 1 / step, last cell index as float
+    float y0, yScale, yLast;
+    int nx, ny;
+    std::vector<float> values; // values[iy * nx + ix]
+
+public:
+    PerformanceMap() : x0(0.0f), xScale(0.0f), xLast(0.0f), y0(0.0f), yScale(0.0f), yLast(0.0f), nx(0), ny(0) {}
+
+    // Grid of x.count x y.count values, row by row (x varies fastest); false unless both axes
+    // have at least two points, a positive step and the values fill the grid
+    bool assign(const MapAxis& x, const MapAxis& y, const std::vector<float>& grid);
+
+    bool empty() const { return values.empty(); }
+    int xPoints() const { return nx; }
+    int yPoints() const { return ny; }
+
+    // Bilinear interpolation at (x, y), clamped to the grid; NaN if x or y is not finite
+    float evaluate(float x, float y) const {
+        if (!std::isfinite(x) || !std::isfinite(y)) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+        float fx = std::min(std::max((x - x0) * xScale, 0.0f), xLast);
+        float fy = std::min(std::max((y - y0) * yScale, 0.0f), yLast);
+        int ix = std::min(static_cast<int>(fx), nx - 2);
+        int iy = std::min(static_cast<int>(fy), ny - 2);
+        float tx = fx - static_cast<float>(ix);
+        float ty = fy - static_cast<float>(iy);
+        const float* cell = values.data() + iy * nx + ix;
+        float low = cell[0] + tx * (cell[1] - cell[0]);
+        float high = cell[nx] + tx * (cell[nx + 1] - cell[nx]);
+        return low + ty * (high - low);
+    }
+
+    // evaluate() for count points (NaN for non-finite inputs); out may not alias x or y
+    void evaluateBatch(const float* x, const float* y, float* out, std::size_t count) const;
+};
+
+// Radiator conductance map and the air flow model it is read against
+struct RadiatorMap {
+    PerformanceMap conductance;  // W/K over coolant flow (fraction of full flow) and air velocity (m/s)
+    float fanAirVelocity = 6.0f; // Air velocity at the radiator face with the fan at 100% at standstill (m/s)
+    float ramAirFraction = 0.3f; // Fraction of the vehicle speed reaching the radiator face
+};
+
+// Air velocity at the radiator face (m/s): root sum of squares of the fan and the ram air, so
+// the fan dominates at standstill and adds little at motorway speed
+inline float radiatorAirVelocity(const RadiatorMap& map, float fanSpeed, float vehicleSpeed) {
+    float fan = map.fanAirVelocity * fanSpeed / 100.0f;
+    float ram = map.ramAirFraction * vehicleSpeed / 3.6f;
+    return std::sqrt(fan * fan + ram * ram);
+}
+
+// Parse a radiator map file. Returns false and fills error (with the line number) on bad input.
+bool parseRadiatorMap(std::istream& in, RadiatorMap& map, std::string& error);
+
+// Read a radiator map file; false and error on failure
+bool loadRadiatorMap(const char* path, RadiatorMap& map, std::string& error);
+
+#endif // COOLINGLOOP_PERFORMANCE_MAP_H
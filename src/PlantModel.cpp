@@ -0,0 +1,47 @@
+#include "PlantModel.h"
+#include "PerformanceMap.h"
+#include "TemperatureSensor.h"
+
+#include <cmath>
+
+namespace {
+
+// Thermosiphon flow left with the pump stopped, as a fraction of the full flow capacity
+const float THERMOSIPHON_FLOW = 0.05f;
+
+} // namespace
+
+// Advance the model by dt seconds with the given pump and fan commands (0-100%)
+void PlantModel::step(float dt, float pumpSpeed, float fanSpeed) {
+    // Pump speed and flow through the filter and orifice (quadratic pressure drop, so flow
+    // falls with the square root of the resistance)
+    float speedFraction = pumpSpeedFraction(params, pumpSpeed);
+    float flowFraction = speedFraction / std::sqrt(params.filterResistance);
+    rpm = speedFraction * params.maxPumpRpm;
+    flowCapacity = flowFraction * params.flowCapacity;
+    float conductance = radiator ? radiator->conductance.evaluate(
+                                       flowFraction, radiatorAirVelocity(*radiator, fanSpeed, vehicleSpeed))
+                                 : radiatorConductance(params, flowFraction, fanSpeed);
+    coolantTemperature = coolantTemperatureAfter(params, coolantTemperature, params.heatLoad, conductance, dt);
+}
+
+// Temperature sensor voltage for the current coolant temperature
+float PlantModel::sensorVoltage() const {
+    return temperatureToVoltage(coolantTemperature);
+}
+
+// Coolant entering the inverter (the lumped temperature is the outlet)
+float PlantModel::inletTemperature() const {
+    float flow = flowCapacity;
+    if (flow < THERMOSIPHON_FLOW * params.flowCapacity) flow = THERMOSIPHON_FLOW * params.flowCapacity;
+    return coolantTemperature - params.heatLoad / flow;
+}
+
+// Heat load (W) of the stepped drive profile at a given time
+float driveProfileHeatLoad(float seconds) {
+    float phase = seconds - 1800.0f * static_cast<int>(seconds / 1800.0f);
+    if (phase < 300.0f) return 500.0f;
+    if (phase < 900.0f) return 1800.0f;
+    if (phase < 1200.0f) return 3500.0f;
+    return 1800.0f;
+}
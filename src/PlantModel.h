@@ -0,0 +1,92 @@
+/*
+Lumped thermal model of the cooling loop (pump, radiator with fan, inverter and DC-DC),
+stepped in virtual time so the controller can be exercised without hardware or sleeps.
+*/
+
+#ifndef COOLINGLOOP_PLANT_MODEL_H
+#define COOLINGLOOP_PLANT_MODEL_H
+
+// Physical parameters of the simulated loop
+struct PlantParameters {
+    float heatLoad = 2000.0f;            // Inverter and DC-DC losses (W)
+    float ambientTemperature = 25.0f;    // Air temperature at the radiator (°C)
+    float thermalMass = 20000.0f;        // Coolant and component heat capacity (J/K)
+    float radiatorConductance = 150.0f;  // Radiator UA at full pump and fan speed (W/K)
+
+    // Hydraulics: the brushless pump runs at command x maxPumpRpm x (1 - pumpWear), and the
+    // flow through the filter and orifice scales with rpm / sqrt(filterResistance)
+    float maxPumpRpm = 6000.0f;          // Pump speed at 100% command
+    float flowCapacity = 1800.0f;        // Coolant flow x heat capacity at full speed, clean filter (W/K)
+    float filterResistance = 1.0f;       // Loop flow resistance relative to a clean filter
+    float pumpWear = 0.0f;               // Fraction of the commanded speed the pump no longer reaches
+};
+
+// Pump speed as a fraction of maxPumpRpm for a command (0-100%)
+inline float pumpSpeedFraction(const PlantParameters& params, float pumpSpeed) {
+    return pumpSpeed / 100.0f * (1.0f - params.pumpWear);
+}
+
+// Radiator conductance (W/K) of the built-in model. flowFraction is the coolant flow
+// relative to a clean loop at full speed.
+inline float radiatorConductance(const PlantParameters& params, float flowFraction, float fanSpeed) {
+    // Coolant flow and air flow both scale the radiator conductance. A stopped pump still
+    // leaves some thermosiphon flow, a stopped fan still leaves natural convection.
+    if (flowFraction > 1.0f) flowFraction = 1.0f;
+    float flowFactor = 0.1f + 0.9f * flowFraction;
+    float airFactor = 0.25f + 0.75f * fanSpeed / 100.0f;
+    return params.radiatorConductance * flowFactor * airFactor;
+}
+
+// Coolant temperature after dt seconds of heat load against a radiator of the given
+// conductance. Shared by PlantModel and the structure-of-arrays loop state (LoopState.h).
+inline float coolantTemperatureAfter(const PlantParameters& params, float temperature, float heatLoad,
+                                     float conductance, float dt) {
+    float heatRejected = conductance * (temperature - params.ambientTemperature);
+    return temperature + (heatLoad - heatRejected) / params.thermalMass * dt;
+}
+
+struct RadiatorMap;
+
+class PlantModel {
+private:
+    PlantParameters params;
+    float coolantTemperature;
+    float rpm;          // Pump speed in the last step
+    float flowCapacity; // Coolant flow x heat capacity in the last step (W/K)
+    const RadiatorMap* radiator; // Datasheet map instead of the built-in conductance, if set
+    float vehicleSpeed;          // km/h, for the ram air through the radiator
+
+public:
+    PlantModel(const PlantParameters& parameters, float initialTemperature)
+        : params(parameters), coolantTemperature(initialTemperature), rpm(0.0f), flowCapacity(0.0f),
+          radiator(nullptr), vehicleSpeed(0.0f) {}
+
+    // Advance the model by dt seconds with the given pump and fan commands (0-100%)
+    void step(float dt, float pumpSpeed, float fanSpeed);
+
+    void setHeatLoad(float watts) { params.heatLoad = watts; }
+    void setAmbientTemperature(float celsius) { params.ambientTemperature = celsius; }
+    void setVehicleSpeed(float kmh) { vehicleSpeed = kmh; }
+
+    // Take the radiator conductance from a performance map (which must outlive the model)
+    // instead of the built-in model; nullptr goes back to the built-in one
+    void setRadiatorMap(const RadiatorMap* map) { radiator = map; }
+    void setFilterResistance(float ratio) { params.filterResistance = ratio; }
+    void setPumpWear(float fraction) { params.pumpWear = fraction; }
+    float heatLoad() const { return params.heatLoad; }
+    float temperature() const { return coolantTemperature; }
+
+    // Pump speed feedback (rpm) and the coolant entering the inverter, which is colder than
+    // the outlet by heat load / flow capacity
+    float pumpRpm() const { return rpm; }
+    float inletTemperature() const;
+
+    // Temperature sensor voltage for the current coolant temperature
+    float sensorVoltage() const;
+};
+
+// Heat load (W) of the stepped drive profile at a given time: idle, cruise, hill climb,
+// cruise, repeated every 30 minutes
+float driveProfileHeatLoad(float seconds);
+
+#endif // COOLINGLOOP_PLANT_MODEL_H
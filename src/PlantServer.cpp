@@ -0,0 +1,226 @@
+#include "PlantServer.h"
+#include "SocketPath.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+namespace {
+
+// Whole message or nothing; gives up when the peer hangs up or keepGoing() turns false
+// while waiting
+template <class KeepGoing>
+bool receiveAll(int connection, void* data, std::size_t length, KeepGoing keepGoing) {
+    char* bytes = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t count = ::recv(connection, bytes, length, 0);
+        if (count > 0) {
+            bytes += count;
+            length -= static_cast<std::size_t>(count);
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) && keepGoing()) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sendAll(int connection, const void* data, std::size_t length) {
+    const char* bytes = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t sent = ::send(connection, bytes, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) continue;
+            return false;
+        }
+        bytes += sent;
+        length -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+bool unixAddress(const char* path, sockaddr_un& address) {
+    address = sockaddr_un{};
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    return true;
+}
+
+} // namespace
+
+bool PlantServer::start(const char* path, PlantModel& model, DriveCycleProfile* drive) {
+    stop();
+    plant = &model;
+    profile = drive;
+    time = 0.0;
+    served = 0;
+
+    sockaddr_un local;
+    if (!unixAddress(path, local) || !clearSocketPath(path)) {
+        return false;
+    }
+    listenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return false;
+    }
+    if (::bind(listenSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        stop();
+        return false;
+    }
+    std::strcpy(unixPath, path);
+    if (::listen(listenSocket, 1) != 0) {
+        stop();
+        return false;
+    }
+    running = true;
+    thread = std::thread(&PlantServer::run, this);
+    return true;
+}
+
+void PlantServer::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (listenSocket >= 0) {
+        ::close(listenSocket);
+        listenSocket = -1;
+    }
+    if (unixPath[0]) {
+        ::unlink(unixPath);
+        unixPath[0] = '\0';
+    }
+}
+
+// Accept loop; wakes up regularly to notice stop()
+void PlantServer::run() {
+    while (running.load(std::memory_order_relaxed)) {
+        pollfd listening{listenSocket, POLLIN, 0};
+        if (::poll(&listening, 1, 200) <= 0) {
+            continue;
+        }
+        int connection = ::accept(listenSocket, nullptr, nullptr);
+        if (connection >= 0) {
+            serve(connection);
+            ::close(connection);
+        }
+    }
+}
+
+// Round trips until the controller hangs up. Blocking reads with a timeout, so a round
+// trip costs one recv and one send, and stop() is still noticed.
+void PlantServer::serve(int connection) {
+    timeval timeout{0, 200000};
+    ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    PlantCommand command;
+    while (receiveAll(connection, &command, sizeof(command),
+                      [this] { return running.load(std::memory_order_relaxed); })) {
+        PlantSample sample = advance(command);
+        if (!sendAll(connection, &sample, sizeof(sample))) {
+            return;
+        }
+        served.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PlantSample PlantServer::advance(const PlantCommand& command) {
+    if (command.dt > 0.0f) {
+        DriveCycleSample drive;
+        if (!profile) {
+            plant->setHeatLoad(driveProfileHeatLoad(static_cast<float>(time)));
+        } else if (profile->at(time, drive)) { // Past its end the drive cycle's last values hold
+            plant->setHeatLoad(drive.inverterLoss + drive.dcdcLoss);
+            plant->setAmbientTemperature(drive.ambient);
+            plant->setVehicleSpeed(drive.speed);
+        }
+        plant->step(command.dt, command.pumpSpeed, command.fanSpeed);
+        time += command.dt;
+    }
+
+    PlantSample sample{};
+    sample.sequence = command.sequence;
+    sample.sensorVoltage = plant->sensorVoltage();
+    sample.redundantVoltage = plant->sensorVoltage();
+    sample.pumpRpm = plant->pumpRpm();
+    sample.inletTemperature = plant->inletTemperature();
+    sample.outletTemperature = plant->temperature();
+    sample.heatLoad = plant->heatLoad();
+    sample.ignition = ignition.load(std::memory_order_relaxed);
+    sample.level = level.load(std::memory_order_relaxed);
+    return sample;
+}
+
+bool PlantLink::connect(const char* path) {
+    close();
+    sockaddr_un server;
+    if (!unixAddress(path, server)) {
+        return false;
+    }
+    connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0) {
+        return false;
+    }
+    if (::connect(connection, reinterpret_cast<sockaddr*>(&server), sizeof(server)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PlantLink::close() {
+    if (connection >= 0) {
+        ::close(connection);
+        connection = -1;
+    }
+}
+
+bool PlantLink::exchange(float dt, PlantSample& sample) {
+    PlantCommand command{++sequence, pump, fan, dt};
+    if (connection < 0 || !sendAll(connection, &command, sizeof(command)) ||
+        !receiveAll(connection, &sample, sizeof(sample), [] { return true; }) || sample.sequence != command.sequence) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+#else
+
+bool PlantServer::start(const char*, PlantModel&, DriveCycleProfile*) {
+    return false;
+}
+
+void PlantServer::stop() {}
+
+void PlantServer::run() {}
+
+void PlantServer::serve(int) {}
+
+PlantSample PlantServer::advance(const PlantCommand&) {
+    return PlantSample{};
+}
+
+bool PlantLink::connect(const char*) {
+    return false;
+}
+
+void PlantLink::close() {}
+
+bool PlantLink::exchange(float, PlantSample&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+Plant server: the simulated plant in its own process, standing in for the HIL rig.
+
+PlantServer owns a PlantModel and listens on a Unix domain socket; one controller at a time
+connects through PlantLink. A control cycle is one round trip of two fixed-size messages
+in host byte order (the socket never leaves the machine):
+
+    PlantCommand  controller -> plant  pump and fan commands, seconds to advance
+    PlantSample   plant -> controller  sensor voltages, switches, pump speed feedback,
+                                       coolant temperatures and heat load
+
+The server advances the plant by dt with the commands, then answers with the new readings;
+dt 0 only samples. The heat load follows a drive cycle file when one is given, otherwise
+the stepped drive profile. The ignition and level switches are set from the rig side with
+setIgnition() and setLevel().
+
+PlantLink is the actuator driver behind controlPump() and controlFan() in HIL mode: it
+latches their commands and sends them with the next exchange(). A round trip is two small
+socket writes and reads, a few microseconds on a local machine (BM_PlantRoundTrip), well
+inside a 1 kHz control period.
+
+POSIX only; start() and connect() return false elsewhere.
+*/
+
+#ifndef COOLINGLOOP_PLANT_SERVER_H
+#define COOLINGLOOP_PLANT_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "Actuators.h"
+#include "DriveCycle.h"
+#include "PlantModel.h"
+
+struct PlantCommand {
+    std::uint32_t sequence;
+    float pumpSpeed; // %
+    float fanSpeed;  // %
+    float dt;        // Seconds to advance the plant before sampling
+};
+
+struct PlantSample {
+    std::uint32_t sequence;  // Echo of the command
+    float sensorVoltage;     // Inverter-outlet temperature sensor (V)
+    float redundantVoltage;  // DC-DC-outlet temperature sensor (V)
+    float pumpRpm;           // Pump speed feedback
+    float inletTemperature;  // Coolant into the inverter (°C)
+    float outletTemperature; // Coolant out of the DC-DC (°C)
+    float heatLoad;          // Inverter and DC-DC losses (W)
+    std::uint8_t ignition;   // Ignition switch
+    std::uint8_t level;      // Coolant level switch (1 = sufficient)
+    std::uint8_t reserved[2];
+};
+
+static_assert(sizeof(PlantCommand) == 16 && sizeof(PlantSample) == 32, "plant protocol messages must not contain padding");
+
+class PlantServer {
+private:
+    PlantModel* plant;
+    DriveCycleProfile* profile;
+    double time; // Plant time (s)
+    int listenSocket;
+    char unixPath[108]; // Removed again by stop()
+    std::atomic<bool> running;
+    std::atomic<bool> ignition;
+    std::atomic<bool> level;
+    std::atomic<std::uint32_t> served; // Round trips so far
+    std::thread thread;
+
+    void run();
+    void serve(int connection);
+    PlantSample advance(const PlantCommand& command);
+
+public:
+    PlantServer()
+        : plant(nullptr), profile(nullptr), time(0.0), listenSocket(-1), unixPath{}, running(false), ignition(true),
+          level(true), served(0) {}
+    ~PlantServer() { stop(); }
+
+    PlantServer(const PlantServer&) = delete;
+    PlantServer& operator=(const PlantServer&) = delete;
+
+    // Serve plant (and take the heat load from profile, if not nullptr) on a Unix socket at
+    // path, replacing a stale socket there but nothing else. Both belong to the server thread
+    // until stop(). False if the socket cannot be set up.
+    bool start(const char* path, PlantModel& model, DriveCycleProfile* drive = nullptr);
+    void stop();
+
+    void setIgnition(bool on) { ignition = on; }
+    void setLevel(bool sufficient) { level = sufficient; }
+    std::uint32_t roundTrips() const { return served.load(); }
+};
+
+// Controller side of the plant server connection
+class PlantLink : public ActuatorDriver {
+private:
+    int connection;
+    std::uint32_t sequence;
+    float pump;
+    float fan;
+
+public:
+    PlantLink() : connection(-1), sequence(0), pump(0.0f), fan(0.0f) {}
+    ~PlantLink() override { close(); }
+
+    PlantLink(const PlantLink&) = delete;
+    PlantLink& operator=(const PlantLink&) = delete;
+
+    bool connect(const char* path);
+    void close();
+
+    void setPump(float speed) override { pump = speed; }
+    void setFan(float speed) override { fan = speed; }
+    float pumpCommand() const { return pump; }
+    float fanCommand() const { return fan; }
+
+    // Send the latched commands, let the plant advance dt seconds and read its new state.
+    // False if the server has gone away.
+    bool exchange(float dt, PlantSample& sample);
+};
+
+#endif // COOLINGLOOP_PLANT_SERVER_H
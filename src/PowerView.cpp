@@ -0,0 +1,227 @@
+#include "PowerView.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+
+const char* const POWER_VIEW_ENTER = "\033[?1049h\033[?25l\033[2J";
+const char* const POWER_VIEW_LEAVE = "\033[?25h\033[?1049l";
+
+namespace {
+
+// Gauge range of the coolant bar (°C)
+const float GAUGE_MIN = 0.0f;
+const float GAUGE_MAX = 120.0f;
+const int BAR_COLUMN = 18;
+const int BAR_WIDTH = 40;
+
+// Unchanged cells shorter than a cursor move are resent rather than skipped
+const int MAX_RUN_GAP = 8;
+
+const char* stateName(const ControlOutputs& outputs) {
+    switch (outputs.state) {
+        case SystemState::OFF: return "OFF";
+        case SystemState::ON: return "ON";
+        case SystemState::AFTERRUN: return "AFTERRUN";
+        case SystemState::SAFETY_SHUTDOWN:
+            return outputs.cause == ShutdownCause::LOW_COOLANT ? "SHUTDOWN: LOW COOLANT" : "SHUTDOWN: OVERTEMPERATURE";
+    }
+    return "?";
+}
+
+const char* faultName(int fault) {
+    switch (static_cast<PowerViewFault>(fault)) {
+        case PowerViewFault::LOW_COOLANT: return "Low coolant level";
+        case PowerViewFault::OVERTEMPERATURE: return "Overtemperature";
+        case PowerViewFault::SENSOR_OPEN: return "Sensor open circuit";
+        case PowerViewFault::SENSOR_SHORT: return "Sensor short circuit";
+        case PowerViewFault::SENSOR_RATE: return "Sensor rate of change";
+        case PowerViewFault::SENSOR_DISAGREEMENT: return "Sensors disagree";
+        case PowerViewFault::SENSOR_FALLBACK: return "No plausible sensor";
+    }
+    return "?";
+}
+
+bool faultActive(int fault, const ControlOutputs& outputs) {
+    switch (static_cast<PowerViewFault>(fault)) {
+        case PowerViewFault::LOW_COOLANT: return outputs.cause == ShutdownCause::LOW_COOLANT;
+        case PowerViewFault::OVERTEMPERATURE: return outputs.cause == ShutdownCause::OVERTEMPERATURE;
+        case PowerViewFault::SENSOR_OPEN: return outputs.sensorStatus == SensorStatus::OPEN_CIRCUIT;
+        case PowerViewFault::SENSOR_SHORT: return outputs.sensorStatus == SensorStatus::SHORT_CIRCUIT;
+        case PowerViewFault::SENSOR_RATE: return outputs.sensorStatus == SensorStatus::RATE_OF_CHANGE;
+        case PowerViewFault::SENSOR_DISAGREEMENT: return outputs.sensorDisagreement;
+        case PowerViewFault::SENSOR_FALLBACK: return outputs.state == SystemState::ON && outputs.activeSensors == 0;
+    }
+    return false;
+}
+
+// Bar column of a gauge value
+int gaugeColumn(float temperature) {
+    float fraction = (temperature - GAUGE_MIN) / (GAUGE_MAX - GAUGE_MIN);
+    if (fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+    return BAR_COLUMN + 1 + static_cast<int>(fraction * (BAR_WIDTH - 1) + 0.5f);
+}
+
+} // namespace
+
+PowerView::PowerView() : faultSeen{}, faultFirstCycle{}, faultLastCycle{} {
+    std::memset(frame, ' ', sizeof(frame));
+    invalidate();
+}
+
+void PowerView::invalidate() {
+    std::memset(screen, 0, sizeof(screen)); // Matches no printable cell
+}
+
+// printf into the frame, clipped at the right edge
+void PowerView::print(int row, int column, const char* format, ...) {
+    char text[POWER_VIEW_COLUMNS + 1];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length > POWER_VIEW_COLUMNS - column) length = POWER_VIEW_COLUMNS - column;
+    if (length > 0) {
+        std::memcpy(&frame[row][column], text, static_cast<std::size_t>(length));
+    }
+}
+
+// [#####.....] filled to fraction (0-1)
+void PowerView::bar(int row, int column, int width, float fraction) {
+    if (fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+    int filled = static_cast<int>(fraction * width + 0.5f);
+    frame[row][column] = '[';
+    for (int i = 0; i < width; ++i) {
+        frame[row][column + 1 + i] = i < filled ? '#' : '.';
+    }
+    frame[row][column + 1 + width] = ']';
+}
+
+// Lay out one snapshot in the frame
+void PowerView::compose(const PowerViewSnapshot& snapshot) {
+    const ControlOutputs& out = snapshot.outputs;
+    std::memset(frame, ' ', sizeof(frame));
+
+    print(0, 1, "COOLING LOOP  POWER VIEW");
+    print(0, 44, "cycle %10u", snapshot.cycle);
+    std::memset(&frame[1][1], '-', POWER_VIEW_COLUMNS - 2);
+    print(2, 1, "State   %s", stateName(out));
+    print(2, 44, "set %3.0f  limit %3.0f", snapshot.setpoint, snapshot.threshold);
+
+    // Coolant gauge with the setpoint (|) and shutdown threshold (!) marked
+    print(4, 1, "Coolant %6.1f C", out.measuredTemperature);
+    bar(4, BAR_COLUMN, BAR_WIDTH, (out.measuredTemperature - GAUGE_MIN) / (GAUGE_MAX - GAUGE_MIN));
+    frame[4][gaugeColumn(snapshot.setpoint)] = '|';
+    frame[4][gaugeColumn(snapshot.threshold)] = '!';
+    print(5, 1, "Pump    %6.1f %%", out.pumpSpeed);
+    bar(5, BAR_COLUMN, BAR_WIDTH, out.pumpSpeed / 100.0f);
+    print(6, 1, "Fan     %6.1f %%", out.fanSpeed);
+    bar(6, BAR_COLUMN, BAR_WIDTH, out.fanSpeed / 100.0f);
+
+    print(8, 1, "Sensors");
+    for (int ch = 0; ch < MAX_SENSOR_CHANNELS; ++ch) {
+        print(8, 9 + 14 * ch, "ch%d %s", ch + 1, (out.activeSensors >> ch) & 1u ? "in use" : "-");
+    }
+
+    // Latched fault list: every fault seen since start, in a fixed order
+    print(10, 1, "Faults");
+    int row = 11;
+    for (int fault = 0; fault < POWER_VIEW_FAULT_COUNT; ++fault) {
+        bool active = faultActive(fault, out);
+        if (active) {
+            if (!faultSeen[fault]) {
+                faultFirstCycle[fault] = snapshot.cycle;
+            }
+            faultSeen[fault] = true;
+            faultLastCycle[fault] = snapshot.cycle;
+        }
+        if (!faultSeen[fault]) {
+            continue;
+        }
+        if (active) {
+            print(row++, 3, "ACTIVE   %-24s since cycle %u", faultName(fault), faultFirstCycle[fault]);
+        } else {
+            print(row++, 3, "cleared  %-24s cycles %u-%u", faultName(fault), faultFirstCycle[fault],
+                  faultLastCycle[fault]);
+        }
+    }
+    if (row == 11) {
+        print(row, 3, "none");
+    }
+}
+
+// Cursor-addressed runs for every changed cell; nearby runs are merged
+std::size_t PowerView::diff(char* out, std::size_t capacity) {
+    std::size_t length = 0;
+    for (int row = 0; row < POWER_VIEW_ROWS; ++row) {
+        int column = 0;
+        while (column < POWER_VIEW_COLUMNS) {
+            if (frame[row][column] == screen[row][column]) {
+                ++column;
+                continue;
+            }
+            int last = column;
+            for (int next = column + 1; next < POWER_VIEW_COLUMNS && next - last <= MAX_RUN_GAP; ++next) {
+                if (frame[row][next] != screen[row][next]) {
+                    last = next;
+                }
+            }
+            int move = std::snprintf(out + length, capacity - length, "\033[%d;%dH", row + 1, column + 1);
+            std::size_t run = static_cast<std::size_t>(last - column + 1);
+            if (move < 0 || length + static_cast<std::size_t>(move) + run > capacity) {
+                invalidate(); // Buffer too small: redraw everything next time
+                return length;
+            }
+            length += static_cast<std::size_t>(move);
+            std::memcpy(out + length, &frame[row][column], run);
+            std::memcpy(&screen[row][column], &frame[row][column], run);
+            length += run;
+            column = last + 1;
+        }
+    }
+    return length;
+}
+
+void PowerViewDisplay::start(const Seqlock<PowerViewSnapshot>& source, std::FILE* out, int framesPerSecond) {
+    stop();
+    stream = out;
+    view.invalidate();
+    std::fputs(POWER_VIEW_ENTER, stream);
+    std::fflush(stream);
+    running = true;
+    thread = std::thread(&PowerViewDisplay::run, this, &source, framesPerSecond > 0 ? framesPerSecond : 30);
+}
+
+void PowerViewDisplay::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+    running = false;
+    thread.join();
+    std::fputs(POWER_VIEW_LEAVE, stream);
+    std::fflush(stream);
+}
+
+// Poll at the frame rate and redraw only when a new snapshot was published
+void PowerViewDisplay::run(const Seqlock<PowerViewSnapshot>* source, int framesPerSecond) {
+    const std::chrono::microseconds period(1000000 / framesPerSecond);
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    std::uint32_t shown = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        PowerViewSnapshot snapshot;
+        std::uint32_t version = 0;
+        if (source->version() != shown && source->tryLoad(snapshot, version)) {
+            shown = version;
+            view.compose(snapshot);
+            std::size_t length = view.diff(buffer, sizeof(buffer));
+            if (length) {
+                std::fwrite(buffer, 1, length, stream);
+                std::fflush(stream);
+            }
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+Power View: full-screen status display for the terminal.
+
+A fixed layout (coolant gauge with setpoint and threshold marks, pump and fan bars, state,
+sensor channels and a latched fault list) is composed into a character grid. Only the
+cells that differ from what the terminal already shows are sent, as cursor-addressed runs,
+so a steady reading costs nothing and a changing one a few dozen bytes.
+
+The control loop publishes a PowerViewSnapshot through a Seqlock after every cycle;
+PowerViewDisplay polls it from its own thread at up to 30 fps and redraws only when a new
+snapshot arrived, so the control loop never waits for the terminal. Composing and diffing
+use fixed buffers and do not allocate.
+*/
+
+#ifndef COOLINGLOOP_POWER_VIEW_H
+#define COOLINGLOOP_POWER_VIEW_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "CoolingLoopController.h"
+#include "Seqlock.h"
+
+// What the control loop publishes every cycle
+struct PowerViewSnapshot {
+    ControlOutputs outputs;
+    float setpoint;
+    float threshold;
+    std::uint32_t cycle;
+};
+
+const int POWER_VIEW_ROWS = 18;
+const int POWER_VIEW_COLUMNS = 64;
+
+// Worst case of one diff: every row as a single run behind a cursor move
+const std::size_t POWER_VIEW_BUFFER_SIZE = POWER_VIEW_ROWS * (POWER_VIEW_COLUMNS + 16);
+
+// Switch to the alternate screen with the cursor hidden, and back
+extern const char* const POWER_VIEW_ENTER;
+extern const char* const POWER_VIEW_LEAVE;
+
+// Faults in the fault list, in display order
+enum class PowerViewFault {
+    LOW_COOLANT,
+    OVERTEMPERATURE,
+    SENSOR_OPEN,
+    SENSOR_SHORT,
+    SENSOR_RATE,
+    SENSOR_DISAGREEMENT,
+    SENSOR_FALLBACK
+};
+
+const int POWER_VIEW_FAULT_COUNT = 7;
+
+// Screen model: composes snapshots and produces the terminal updates between them
+class PowerView {
+private:
+    char screen[POWER_VIEW_ROWS][POWER_VIEW_COLUMNS]; // What the terminal shows
+    char frame[POWER_VIEW_ROWS][POWER_VIEW_COLUMNS];  // Frame being composed
+    // Latched fault list: cycles each fault was first and last seen active
+    bool faultSeen[POWER_VIEW_FAULT_COUNT];
+    std::uint32_t faultFirstCycle[POWER_VIEW_FAULT_COUNT];
+    std::uint32_t faultLastCycle[POWER_VIEW_FAULT_COUNT];
+
+    void print(int row, int column, const char* format, ...);
+    void bar(int row, int column, int width, float fraction);
+
+public:
+    PowerView();
+
+    // Lay out one snapshot in the frame
+    void compose(const PowerViewSnapshot& snapshot);
+
+    // Write the escape sequences that turn the shown screen into the composed frame and
+    // return their length (0 if nothing changed). capacity must be POWER_VIEW_BUFFER_SIZE.
+    std::size_t diff(char* out, std::size_t capacity);
+
+    // Forget what the terminal shows, so the next diff redraws every cell
+    void invalidate();
+
+    // Composed frame text, POWER_VIEW_COLUMNS characters without a terminator
+    const char* line(int row) const { return frame[row]; }
+};
+
+// Display thread: polls a snapshot and redraws the Power View on a terminal stream
+class PowerViewDisplay {
+private:
+    PowerView view;
+    char buffer[POWER_VIEW_BUFFER_SIZE];
+    std::FILE* stream;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    void run(const Seqlock<PowerViewSnapshot>* source, int framesPerSecond);
+
+public:
+    PowerViewDisplay() : stream(nullptr), running(false) {}
+    ~PowerViewDisplay() { stop(); }
+
+    PowerViewDisplay(const PowerViewDisplay&) = delete;
+    PowerViewDisplay& operator=(const PowerViewDisplay&) = delete;
+
+    void start(const Seqlock<PowerViewSnapshot>& source, std::FILE* out, int framesPerSecond = 30);
+    void stop(); // Joins the thread and restores the terminal
+};
+
+#endif // COOLINGLOOP_POWER_VIEW_H
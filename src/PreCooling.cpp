@@ -0,0 +1,160 @@
+#include "PreCooling.h"
+
+#include <algorithm>
+
+#include "DriveCycle.h"
+
+namespace {
+
+// Gradient step of a new plan, and again after a call that found no descent
+const float INITIAL_STEP = 1e-3f;
+
+// Radiator conductance of the planning model and its derivative for the command u (0-1)
+float conductance(const PlantParameters& model, float u) {
+    return radiatorConductance(model, u, 100.0f * u);
+}
+
+float conductanceSlope(const PlantParameters& model, float u) {
+    return model.radiatorConductance * (0.9f * (0.25f + 0.75f * u) + 0.75f * (0.1f + 0.9f * u));
+}
+
+} // namespace
+
+LoadForecast::LoadForecast(int steps, float step, float watts)
+    : load(static_cast<std::size_t>(steps), watts), head(0), stepSeconds(step), elapsed(0.0f), passed(0) {}
+
+// From secondsAhead on the load is watts
+void LoadForecast::set(float secondsAhead, float watts) {
+    if (secondsAhead < 0.0f) secondsAhead = 0.0f;
+    std::size_t first = static_cast<std::size_t>(secondsAhead / stepSeconds);
+    for (std::size_t k = first; k < load.size(); ++k) {
+        load[(head + k) % load.size()] = watts;
+    }
+}
+
+// Move on in time
+void LoadForecast::advance(float seconds) {
+    elapsed += seconds;
+    while (elapsed >= stepSeconds) {
+        elapsed -= stepSeconds;
+        float last = at(steps() - 1);
+        load[head] = last;
+        head = (head + 1) % load.size();
+        ++passed;
+    }
+}
+
+// Extend the forecast from the drive cycle; past its end the last load holds
+void readForecast(DriveCycleProfile& ahead, LoadForecast& forecast, double now, double& until) {
+    const double end = now + forecast.steps() * static_cast<double>(forecast.step());
+    for (; until < end; until += forecast.step()) {
+        DriveCycleSample sample;
+        if (!ahead.at(until, sample)) {
+            until = end;
+            return;
+        }
+        forecast.set(static_cast<float>(until - now), sample.inverterLoss + sample.dcdcLoss);
+    }
+}
+
+// Forecast frames for the drive cycle, as the vehicle controller sends them
+void sendForecast(DriveCycleProfile& ahead, const LoadForecast& forecast, double now, double& until,
+                  std::vector<CANFrame>& frames) {
+    const double end = now + forecast.steps() * static_cast<double>(forecast.step());
+    for (; until < end; until += forecast.step()) {
+        DriveCycleSample sample;
+        if (!ahead.at(until, sample)) {
+            until = end;
+            return;
+        }
+        frames.push_back(encodeForecastFrame(static_cast<float>(until - now), sample.inverterLoss + sample.dcdcLoss));
+    }
+}
+
+// A forecast point from the bus
+void receiveForecast(LoadForecast& forecast, const CANFrame& frame) {
+    float secondsAhead = 0.0f;
+    float watts = 0.0f;
+    decodeForecastFrame(frame, secondsAhead, watts);
+    forecast.set(secondsAhead, watts);
+}
+
+PreCoolingPlanner::PreCoolingPlanner(const PlantParameters& plantModel, const PreCoolingOptions& plannerOptions)
+    : model(plantModel), options(plannerOptions), command(static_cast<std::size_t>(plannerOptions.horizon), 0.5f),
+      trial(command.size()), temperature(command.size() + 1), trialTemperature(command.size() + 1),
+      gradient(command.size()), stepLength(INITIAL_STEP), origin(0), planCost(0.0f) {}
+
+// Temperatures and cost of a schedule
+float PreCoolingPlanner::simulate(const std::vector<float>& u, float coolant, float setpoint,
+                                  const LoadForecast& forecast, std::vector<float>& trajectory) const {
+    const float rate = options.stepSeconds / model.thermalMass;
+    const int last = forecast.steps() - 1; // Held past the end of a shorter forecast
+    float cost = 0.0f;
+    trajectory[0] = coolant;
+    for (std::size_t k = 0; k < u.size(); ++k) {
+        int step = static_cast<int>(k);
+        float heatLoad = forecast.at(step < last ? step : last);
+        float rejected = conductance(model, u[k]) * (trajectory[k] - model.ambientTemperature);
+        float next = trajectory[k] + rate * (heatLoad - rejected);
+        trajectory[k + 1] = next;
+        float excess = next > setpoint ? next - setpoint : 0.0f;
+        cost += options.temperatureWeight * excess * excess + options.energyWeight * u[k] * u[k] * u[k];
+    }
+    return cost;
+}
+
+// Refine the plan: warm start, adjoint gradient, projected steps with backtracking
+float PreCoolingPlanner::plan(float coolantTemperature, float setpoint, const LoadForecast& forecast) {
+    // Steps that have passed since the last call leave the front of the schedule
+    std::uint64_t shift = forecast.stepsPassed() - origin;
+    origin = forecast.stepsPassed();
+    if (shift >= command.size()) {
+        std::fill(command.begin(), command.end(), command.back());
+    } else if (shift > 0) {
+        // The last command holds for the steps that enter the horizon
+        std::ptrdiff_t n = static_cast<std::ptrdiff_t>(shift);
+        std::rotate(command.begin(), command.begin() + n, command.end());
+        std::fill(command.end() - n, command.end(), *(command.end() - n - 1));
+    }
+
+    const float rate = options.stepSeconds / model.thermalMass;
+    planCost = simulate(command, coolantTemperature, setpoint, forecast, temperature);
+    for (int iteration = 0; iteration < options.iterations; ++iteration) {
+        // Backward pass: lambda is dJ/dT_k+1, carried back through the model
+        float lambda = 0.0f;
+        for (std::size_t k = command.size(); k-- > 0;) {
+            float excess = temperature[k + 1] > setpoint ? temperature[k + 1] - setpoint : 0.0f;
+            lambda += 2.0f * options.temperatureWeight * excess;
+            float u = command[k];
+            gradient[k] = 3.0f * options.energyWeight * u * u -
+                          lambda * rate * conductanceSlope(model, u) * (temperature[k] - model.ambientTemperature);
+            lambda *= 1.0f - rate * conductance(model, u);
+        }
+
+        // Projected step onto [0, 1], halved until the cost falls
+        bool improved = false;
+        for (int attempt = 0; attempt < 8 && !improved; ++attempt) {
+            for (std::size_t k = 0; k < command.size(); ++k) {
+                trial[k] = std::min(1.0f, std::max(0.0f, command[k] - stepLength * gradient[k]));
+            }
+            float cost = simulate(trial, coolantTemperature, setpoint, forecast, trialTemperature);
+            if (cost < planCost) {
+                command.swap(trial);
+                temperature.swap(trialTemperature);
+                planCost = cost;
+                stepLength *= 1.5f;
+                improved = true;
+            } else {
+                stepLength *= 0.5f;
+            }
+        }
+        if (!improved) {
+            // At an optimum (all commands at 0 in a quiet stretch, say) every attempt halves the
+            // step; start over rather than let it decay towards zero and stall the next plan
+            stepLength = INITIAL_STEP;
+            break;
+        }
+    }
+
+    return 100.0f * command[0];
+}
@@ -0,0 +1,120 @@
+/*
+Predictive pre-cooling: when the heat-load forecast shows a hill climb or a fast charge
+coming, pull the coolant down beforehand, so the peak stays lower than the PID loops alone
+can hold it once the load has arrived.
+
+LoadForecast holds the expected inverter and DC-DC losses over the next few minutes in
+fixed planning steps, filled from a drive-cycle file read ahead of the vehicle or from
+forecast frames on the CAN bus (encodeForecastFrame() in CANBus.h, receiveForecast()). Each value holds until
+a later one replaces it, so a sparse forecast of load changes is enough.
+
+PreCoolingPlanner chooses the pump and fan command u_k (0-1, both driven alike) for every
+planning step of the horizon on the lumped loop model of PlantModel.h,
+
+    T_k+1 = T_k + h / C (Q_k - UA(u_k) (T_k - T_ambient))
+
+minimising the squared excess over the setpoint plus the pump and fan energy, cubic in the
+command as for any fan or centrifugal pump:
+
+    J = sum_k temperatureWeight max(0, T_k - setpoint)^2 + energyWeight u_k^3
+
+Cooling ahead of time at part speed is cheaper than holding 100 % through the event, which
+is what makes pre-cooling pay. The gradient comes from one backward (adjoint) pass, and a
+few projected-gradient iterations with a backtracking step run per call. The schedule, and
+the step length, carry over to the next call shifted by the time passed, so each call only
+refines a nearly optimal plan: a few microseconds for a ten-minute horizon.
+
+The first command of the plan becomes the lowest pump and fan speed the controller may
+command (SensorInputs::coolingFloor); the PID loops still add cooling wherever the model is
+optimistic, and a model that is pessimistic leaves the coolant colder than planned, which
+the next plan, started from the measured temperature, takes back.
+*/
+
+#ifndef COOLINGLOOP_PRE_COOLING_H
+#define COOLINGLOOP_PRE_COOLING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CANBus.h"
+#include "PlantModel.h"
+
+class DriveCycleProfile;
+
+struct PreCoolingOptions {
+    int horizon = 120;               // Planning steps
+    float stepSeconds = 5.0f;        // Length of a planning step (s); ten minutes ahead by default
+    int iterations = 3;              // Gradient iterations per plan() call
+    float temperatureWeight = 1.0f;  // Cost of 1 K over the setpoint for one step (per K^2)
+    float energyWeight = 1.0f;       // Cost of one step at full pump and fan speed
+};
+
+// Expected heat load (W) per planning step from now on
+class LoadForecast {
+private:
+    std::vector<float> load; // Ring, load[(head + k) % size] is step k
+    std::size_t head;
+    float stepSeconds;
+    float elapsed;           // Time into the current step (s)
+    std::uint64_t passed;    // Steps passed since construction
+
+public:
+    LoadForecast(int steps, float stepSeconds, float watts = 0.0f);
+
+    // From secondsAhead on the load is watts, until a later value replaces it
+    void set(float secondsAhead, float watts);
+
+    // Move on in time; whole steps leave the forecast, the last value holds for the new ones
+    void advance(float seconds);
+
+    float at(int step) const { return load[(head + static_cast<std::size_t>(step)) % load.size()]; }
+    int steps() const { return static_cast<int>(load.size()); }
+    float step() const { return stepSeconds; }
+    std::uint64_t stepsPassed() const { return passed; }
+};
+
+// Extend the forecast to its full length from a drive cycle read ahead of the vehicle (the
+// profile must be a second reader of the file). now is the current time, until the time the
+// forecast has been filled to (s).
+void readForecast(DriveCycleProfile& ahead, LoadForecast& forecast, double now, double& until);
+
+// The same from the vehicle controller's side: one forecast frame (encodeForecastFrame() in
+// CANBus.h) per planning step not sent yet, appended to frames
+void sendForecast(DriveCycleProfile& ahead, const LoadForecast& forecast, double now, double& until,
+                  std::vector<CANFrame>& frames);
+
+// Apply a forecast frame received on the CAN bus; its time ahead counts from now
+void receiveForecast(LoadForecast& forecast, const CANFrame& frame);
+
+class PreCoolingPlanner {
+private:
+    PlantParameters model;
+    PreCoolingOptions options;
+    std::vector<float> command;     // u_k, 0-1
+    std::vector<float> trial;       // Line-search candidate
+    std::vector<float> temperature; // T_k of the plan, k = 0..horizon
+    std::vector<float> trialTemperature;
+    std::vector<float> gradient;
+    float stepLength;               // Gradient step carried over between calls
+    std::uint64_t origin;           // LoadForecast::stepsPassed() of the plan
+    float planCost;
+
+    float simulate(const std::vector<float>& u, float coolant, float setpoint, const LoadForecast& forecast,
+                   std::vector<float>& trajectory) const;
+
+public:
+    explicit PreCoolingPlanner(const PlantParameters& model = PlantParameters{},
+                               const PreCoolingOptions& options = PreCoolingOptions{});
+
+    // Refine the plan from the coolant temperature now (°C) over the forecast; returns the pump
+    // and fan floor for now (%)
+    float plan(float coolantTemperature, float setpoint, const LoadForecast& forecast);
+
+    void setAmbientTemperature(float celsius) { model.ambientTemperature = celsius; }
+    int horizon() const { return options.horizon; }
+    float plannedCommand(int step) const { return command[step]; }         // 0-1
+    float plannedTemperature(int step) const { return temperature[step]; } // °C, step 0 = now
+    float cost() const { return planCost; }
+};
+
+#endif // COOLINGLOOP_PRE_COOLING_H
@@ -0,0 +1,21 @@
+#include "SensorDiagnostics.h"
+
+const char* sensorStatusName(SensorStatus status) {
+    switch (status) {
+        case SensorStatus::VALID: return "valid";
+        case SensorStatus::OPEN_CIRCUIT: return "open circuit";
+        case SensorStatus::SHORT_CIRCUIT: return "short circuit";
+        case SensorStatus::RATE_OF_CHANGE: return "rate of change";
+    }
+    return "unknown";
+}
+
+// Classify count channels at once
+void classifySensorSamples(const float* voltage, const float* previous, std::uint8_t* status,
+                           std::size_t count, const SensorLimits& limits) {
+    // Copy the limits into locals so the compiler knows they do not alias the outputs
+    const SensorLimits local = limits;
+    for (std::size_t i = 0; i < count; ++i) {
+        status[i] = classifySensorSample(voltage[i], previous[i], local);
+    }
+}
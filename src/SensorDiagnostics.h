@@ -0,0 +1,52 @@
+/*
+Plausibility checks for the temperature sensor input.
+
+The H-WTMS table spans 4.771 V (-20°C) down to 0.749 V (100°C). A broken wire pulls the
+input up to the supply and a short pulls it to ground; both would otherwise read as a
+plausible extreme temperature. A jump larger than the coolant can physically change in
+one sample is treated as an implausible reading as well.
+*/
+
+#ifndef COOLINGLOOP_SENSOR_DIAGNOSTICS_H
+#define COOLINGLOOP_SENSOR_DIAGNOSTICS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Classification of one raw sample
+enum class SensorStatus : std::uint8_t {
+    VALID = 0,
+    OPEN_CIRCUIT = 1,
+    SHORT_CIRCUIT = 2,
+    RATE_OF_CHANGE = 3
+};
+
+const char* sensorStatusName(SensorStatus status);
+
+// Smallest rate-of-change limit per sample (V): four LSB of a 12-bit ADC on 5 V, so
+// quantisation noise never reads as a jump however short the control period
+const float SENSOR_NOISE_FLOOR = 4.0f * 5.0f / 4096.0f;
+
+struct SensorLimits {
+    float openVoltage = 4.9f;  // Above this the wire is considered open
+    float shortVoltage = 0.3f; // Below this the input is considered shorted
+    float maxStep = 0.5f;      // Largest plausible change between two samples (V)
+};
+
+// Classify one sample against the previous one. Branch-free so the batch version below
+// compiles to vector compares and blends.
+inline std::uint8_t classifySensorSample(float voltage, float previous, const SensorLimits& limits) {
+    float step = voltage - previous;
+    std::uint8_t open = voltage > limits.openVoltage;
+    std::uint8_t shorted = voltage < limits.shortVoltage;
+    std::uint8_t jump = (step > limits.maxStep) | (step < -limits.maxStep);
+    // Open and short take precedence over the rate check
+    std::uint8_t electrical = open | shorted;
+    return static_cast<std::uint8_t>(open * 1 + shorted * 2 + (electrical ^ 1) * jump * 3);
+}
+
+// Classify count channels at once: status[i] from voltage[i] and previous[i]
+void classifySensorSamples(const float* voltage, const float* previous, std::uint8_t* status,
+                           std::size_t count, const SensorLimits& limits);
+
+#endif // COOLINGLOOP_SENSOR_DIAGNOSTICS_H
@@ -0,0 +1,27 @@
+#include "SensorVoting.h"
+
+// Vote count loops at once
+void voteSensorChannelsBatch(const float* const temperature[MAX_SENSOR_CHANNELS],
+                             const std::uint8_t* const status[MAX_SENSOR_CHANNELS], int channels,
+                             float* __restrict control, float* __restrict median,
+                             std::uint8_t* __restrict disagreement,
+                             std::size_t count, const VotingLimits& limits) {
+    // Missing channels read channel 0 and are masked out, so the loop body stays branch-free
+    const float* t0 = temperature[0];
+    const float* t1 = channels > 1 ? temperature[1] : t0;
+    const float* t2 = channels > 2 ? temperature[2] : t0;
+    const std::uint8_t* s0 = status[0];
+    const std::uint8_t* s1 = channels > 1 ? status[1] : s0;
+    const std::uint8_t* s2 = channels > 2 ? status[2] : s0;
+    const bool present1 = channels > 1;
+    const bool present2 = channels > 2;
+    const VotingLimits local = limits;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        SensorVote vote = voteSensorChannels(t0[i], t1[i], t2[i], s0[i] == 0, present1 & (s1[i] == 0),
+                                             present2 & (s2[i] == 0), local);
+        control[i] = vote.temperature;
+        median[i] = vote.median;
+        disagreement[i] = vote.disagreement;
+    }
+}
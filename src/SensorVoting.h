@@ -0,0 +1,83 @@
+/*
+Voting over redundant coolant temperature sensors.
+
+The loop can carry up to three sensors: inverter outlet, DC-DC outlet and an optional third.
+The hottest plausible channel drives the PIDs (max-select), so whichever component runs
+hotter sets the cooling demand. The median of the plausible channels is the reference for
+disagreement detection: with three channels a single reading that is more than maxSpread
+away from the other two is voted out, so one sensor failing hot cannot trip the
+overtemperature shutdown on its own. With two channels there is no majority; a spread
+above maxSpread is only flagged and the hotter reading still drives cooling.
+
+All decisions are selects and min/max, without branches, so the batch version over many
+loops compiles to vector code.
+*/
+
+#ifndef COOLINGLOOP_SENSOR_VOTING_H
+#define COOLINGLOOP_SENSOR_VOTING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+const int MAX_SENSOR_CHANNELS = 3;
+
+struct VotingLimits {
+    float maxSpread = 15.0f; // Largest plausible difference between two channels (°C)
+};
+
+// Result of voting one sample of every channel
+struct SensorVote {
+    float temperature;         // Max-selected control temperature (°C)
+    float median;              // Median of the plausible channels (°C)
+    std::uint8_t usedMask;     // Bit i set when channel i took part in the max-select
+    std::uint8_t disagreement; // 1 when plausible channels differ by more than maxSpread
+};
+
+// Vote one sample of channels a, b and c. A temperature is ignored where its valid flag is
+// false; usedMask is 0 when no channel is plausible (temperature is then meaningless).
+// Every value is computed unconditionally and only selected between, so the compiler can
+// if-convert and vectorise the batch loop without speculating arithmetic.
+inline SensorVote voteSensorChannels(float a, float b, float c, bool va, bool vb, bool vc,
+                                     const VotingLimits& limits) {
+    const float COLD = -1.0e30f;
+    const float HOT = 1.0e30f;
+    float spread = limits.maxSpread;
+
+    // Hottest and coldest plausible reading
+    float hottest = std::max(std::max(va ? a : COLD, vb ? b : COLD), vc ? c : COLD);
+    float coldest = std::min(std::min(va ? a : HOT, vb ? b : HOT), vc ? c : HOT);
+    float midpoint = 0.5f * (hottest + coldest);
+
+    // Median of three, or the midpoint when fewer channels are plausible
+    bool full = va & vb & vc;
+    float median3 = std::max(std::min(a, b), std::min(std::max(a, b), c));
+    float median = full ? median3 : midpoint;
+
+    // With a full set, vote out a single channel that is too far from the median
+    int oa = full & (std::fabs(a - median) > spread);
+    int ob = full & (std::fabs(b - median) > spread);
+    int oc = full & (std::fabs(c - median) > spread);
+    int single = oa + ob + oc == 1;
+    bool ua = va & !(oa & single);
+    bool ub = vb & !(ob & single);
+    bool uc = vc & !(oc & single);
+
+    SensorVote vote;
+    vote.temperature = std::max(std::max(ua ? a : COLD, ub ? b : COLD), uc ? c : COLD);
+    vote.median = median;
+    vote.usedMask = static_cast<std::uint8_t>(ua | (ub << 1) | (uc << 2));
+    // Same as hottest - coldest > spread, written against the midpoint so it is always used
+    vote.disagreement = (va + vb + vc >= 2) & (hottest - midpoint > 0.5f * spread);
+    return vote;
+}
+
+// Vote count loops at once. temperature[ch][i] and status[ch][i] (0 = plausible, as from
+// classifySensorSamples) hold channel ch of loop i; only the first channels arrays are read.
+void voteSensorChannelsBatch(const float* const temperature[MAX_SENSOR_CHANNELS],
+                             const std::uint8_t* const status[MAX_SENSOR_CHANNELS], int channels,
+                             float* control, float* median, std::uint8_t* disagreement,
+                             std::size_t count, const VotingLimits& limits);
+
+#endif // COOLINGLOOP_SENSOR_VOTING_H
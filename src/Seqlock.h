@@ -0,0 +1,82 @@
+/*
+Single-writer sequence lock for publishing a snapshot to readers on other threads.
+
+The control loop publishes with store() and never waits; readers copy the value and retry
+if the writer was in the middle of an update. The value is held as relaxed atomic words
+between two fences, so a torn copy is detected rather than being a data race. T must be
+trivially copyable.
+*/
+
+#ifndef COOLINGLOOP_SEQLOCK_H
+#define COOLINGLOOP_SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <class T>
+class Seqlock {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock values are copied word by word");
+    static const std::size_t WORDS = (sizeof(T) + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+
+    std::atomic<std::uint32_t> sequence; // Odd while a store is in progress
+    std::atomic<std::uint32_t> words[WORDS];
+
+public:
+    Seqlock() : sequence(0) {
+        for (std::atomic<std::uint32_t>& word : words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Publish a new value (one writer only)
+    void store(const T& value) {
+        std::uint32_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        std::uint32_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    // One copy attempt. Returns false if a store overlapped it; version receives the
+    // sequence number of the copy.
+    bool tryLoad(T& value, std::uint32_t& version) const {
+        std::uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            return false;
+        }
+        std::uint32_t buffer[WORDS];
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        std::memcpy(&value, buffer, sizeof(T));
+        version = before;
+        return true;
+    }
+
+    // Copy the latest value, retrying until no store overlaps the copy
+    std::uint32_t load(T& value) const {
+        std::uint32_t version = 0;
+        while (!tryLoad(value, version)) {
+        }
+        return version;
+    }
+
+    // Sequence number of the latest completed store (0 = nothing published yet)
+    std::uint32_t version() const { return sequence.load(std::memory_order_acquire) & ~1u; }
+};
+
+#endif // COOLINGLOOP_SEQLOCK_H
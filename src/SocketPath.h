@@ -0,0 +1,26 @@
+/*
+Filesystem paths of the Unix sockets served by the metrics endpoint and the plant server.
+*/
+
+#ifndef COOLINGLOOP_SOCKET_PATH_H
+#define COOLINGLOOP_SOCKET_PATH_H
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Make way for a listening socket at path by removing a socket left by an earlier run. False
+// if anything else is there (a file, directory or symbolic link), which stays untouched.
+inline bool clearSocketPath(const char* path) {
+    struct stat info;
+    if (::lstat(path, &info) != 0) {
+        return errno == ENOENT;
+    }
+    return S_ISSOCK(info.st_mode) && (::unlink(path) == 0 || errno == ENOENT);
+}
+
+#endif
+
+#endif // COOLINGLOOP_SOCKET_PATH_H
@@ -0,0 +1,50 @@
+#include "TemperatureSensor.h"
+
+namespace {
+
+// Sensor data table: voltage (V) at each temperature (°C), falling as the coolant heats up
+const int TABLE_SIZE = 12;
+const float TABLE_TEMPERATURE[TABLE_SIZE] = {-20.0f, -10.0f, 0.0f, 10.0f, 20.0f, 30.0f,
+                                             40.0f, 50.0f, 60.0f, 80.0f, 100.0f, 120.0f};
+const float TABLE_VOLTAGE[TABLE_SIZE] = {4.771f, 4.642f, 4.438f, 4.141f, 3.751f, 3.325f,
+                                         2.838f, 2.500f, 1.915f, 1.212f, 0.749f, 0.500f};
+// Readings below the 100°C entry are reported as 120°C (the last entry is only used by
+// temperatureToVoltage to extend the curve for the simulator)
+const SensorTable DEFAULT_TABLE = {TABLE_TEMPERATURE, TABLE_VOLTAGE, TABLE_SIZE};
+
+} // namespace
+
+const SensorTable& defaultSensorTable() {
+    return DEFAULT_TABLE;
+}
+
+// Interpolate temperature from voltage based on sensor data table
+float interpolateTemperature(float voltage) {
+    return interpolateTemperature(voltage, DEFAULT_TABLE);
+}
+
+float interpolateTemperature(float voltage, const SensorTable& table) {
+    // Linear interpolation between the table entries; voltage falls as temperature rises
+    const float* temperature = table.temperature;
+    const float* volts = table.voltage;
+    if (voltage >= volts[0]) return temperature[0];
+    for (int i = 1; i < table.size - 1; ++i) {
+        if (voltage >= volts[i]) {
+            float t = (volts[i - 1] - voltage) / (volts[i - 1] - volts[i]);
+            return temperature[i - 1] + t * (temperature[i] - temperature[i - 1]);
+        }
+    }
+    return temperature[table.size - 1]; // Default for lower voltages
+}
+
+// Sensor voltage for a coolant temperature, linearly interpolated between table entries
+float temperatureToVoltage(float temperature) {
+    if (temperature <= TABLE_TEMPERATURE[0]) return TABLE_VOLTAGE[0];
+    for (int i = 1; i < TABLE_SIZE; ++i) {
+        if (temperature <= TABLE_TEMPERATURE[i]) {
+            float t = (temperature - TABLE_TEMPERATURE[i - 1]) / (TABLE_TEMPERATURE[i] - TABLE_TEMPERATURE[i - 1]);
+            return TABLE_VOLTAGE[i - 1] + t * (TABLE_VOLTAGE[i] - TABLE_VOLTAGE[i - 1]);
+        }
+    }
+    return TABLE_VOLTAGE[TABLE_SIZE - 1];
+}
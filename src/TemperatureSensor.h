@@ -0,0 +1,27 @@
+/*
+H-WTMS temperature sensor: conversion between sensor voltage and coolant temperature.
+*/
+
+#ifndef COOLINGLOOP_TEMPERATURE_SENSOR_H
+#define COOLINGLOOP_TEMPERATURE_SENSOR_H
+
+// Sensor data table: temperature (°C) rising and voltage (V) falling with the index. Readings
+// below the second-to-last voltage are reported as the last temperature; the last entry is
+// otherwise only used by temperatureToVoltage to extend the curve for the simulator.
+struct SensorTable {
+    const float* temperature;
+    const float* voltage;
+    int size;
+};
+
+// Built-in H-WTMS table (the calibration image can supply another one)
+const SensorTable& defaultSensorTable();
+
+// Interpolate temperature from voltage based on sensor data table
+float interpolateTemperature(float voltage);
+float interpolateTemperature(float voltage, const SensorTable& table);
+
+// Sensor voltage for a coolant temperature (inverse of the data table, used by the simulator)
+float temperatureToVoltage(float temperature);
+
+#endif // COOLINGLOOP_TEMPERATURE_SENSOR_H
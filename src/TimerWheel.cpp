@@ -0,0 +1,118 @@
+#include "TimerWheel.h"
+
+namespace {
+
+// Node::slot of a node that is not armed
+const std::uint16_t TIMER_FREE_SLOT = 0xFFFF;
+
+} // namespace
+
+TimerWheel::TimerWheel(std::size_t capacity, std::uint64_t start)
+    : nodes(capacity), freeList(capacity ? 0 : TIMER_NONE), occupied{0}, now(start), count(0) {
+    for (std::size_t i = 0; i < capacity; ++i) {
+        nodes[i] = Node{0, i + 1 < capacity ? static_cast<std::uint32_t>(i + 1) : TIMER_NONE, TIMER_NONE, 0, 0,
+                        TIMER_FREE_SLOT, 0};
+    }
+    for (std::uint32_t& head : heads) {
+        head = TIMER_NONE;
+    }
+}
+
+// Put an armed node in the lowest wheel whose current revolution holds its expiry
+void TimerWheel::link(std::uint32_t index) {
+    Node& node = nodes[index];
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           (node.expiry >> (TIMER_WHEEL_BITS * (level + 1))) != (now >> (TIMER_WHEEL_BITS * (level + 1)))) {
+        ++level;
+    }
+    unsigned slot = static_cast<unsigned>(node.expiry >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1);
+    std::uint32_t& head = heads[level * TIMER_WHEEL_SLOTS + slot];
+    node.prev = TIMER_NONE;
+    node.next = head;
+    if (head != TIMER_NONE) nodes[head].prev = index;
+    head = index;
+    node.slot = static_cast<std::uint16_t>(level * TIMER_WHEEL_SLOTS + slot);
+    occupied[level] |= 1ull << slot;
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    Node& node = nodes[index];
+    if (node.next != TIMER_NONE) nodes[node.next].prev = node.prev;
+    if (node.prev != TIMER_NONE) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.slot] = node.next;
+        if (node.next == TIMER_NONE) {
+            occupied[node.slot / TIMER_WHEEL_SLOTS] &= ~(1ull << (node.slot % TIMER_WHEEL_SLOTS));
+        }
+    }
+}
+
+// Disarm a node and return it to the pool
+void TimerWheel::release(std::uint32_t index) {
+    unlink(index);
+    Node& node = nodes[index];
+    node.slot = TIMER_FREE_SLOT;
+    ++node.generation;
+    node.next = freeList;
+    freeList = index;
+    --count;
+}
+
+// Move the clock to the next tick with timers due in the lowest wheel, to the next wrap of
+// the lowest wheel or to target, whichever comes first; cascade at a wrap. Returns the list
+// of the timers due at the new time.
+std::uint32_t* TimerWheel::advanceTo(std::uint64_t target) {
+    const std::uint64_t position = now & (TIMER_WHEEL_SLOTS - 1);
+    const std::uint64_t later = position == TIMER_WHEEL_SLOTS - 1 ? 0 : occupied[0] & (~0ull << (position + 1));
+    std::uint64_t next = now - position + (later ? static_cast<std::uint64_t>(__builtin_ctzll(later)) : TIMER_WHEEL_SLOTS);
+    now = next < target ? next : target;
+
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+        const int shift = TIMER_WHEEL_BITS * level;
+        if (now & ((1ull << shift) - 1)) break;
+        unsigned slot = static_cast<unsigned>(now >> shift) & (TIMER_WHEEL_SLOTS - 1);
+        std::uint32_t& head = heads[level * TIMER_WHEEL_SLOTS + slot];
+        std::uint32_t index = head;
+        head = TIMER_NONE;
+        occupied[level] &= ~(1ull << slot);
+        while (index != TIMER_NONE) {
+            std::uint32_t following = nodes[index].next;
+            link(index); // Into a lower wheel, or the slot due now
+            index = following;
+        }
+    }
+    return &heads[now & (TIMER_WHEEL_SLOTS - 1)];
+}
+
+TimerHandle TimerWheel::arm(std::uint64_t delay, std::uint32_t owner, std::uint16_t kind) {
+    if (freeList == TIMER_NONE) {
+        return TimerHandle{};
+    }
+    if (delay < 1) delay = 1;
+    if (delay > TIMER_WHEEL_MAX_DELAY) delay = TIMER_WHEEL_MAX_DELAY;
+    std::uint32_t index = freeList;
+    Node& node = nodes[index];
+    freeList = node.next;
+    node.expiry = now + delay;
+    node.owner = owner;
+    node.kind = kind;
+    link(index);
+    ++count;
+    return TimerHandle{index, node.generation};
+}
+
+bool TimerWheel::cancel(TimerHandle& handle) {
+    bool wasArmed = armed(handle);
+    if (wasArmed) {
+        release(handle.index);
+    }
+    handle = TimerHandle{};
+    return wasArmed;
+}
+
+bool TimerWheel::armed(const TimerHandle& handle) const {
+    return handle.index < nodes.size() && nodes[handle.index].slot != TIMER_FREE_SLOT &&
+           nodes[handle.index].generation == handle.generation;
+}
@@ -0,0 +1,117 @@
+/*
+Hierarchical timing wheel for the per-loop timers: the afterrun, the ignition debounce, the
+CAN transmit inhibit and the heartbeat of every loop a process runs, one wheel for all.
+
+Time advances in ticks. TIMER_WHEEL_LEVELS wheels of 64 slots each cover 64, 64^2, ...
+ticks; a timer sits in the lowest wheel whose current revolution its expiry falls in,
+in the slot of its expiry there. Each slot is an intrusive doubly linked list of timer
+nodes from a pool allocated up front, so arming and cancelling are a few index writes and
+never allocate. When the lowest wheel wraps, the next slot of the wheel above is cascaded
+down, each of its timers moving at most once per level; timers in the lowest wheel fire
+on their tick. A bitmap of occupied slots per wheel lets advance() skip idle ticks.
+
+Arm, cancel and expiry are O(1) whatever the number of armed timers, so a fleet of 100k
+loops can keep millions of them (BM_TimerWheel). A handle carries the generation of its
+node; once the timer has fired or been cancelled, the handle no longer matches and a late
+cancel() is a harmless no-op. Not thread-safe: a fleet uses one wheel per shard.
+*/
+
+#ifndef COOLINGLOOP_TIMER_WHEEL_H
+#define COOLINGLOOP_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int TIMER_WHEEL_LEVELS = 5;
+const int TIMER_WHEEL_BITS = 6; // 64 slots per wheel
+const int TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_BITS;
+const std::uint32_t TIMER_NONE = 0xFFFFFFFFu;
+
+// Longest delay (ticks): 63 revolutions of the top wheel, about 12 days at 1 ms ticks
+const std::uint64_t TIMER_WHEEL_MAX_DELAY = static_cast<std::uint64_t>(TIMER_WHEEL_SLOTS - 1)
+                                            << (TIMER_WHEEL_BITS * (TIMER_WHEEL_LEVELS - 1));
+
+// The timers of one cooling loop
+enum class LoopTimer : std::uint16_t {
+    AFTERRUN,          // End of the cooling after key-off
+    IGNITION_DEBOUNCE, // Ignition input stable long enough to accept
+    CAN_INHIBIT,       // Minimum interval between two transmissions of a message
+    HEARTBEAT,         // Transmit a message again even if it did not change
+    SOAK               // Heat soaked out of the power stage after key-off
+};
+const int LOOP_TIMER_COUNT = 5;
+
+struct TimerHandle {
+    std::uint32_t index = TIMER_NONE;
+    std::uint32_t generation = 0;
+};
+
+class TimerWheel {
+private:
+    struct Node {
+        std::uint64_t expiry;    // Tick
+        std::uint32_t next;      // Slot list, or free list
+        std::uint32_t prev;
+        std::uint32_t owner;     // Loop index
+        std::uint16_t kind;      // LoopTimer, or any value the owner chooses
+        std::uint16_t slot;      // level * 64 + slot, TIMER_FREE_SLOT when not armed
+        std::uint32_t generation;
+    };
+
+    std::vector<Node> nodes;
+    std::uint32_t freeList;
+    std::uint32_t heads[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+    std::uint64_t occupied[TIMER_WHEEL_LEVELS]; // Bit s set while slot s of the wheel is not empty
+    std::uint64_t now;
+    std::size_t count; // Armed timers
+
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    std::uint32_t* advanceTo(std::uint64_t target);
+
+public:
+    // Room for capacity armed timers; the clock starts at tick start
+    explicit TimerWheel(std::size_t capacity, std::uint64_t start = 0);
+
+    // Fire after delay ticks (at least 1, at most TIMER_WHEEL_MAX_DELAY); an invalid handle if
+    // capacity timers are already armed
+    TimerHandle arm(std::uint64_t delay, std::uint32_t owner, std::uint16_t kind);
+
+    // Disarm; false (and nothing changed) if the timer has already fired or been cancelled.
+    // The handle is reset either way.
+    bool cancel(TimerHandle& handle);
+    bool armed(const TimerHandle& handle) const;
+
+    // Advance the clock by ticks, calling fire(owner, kind) for each timer that expires, in
+    // tick order. fire may arm and cancel timers. Returns the number of timers fired.
+    template <typename Fire>
+    std::size_t advance(std::uint64_t ticks, Fire&& fire);
+
+    std::uint64_t time() const { return now; }
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return nodes.size(); }
+    std::size_t bytes() const { return nodes.size() * sizeof(Node) + sizeof(*this); }
+};
+
+template <typename Fire>
+std::size_t TimerWheel::advance(std::uint64_t ticks, Fire&& fire) {
+    const std::uint64_t target = now + ticks;
+    std::size_t fired = 0;
+    while (now < target) {
+        std::uint32_t* slot = advanceTo(target);
+        // One at a time: fire may cancel a timer that is due in the same tick
+        while (*slot != TIMER_NONE) {
+            std::uint32_t index = *slot;
+            std::uint32_t owner = nodes[index].owner;
+            std::uint16_t kind = nodes[index].kind;
+            release(index);
+            ++fired;
+            fire(owner, kind);
+        }
+    }
+    return fired;
+}
+
+#endif // COOLINGLOOP_TIMER_WHEEL_H
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "Afterrun.h"
+#include "Checkpoint.h"
+#include "CoolingLoopController.h"
+#include "PlantModel.h"
+#include "TemperatureSensor.h"
+
+namespace {
+
+// Ramp the coolant at 1 °C per cycle (within the plausible rate of change) with the ignition on
+void rampTo(CoolingLoopController& controller, float from, float to) {
+    float step = to > from ? 1.0f : -1.0f;
+    for (float temperature = from; (to - temperature) * step > 0.0f; temperature += step) {
+        controller.step({temperatureToVoltage(temperature), true, true});
+    }
+    controller.step({temperatureToVoltage(to), true, true});
+}
+
+} // namespace
+
+// Test for the afterrun time: none at or below the end temperature, growing with the excess,
+// capped for the battery
+TEST(AfterrunTest, DurationFromKeyOffTemperature) {
+    AfterrunLimits limits;
+    EXPECT_EQ(afterrunDuration(limits, 40.0f), 0.0f);
+    EXPECT_EQ(afterrunDuration(limits, 45.0f), 0.0f);
+    EXPECT_FLOAT_EQ(afterrunDuration(limits, 55.0f), 260.0f);
+    EXPECT_EQ(afterrunDuration(limits, 200.0f), limits.maximumSeconds);
+    EXPECT_EQ(afterrunDuration(limits, std::nanf("")), 0.0f);
+}
+
+// Test for key-off while hot: AFTERRUN at the afterrun speeds for the requested time, then
+// OFF when the owner's timer expires
+TEST(AfterrunTest, HotKeyOffRunsUntilTimerExpires) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableAfterrun(AfterrunLimits{});
+    rampTo(controller, 45.0f, 55.0f);
+
+    const ControlOutputs& keyOff = controller.step({temperatureToVoltage(55.0f), false, true});
+    EXPECT_EQ(keyOff.state, SystemState::AFTERRUN);
+    EXPECT_FLOAT_EQ(keyOff.afterrunSeconds, 260.0f);
+    EXPECT_FLOAT_EQ(keyOff.soakSeconds, 60.0f);
+    EXPECT_EQ(keyOff.pumpSpeed, 60.0f);
+    EXPECT_EQ(keyOff.fanSpeed, 40.0f);
+
+    // Requested once: the following cycles report no new time
+    const ControlOutputs& running = controller.step({temperatureToVoltage(55.0f), false, true});
+    EXPECT_EQ(running.state, SystemState::AFTERRUN);
+    EXPECT_EQ(running.afterrunSeconds, 0.0f);
+    EXPECT_EQ(running.pumpSpeed, 60.0f);
+
+    SensorInputs expired{temperatureToVoltage(55.0f), false, true};
+    expired.afterrunExpired = true;
+    const ControlOutputs& off = controller.step(expired);
+    EXPECT_EQ(off.state, SystemState::OFF);
+    EXPECT_EQ(off.pumpSpeed, 0.0f);
+    EXPECT_EQ(off.fanSpeed, 0.0f);
+}
+
+// Test for key-off while cool, and for a controller without afterrun: straight to OFF
+TEST(AfterrunTest, ColdKeyOffOrDisabledSwitchesOff) {
+    CoolingLoopController cool(50.0f, 70.0f);
+    cool.enableAfterrun(AfterrunLimits{});
+    rampTo(cool, 40.0f, 40.0f);
+    EXPECT_EQ(cool.step({temperatureToVoltage(40.0f), false, true}).state, SystemState::OFF);
+
+    CoolingLoopController legacy(50.0f, 70.0f);
+    rampTo(legacy, 45.0f, 55.0f);
+    const ControlOutputs& off = legacy.step({temperatureToVoltage(55.0f), false, true});
+    EXPECT_EQ(off.state, SystemState::OFF);
+    EXPECT_EQ(off.afterrunSeconds, 0.0f);
+}
+
+// Test for the early end once the soak time is over and the coolant is at the end
+// temperature, and for the ignition coming back on during afterrun
+TEST(AfterrunTest, EndsWhenSoakedAndCoolOrOnIgnition) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableAfterrun(AfterrunLimits{});
+    rampTo(controller, 45.0f, 50.0f);
+    ASSERT_EQ(controller.step({temperatureToVoltage(50.0f), false, true}).state, SystemState::AFTERRUN);
+    for (float temperature = 49.0f; temperature > 44.0f; temperature -= 1.0f) {
+        ASSERT_EQ(controller.step({temperatureToVoltage(temperature), false, true}).state, SystemState::AFTERRUN);
+    }
+    // Cool, but the heat is still soaking out of the power stage
+    const ControlOutputs& soaking = controller.step({temperatureToVoltage(44.0f), false, true});
+    EXPECT_EQ(soaking.state, SystemState::AFTERRUN);
+    EXPECT_EQ(soaking.pumpSpeed, 60.0f);
+    SensorInputs soaked{temperatureToVoltage(44.0f), false, true};
+    soaked.afterrunSoaked = true;
+    EXPECT_EQ(controller.step(soaked).state, SystemState::OFF);
+
+    rampTo(controller, 45.0f, 55.0f);
+    ASSERT_EQ(controller.step({temperatureToVoltage(55.0f), false, true}).state, SystemState::AFTERRUN);
+    const ControlOutputs& on = controller.step({temperatureToVoltage(55.0f), true, true});
+    EXPECT_EQ(on.state, SystemState::ON);
+    EXPECT_GT(on.pumpSpeed, 0.0f);
+}
+
+// Test for low coolant during afterrun: the pump must not run dry
+TEST(AfterrunTest, LowCoolantShutsDown) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableAfterrun(AfterrunLimits{});
+    rampTo(controller, 45.0f, 55.0f);
+    ASSERT_EQ(controller.step({temperatureToVoltage(55.0f), false, true}).state, SystemState::AFTERRUN);
+    const ControlOutputs& dry = controller.step({temperatureToVoltage(55.0f), false, false});
+    EXPECT_EQ(dry.state, SystemState::SAFETY_SHUTDOWN);
+    EXPECT_EQ(dry.cause, ShutdownCause::LOW_COOLANT);
+    EXPECT_EQ(dry.pumpSpeed, 0.0f);
+}
+
+// Test for overtemperature during afterrun: shutdown as in ON, full cooling with derating
+TEST(AfterrunTest, OvertemperatureShutsDownOrCoolsFully) {
+    for (int withDerating = 0; withDerating < 2; ++withDerating) {
+        CoolingLoopController controller(50.0f, 60.0f);
+        controller.enableAfterrun(AfterrunLimits{});
+        if (withDerating) controller.enableDerating(DerateLimits{});
+        rampTo(controller, 45.0f, 55.0f);
+        ASSERT_EQ(controller.step({temperatureToVoltage(55.0f), false, true}).state, SystemState::AFTERRUN);
+        for (float temperature = 56.0f; temperature < 61.0f; temperature += 1.0f) {
+            ASSERT_EQ(controller.step({temperatureToVoltage(temperature), false, true}).state,
+                      SystemState::AFTERRUN);
+        }
+        const ControlOutputs& hot = controller.step({temperatureToVoltage(61.0f), false, true});
+        if (withDerating) {
+            EXPECT_EQ(hot.state, SystemState::AFTERRUN);
+            EXPECT_EQ(hot.pumpSpeed, 100.0f);
+            EXPECT_EQ(hot.fanSpeed, 100.0f);
+            EXPECT_EQ(controller.step({temperatureToVoltage(60.0f), false, true}).pumpSpeed, 60.0f);
+        } else {
+            EXPECT_EQ(hot.state, SystemState::SAFETY_SHUTDOWN);
+            EXPECT_EQ(hot.cause, ShutdownCause::OVERTEMPERATURE);
+            EXPECT_EQ(hot.pumpSpeed, 0.0f);
+        }
+    }
+}
+
+// Test for a warm restart during afterrun: the timer is gone, so the restored controller
+// resumes as ON and requests a new afterrun time at the next cycle with the ignition off
+TEST(AfterrunTest, WarmRestartRequestsNewTime) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableAfterrun(AfterrunLimits{});
+    rampTo(controller, 45.0f, 55.0f);
+    ASSERT_EQ(controller.step({temperatureToVoltage(55.0f), false, true}).state, SystemState::AFTERRUN);
+
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    ASSERT_EQ(controller.saveCheckpoint(snapshot, sizeof(snapshot)), CHECKPOINT_SIZE);
+    CoolingLoopController restarted(50.0f, 70.0f);
+    restarted.enableAfterrun(AfterrunLimits{});
+    ASSERT_TRUE(restarted.restoreCheckpoint(snapshot, sizeof(snapshot)));
+    EXPECT_EQ(restarted.state(), SystemState::ON);
+    const ControlOutputs& again = restarted.step({temperatureToVoltage(55.0f), false, true});
+    EXPECT_EQ(again.state, SystemState::AFTERRUN);
+    EXPECT_FLOAT_EQ(again.afterrunSeconds, 260.0f);
+}
+
+// Test for the closed loop: the heat soaking out of the power stage after key-off raises the
+// standing coolant less with afterrun than without
+TEST(AfterrunTest, ClosedLoopLowersSoakPeak) {
+    float peak[2] = {0.0f, 0.0f};
+    for (int withAfterrun = 0; withAfterrun < 2; ++withAfterrun) {
+        PlantParameters parameters;
+        parameters.heatLoad = 6000.0f;
+        CoolingLoopController controller(50.0f, 70.0f);
+        if (withAfterrun) controller.enableAfterrun(AfterrunLimits{});
+        PlantModel plant(parameters, 45.0f);
+        double remaining = 0.0; // The owner's afterrun timer (s)
+        for (int second = 0; second < 1800; ++second) {
+            bool ignition = second < 900;
+            if (!ignition) {
+                plant.setHeatLoad(1500.0f * std::exp(-(second - 900) / 60.0f)); // Soak
+            }
+            SensorInputs inputs{plant.sensorVoltage(), ignition, true};
+            inputs.afterrunExpired = remaining > 0.0 && (remaining -= 1.0) <= 0.0;
+            const ControlOutputs& out = controller.step(inputs);
+            if (out.afterrunSeconds > 0.0f) remaining = out.afterrunSeconds;
+            plant.step(1.0f, out.pumpSpeed, out.fanSpeed);
+            if (!ignition) peak[withAfterrun] = std::max(peak[withAfterrun], plant.temperature());
+        }
+        EXPECT_EQ(controller.state(), SystemState::OFF);
+    }
+    EXPECT_LT(peak[1], peak[0] - 2.0f) << peak[0] << " " << peak[1];
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+#include "AllocationTracker.h"
+#include "Arena.h"
+#include "CANBus.h"
+#include "Checkpoint.h"
+#include "CoolingLoopController.h"
+#include "PlantModel.h"
+
+// Fails the running test if anything allocates between construction and destruction.
+// Wrap the steady-state part of a control cycle test in one of these.
+class SteadyStateAllocationGuard {
+public:
+    SteadyStateAllocationGuard() { AllocationTracker::arm(); }
+
+    ~SteadyStateAllocationGuard() {
+        if (AllocationTracker::disarm() != 0) {
+            std::ostringstream report;
+            AllocationTracker::report(report);
+            ADD_FAILURE() << "Steady-state control cycle allocated: " << report.str();
+        }
+    }
+};
+
+// Test for the steady-state control cycle: controller, CAN encoding, checkpoint and plant
+TEST(SteadyStateAllocationTest, ControlCycleDoesNotAllocate) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    PlantModel plant(PlantParameters{}, 45.0f);
+    controller.step({plant.sensorVoltage(), true, true}); // OFF -> ON
+    unsigned char snapshot[CHECKPOINT_SIZE];
+
+    SteadyStateAllocationGuard guard;
+    unsigned int checksum = 0;
+    for (int cycle = 0; cycle < 1000; ++cycle) {
+        const ControlOutputs& out = controller.step({plant.sensorVoltage(), true, true});
+        CANFrame frame = encodeCANFrame(out.pumpSpeed, out.fanSpeed);
+        checksum += frame.data[2];
+        checksum += static_cast<unsigned int>(controller.saveCheckpoint(snapshot, sizeof(snapshot)));
+        plant.step(1.0f, out.pumpSpeed, out.fanSpeed);
+    }
+    EXPECT_GT(checksum, 0u);
+}
+
+namespace {
+
+// Allocations of the tracker test escape through here, or the optimiser elides the new and
+// delete pair (C++14 allows it) and the tracker sees less than the test expects
+std::vector<int>* volatile escapedValues = nullptr;
+
+} // namespace
+
+// Test for the tracker itself: allocations are attributed to a call site
+TEST(SteadyStateAllocationTest, ReportListsCallSites) {
+    AllocationTracker::arm();
+    escapedValues = new std::vector<int>(16);
+    long long allocations = AllocationTracker::disarm();
+    delete escapedValues;
+    escapedValues = nullptr;
+
+    EXPECT_EQ(allocations, 2); // The vector object and its buffer
+    std::ostringstream report;
+    AllocationTracker::report(report);
+    EXPECT_NE(report.str().find("2 allocation(s)"), std::string::npos);
+}
+
+// Test for MonotonicArena
+TEST(ArenaTest, AllocatesAlignedUntilExhausted) {
+    alignas(16) unsigned char buffer[64];
+    MonotonicArena arena(buffer, sizeof(buffer));
+
+    char* c = arena.create<char>('x');
+    double* d = arena.create<double>(1.5);
+    ASSERT_NE(c, nullptr);
+    ASSERT_NE(d, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(d) % alignof(double), 0u);
+    EXPECT_EQ(*d, 1.5);
+    EXPECT_EQ(arena.allocate(128), nullptr);
+
+    arena.reset();
+    EXPECT_EQ(arena.bytesUsed(), 0u);
+}
@@ -0,0 +1,143 @@
+#include "AllocationTracker.h"
+
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#define COOLINGLOOP_CALL_SITE() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define COOLINGLOOP_CALL_SITE() _ReturnAddress()
+#else
+#define COOLINGLOOP_CALL_SITE() nullptr
+#endif
+
+namespace {
+
+const int MAX_CALL_SITES = 64;
+
+struct CallSite {
+    void* address;
+    long long count;
+    unsigned long long bytes;
+};
+
+// Per-thread state, so the hook needs no locking
+thread_local long long allocationCount = 0;
+thread_local bool armed = false;
+thread_local long long armedAllocations = 0;
+thread_local CallSite callSites[MAX_CALL_SITES];
+thread_local int callSiteCount = 0;
+thread_local long long unrecordedAllocations = 0; // Call-site table full
+
+void record(void* address, std::size_t size) {
+    ++allocationCount;
+    if (!armed) {
+        return;
+    }
+    ++armedAllocations;
+    for (int i = 0; i < callSiteCount; ++i) {
+        if (callSites[i].address == address) {
+            ++callSites[i].count;
+            callSites[i].bytes += size;
+            return;
+        }
+    }
+    if (callSiteCount < MAX_CALL_SITES) {
+        callSites[callSiteCount++] = CallSite{address, 1, size};
+    } else {
+        ++unrecordedAllocations;
+    }
+}
+
+void* allocate(std::size_t size, void* callSite) {
+    record(callSite, size);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// Print the function containing an address, when the platform can tell
+void describe(std::ostream& out, void* address) {
+    out << address;
+#if defined(__GNUC__) && !defined(_WIN32)
+    Dl_info info{};
+    if (!address || !dladdr(address, &info)) {
+        return;
+    }
+    if (info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        out << " " << (status == 0 ? demangled : info.dli_sname);
+        std::free(demangled);
+    } else if (info.dli_fname) {
+        out << " (" << info.dli_fname << ")";
+    }
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size, COOLINGLOOP_CALL_SITE());
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size, COOLINGLOOP_CALL_SITE());
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace AllocationTracker {
+
+long long threadAllocations() {
+    return allocationCount;
+}
+
+void arm() {
+    armedAllocations = 0;
+    callSiteCount = 0;
+    unrecordedAllocations = 0;
+    armed = true;
+}
+
+long long disarm() {
+    armed = false;
+    return armedAllocations;
+}
+
+void report(std::ostream& out) {
+    // Disarm while printing, the report itself may allocate
+    bool wasArmed = armed;
+    armed = false;
+    out << armedAllocations << " allocation(s) from " << callSiteCount << " call site(s)\n";
+    for (int i = 0; i < callSiteCount; ++i) {
+        out << "  " << callSites[i].count << "x, " << callSites[i].bytes << " bytes at ";
+        describe(out, callSites[i].address);
+        out << "\n";
+    }
+    if (unrecordedAllocations) {
+        out << "  " << unrecordedAllocations << " more from call sites not recorded\n";
+    }
+    armed = wasArmed;
+}
+
+} // namespace AllocationTracker
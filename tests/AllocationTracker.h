@@ -0,0 +1,31 @@
+/*
+Test-only global operator new hook.
+
+Linking AllocationTracker.cpp into a binary replaces the global operator new/delete.
+Every allocation is counted per thread; while a thread has tracking armed, allocations
+are also recorded by call site so a report can point at the code that allocated.
+The hook itself never allocates.
+*/
+
+#ifndef COOLINGLOOP_ALLOCATION_TRACKER_H
+#define COOLINGLOOP_ALLOCATION_TRACKER_H
+
+#include <iosfwd>
+
+namespace AllocationTracker {
+
+// Allocations made by the calling thread since it started
+long long threadAllocations();
+
+// Start recording call sites on the calling thread (clears the previous records)
+void arm();
+
+// Stop recording; returns the number of allocations made while armed
+long long disarm();
+
+// Allocations recorded by the last arm()/disarm() window, grouped by call site
+void report(std::ostream& out);
+
+} // namespace AllocationTracker
+
+#endif // COOLINGLOOP_ALLOCATION_TRACKER_H
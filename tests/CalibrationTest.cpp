@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "Calibration.h"
+#include "CoolingLoopController.h"
+
+// Test for the build step: the baked image maps, validates and equals the built-in calibration
+TEST(CalibrationTest, BakedImageMatchesBuiltIn) {
+    const CalibrationImage* image = mapCalibrationImage(COOLINGLOOP_CALIBRATION_IMAGE);
+    ASSERT_NE(image, nullptr);
+    EXPECT_EQ(std::memcmp(image, &defaultCalibration(), sizeof(CalibrationImage)), 0);
+    EXPECT_FLOAT_EQ(interpolateTemperature(2.5f, sensorTable(*image)), 50.0f);
+    EXPECT_EQ(canLayout(*image).id, DEFAULT_CAN_LAYOUT.id);
+    unmapCalibrationImage(image);
+
+    EXPECT_EQ(mapCalibrationImage("no_such_calibration.img"), nullptr);
+}
+
+// Test for parseCalibration: bad lines are reported with their number
+TEST(CalibrationTest, ParseReportsBadLines) {
+    CalibrationImage image;
+    std::string error;
+    std::istringstream badValue("sensor 0 4.0\nsensor 100 1.0\npump_pid -0.5 -0.1\n");
+    EXPECT_FALSE(parseCalibration(badValue, image, error));
+    EXPECT_NE(error.find("line 3"), std::string::npos);
+
+    std::istringstream unknown("# comment\n\ngain 1\n");
+    EXPECT_FALSE(parseCalibration(unknown, image, error));
+    EXPECT_NE(error.find("line 3"), std::string::npos);
+
+    // The pump command must fit in the frame
+    std::istringstream layout("sensor 0 4.0\nsensor 100 1.0\ncan_dlc 4\ncan_pump_byte 4\n");
+    EXPECT_FALSE(parseCalibration(layout, image, error));
+}
+
+// Test for validateCalibrationImage: any damaged byte or a wrong size is rejected
+TEST(CalibrationTest, ValidateRejectsCorruption) {
+    CalibrationImage image = defaultCalibration();
+    EXPECT_TRUE(validateCalibrationImage(&image, sizeof(image)));
+    EXPECT_FALSE(validateCalibrationImage(&image, sizeof(image) - 1));
+
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(&image);
+    for (std::size_t i = 0; i < sizeof(image); i += 7) {
+        bytes[i] ^= 0x10;
+        EXPECT_FALSE(validateCalibrationImage(&image, sizeof(image))) << "byte " << i;
+        bytes[i] ^= 0x10;
+    }
+}
+
+// Test for validateCalibrationImage through parseCalibration: a well-formed file with values
+// the controller cannot run on is rejected, one line at a time
+TEST(CalibrationTest, RejectsImplausibleValues) {
+    const std::string valid = "sensor 0 4.0\nsensor 100 1.0\n"
+                              "open_voltage 4.9\nshort_voltage 0.3\nmax_step 0.5\nmax_spread 15\n"
+                              "pump_pid -0.5 -0.1 -0.05\nfan_pid -0.4 -0.1 -0.03\nsetpoint 50\nthreshold 70\n"
+                              "can_id 0x18FF408F\ncan_dlc 8\ncan_pump_byte 2\ncan_fan_byte 6\n";
+    CalibrationImage image;
+    std::string error;
+    std::istringstream good(valid);
+    ASSERT_TRUE(parseCalibration(good, image, error)) << error;
+
+    // Each line overrides the valid value before it
+    const char* const overrides[] = {
+        "pump_pid nan -0.1 -0.05", "fan_pid -0.4 inf -0.03", "setpoint inf",     "threshold nan",
+        "open_voltage nan",        "sensor 120 -inf",        "short_voltage 4.9", "max_step 0",
+        "max_spread -1",           "setpoint 70",            "can_id 0x20000000",
+    };
+    for (const char* line : overrides) {
+        std::istringstream bad(valid + line + "\n");
+        EXPECT_FALSE(parseCalibration(bad, image, error)) << line;
+    }
+}
+
+// Test for the calibrated controller: table, gains and CAN layout all come from the image
+TEST(CalibrationTest, ControllerUsesCalibratedImage) {
+    std::istringstream text("sensor 0 4.0\nsensor 100 1.0\nsensor 120 0.5\n"
+                            "open_voltage 4.9\nshort_voltage 0.3\nmax_step 0.5\nmax_spread 15\n"
+                            "pump_pid -2 0 0\nfan_pid -1 0 0\nsetpoint 60\nthreshold 90\n"
+                            "can_id 0x100\ncan_dlc 2\ncan_pump_byte 0\ncan_fan_byte 1\n");
+    CalibrationImage image;
+    std::string error;
+    ASSERT_TRUE(parseCalibration(text, image, error)) << error;
+
+    // 1.6 V is 80°C on this table (about 69°C on the built-in one)
+    CoolingLoopController controller(image, 60.0f, 90.0f);
+    const ControlOutputs& out = controller.step({1.6f, true, true});
+    EXPECT_EQ(out.state, SystemState::ON); // Controls in the ignition cycle itself
+    EXPECT_NEAR(out.measuredTemperature, 80.0f, 1e-4f);
+    EXPECT_NEAR(out.pumpSpeed, 40.0f, 1e-3f); // Kp -2 on an error of -20°C
+    EXPECT_NEAR(out.fanSpeed, 20.0f, 1e-3f);
+
+    CANFrame frame = encodeCANFrame(out.pumpSpeed, out.fanSpeed, canLayout(image));
+    EXPECT_EQ(frame.id, 0x100u);
+    EXPECT_EQ(frame.dlc, 2);
+    EXPECT_NEAR(frame.data[0], 102, 1); // 40 % of 255
+    EXPECT_NEAR(frame.data[1], 51, 1);
+}
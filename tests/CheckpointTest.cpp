@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Checkpoint.h"
+#include "Checksum.h"
+#include "CoolingLoopController.h"
+#include "PlantModel.h"
+#include "TemperatureSensor.h"
+
+namespace {
+
+// Run a controller closed-loop against a plant for a number of cycles
+void run(CoolingLoopController& controller, PlantModel& plant, int cycles) {
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        const ControlOutputs& out = controller.step({plant.sensorVoltage(), true, true});
+        plant.step(1.0f, out.pumpSpeed, out.fanSpeed);
+    }
+}
+
+// Overwrite bytes of a snapshot and fix up its checksum, as a bad writer would have done
+void patch(unsigned char* snapshot, std::size_t offset, const void* value, std::size_t size) {
+    std::memcpy(snapshot + offset, value, size);
+    std::uint32_t sum = fnv1a(snapshot, CHECKPOINT_SIZE - 4);
+    for (int i = 0; i < 4; ++i) {
+        snapshot[CHECKPOINT_SIZE - 4 + i] = static_cast<unsigned char>(sum >> (8 * i));
+    }
+}
+
+} // namespace
+
+// Test for saveCheckpoint/restoreCheckpoint: a restored controller continues bit for bit
+TEST(CheckpointTest, RestoredControllerContinuesExactly) {
+    PlantParameters parameters;
+    parameters.heatLoad = 3000.0f;
+    CoolingLoopController original(50.0f, 70.0f);
+    PlantModel plant(parameters, 45.0f);
+    run(original, plant, 300);
+
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    ASSERT_EQ(original.saveCheckpoint(snapshot, sizeof(snapshot)), CHECKPOINT_SIZE);
+    EXPECT_EQ(std::memcmp(snapshot, "CLCS", 4), 0);
+    EXPECT_EQ(snapshot[4] | (snapshot[5] << 8), CHECKPOINT_VERSION);
+
+    CoolingLoopController restored(50.0f, 70.0f);
+    ASSERT_TRUE(restored.restoreCheckpoint(snapshot, sizeof(snapshot)));
+    EXPECT_EQ(restored.state(), SystemState::ON);
+
+    for (int cycle = 0; cycle < 300; ++cycle) {
+        SensorInputs inputs{plant.sensorVoltage(), true, true};
+        ControlOutputs expected = original.step(inputs);
+        ControlOutputs actual = restored.step(inputs);
+        ASSERT_EQ(actual.pumpSpeed, expected.pumpSpeed) << cycle;
+        ASSERT_EQ(actual.fanSpeed, expected.fanSpeed) << cycle;
+        ASSERT_EQ(actual.measuredTemperature, expected.measuredTemperature) << cycle;
+        plant.step(1.0f, expected.pumpSpeed, expected.fanSpeed);
+    }
+}
+
+TEST(CheckpointTest, RejectsDamagedOrForeignSnapshots) {
+    CoolingLoopController source(50.0f, 70.0f);
+    source.step({temperatureToVoltage(55.0f), true, true});
+    source.step({temperatureToVoltage(55.0f), true, true});
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    ASSERT_EQ(source.saveCheckpoint(snapshot, sizeof(snapshot)), CHECKPOINT_SIZE);
+    EXPECT_EQ(source.saveCheckpoint(snapshot, CHECKPOINT_SIZE - 1), 0u);
+
+    CoolingLoopController target(50.0f, 70.0f);
+    EXPECT_FALSE(target.restoreCheckpoint(snapshot, CHECKPOINT_SIZE - 1));
+
+    unsigned char damaged[CHECKPOINT_SIZE];
+    std::memcpy(damaged, snapshot, sizeof(damaged));
+    damaged[30] ^= 0x01;
+    EXPECT_FALSE(target.restoreCheckpoint(damaged, sizeof(damaged)));
+
+    // Taken with other setpoints
+    CoolingLoopController other(45.0f, 70.0f);
+    EXPECT_FALSE(other.restoreCheckpoint(snapshot, sizeof(snapshot)));
+
+    // A failed restore leaves the controller as it was
+    EXPECT_EQ(target.state(), SystemState::OFF);
+    EXPECT_TRUE(target.restoreCheckpoint(snapshot, sizeof(snapshot)));
+    EXPECT_EQ(target.state(), SystemState::ON);
+}
+
+// Test for restoreCheckpoint: a well-formed snapshot with values the controller cannot hold
+// is rejected, so the application starts cold
+TEST(CheckpointTest, RejectsOutOfRangeFields) {
+    CoolingLoopController source(50.0f, 70.0f);
+    source.step({temperatureToVoltage(55.0f), true, true});
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    ASSERT_EQ(source.saveCheckpoint(snapshot, sizeof(snapshot)), CHECKPOINT_SIZE);
+
+    const float nan = std::nanf("");
+    const float infinity = HUGE_VALF;
+    const float tooFast = 150.0f;
+    const std::uint8_t mask = 0xFF;
+    const std::uint8_t flags = 0x04;
+    struct Field {
+        std::size_t offset;
+        const void* value;
+        std::size_t size;
+    };
+    const Field fields[] = {
+        {19, &mask, 1},      // active sensors beyond the channels
+        {20, &flags, 1},     // unknown flag bit
+        {21, &nan, 4},       // measured temperature
+        {25, &tooFast, 4},   // pump speed
+        {29, &nan, 4},       // fan speed
+        {37, &infinity, 4},  // pump integral
+        {45, &nan, 4},       // fan integral
+        {53, &infinity, 4},  // previous voltage
+    };
+    CoolingLoopController target(50.0f, 70.0f);
+    for (const Field& field : fields) {
+        unsigned char bad[CHECKPOINT_SIZE];
+        std::memcpy(bad, snapshot, sizeof(bad));
+        patch(bad, field.offset, field.value, field.size);
+        EXPECT_FALSE(target.restoreCheckpoint(bad, sizeof(bad))) << field.offset;
+        EXPECT_EQ(target.state(), SystemState::OFF) << field.offset;
+    }
+    EXPECT_TRUE(target.restoreCheckpoint(snapshot, sizeof(snapshot)));
+}
+
+// Test for the warm restart after a latched shutdown
+TEST(CheckpointTest, RestartClearsShutdownButKeepsIntegrators) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.step({temperatureToVoltage(65.0f), true, true});
+    for (int cycle = 0; cycle < 20; ++cycle) {
+        controller.step({temperatureToVoltage(65.0f), true, true});
+    }
+    controller.step({temperatureToVoltage(69.0f), true, true});
+    controller.step({temperatureToVoltage(71.0f), true, true});
+    ASSERT_EQ(controller.state(), SystemState::SAFETY_SHUTDOWN);
+
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    ASSERT_EQ(controller.saveCheckpoint(snapshot, sizeof(snapshot)), CHECKPOINT_SIZE);
+    CoolingLoopController warm(50.0f, 70.0f);
+    ASSERT_TRUE(warm.restoreCheckpoint(snapshot, sizeof(snapshot)));
+    EXPECT_EQ(warm.state(), SystemState::OFF);
+
+    // Back on at 60°C: the warm controller picks up the integrated demand, a cold one starts low
+    CoolingLoopController cold(50.0f, 70.0f);
+    SensorInputs inputs{temperatureToVoltage(60.0f), true, true};
+    warm.step(inputs);
+    cold.step(inputs);
+    EXPECT_GT(warm.step(inputs).pumpSpeed, cold.step(inputs).pumpSpeed);
+}
+
+// Test for writeCheckpointFile/readCheckpointFile
+TEST(CheckpointTest, FileRoundTrip) {
+    std::string path = testing::TempDir() + "coolingloop_checkpoint.bin";
+    std::string tempPath = path + ".tmp";
+    unsigned char data[CHECKPOINT_SIZE];
+    for (std::size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<unsigned char>(i * 7);
+    }
+    ASSERT_TRUE(writeCheckpointFile(path.c_str(), tempPath.c_str(), data, sizeof(data)));
+
+    unsigned char read[CHECKPOINT_SIZE + 1];
+    ASSERT_EQ(readCheckpointFile(path.c_str(), read, sizeof(read)), sizeof(data));
+    EXPECT_EQ(std::memcmp(read, data, sizeof(data)), 0);
+    EXPECT_EQ(readCheckpointFile((path + ".missing").c_str(), read, sizeof(read)), 0u);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "AllocationTracker.h"
+#include "CANBus.h"
+#include "Calibration.h"
+#include "Checkpoint.h"
+#include "CoSimulation.h"
+#include "CoolingLoopController.h"
+#include "TemperatureSensor.h"
+
+// Test for the C ABI against the controller itself: one control cycle per period-long step,
+// with the same commands and CAN frame
+TEST(CoSimulationTest, StepsLikeController) {
+    CoolingLoopInstance* instance = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 1.0);
+    ASSERT_NE(instance, nullptr);
+    CoolingLoopController controller(50.0f, 70.0f);
+
+    CoolingLoopOutputs outputs;
+    for (int cycle = 0; cycle < 50; ++cycle) {
+        float voltage = temperatureToVoltage(40.0f + static_cast<float>(cycle) * 0.5f);
+        ASSERT_EQ(coolingLoopSetInputs(instance, voltage, 1, 1), COOLINGLOOP_OK);
+        ASSERT_EQ(coolingLoopDoStep(instance, 1.0), COOLINGLOOP_OK);
+        const ControlOutputs& expected = controller.step({voltage, true, true});
+        ASSERT_EQ(coolingLoopGetOutputs(instance, &outputs), COOLINGLOOP_OK);
+        ASSERT_EQ(outputs.pumpSpeed, expected.pumpSpeed) << cycle;
+        ASSERT_EQ(outputs.fanSpeed, expected.fanSpeed) << cycle;
+        ASSERT_EQ(outputs.state, static_cast<int>(expected.state)) << cycle;
+    }
+    CANFrame frame = encodeCANFrame(outputs.pumpSpeed, outputs.fanSpeed);
+    EXPECT_EQ(outputs.canId, frame.id);
+    EXPECT_EQ(outputs.canDlc, frame.dlc);
+    EXPECT_EQ(std::memcmp(outputs.canData, frame.data, sizeof(frame.data)), 0);
+    EXPECT_DOUBLE_EQ(coolingLoopTime(instance), 50.0);
+    coolingLoopFreeInstance(instance);
+}
+
+// Test for host steps that differ from the control period: outputs are held between samples
+// and a long step runs every cycle it covers
+TEST(CoSimulationTest, SamplesAtControlPeriod) {
+    CoolingLoopInstance* fine = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 0.1);
+    CoolingLoopInstance* coarse = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 0.1);
+    ASSERT_NE(fine, nullptr);
+    ASSERT_NE(coarse, nullptr);
+    float voltage = temperatureToVoltage(62.0f);
+    coolingLoopSetInputs(fine, voltage, 1, 1);
+    coolingLoopSetInputs(coarse, voltage, 1, 1);
+
+    // 100 steps of 10 ms reach the same 10 cycles as one step of 1 s
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.setControlPeriod(0.1f);
+    CoolingLoopOutputs fineOut, coarseOut;
+    for (int step = 0; step < 100; ++step) {
+        coolingLoopDoStep(fine, 0.01);
+        if (step % 10 == 0) {
+            const ControlOutputs& expected = controller.step({voltage, true, true});
+            coolingLoopGetOutputs(fine, &fineOut);
+            ASSERT_EQ(fineOut.pumpSpeed, expected.pumpSpeed) << step;
+        }
+    }
+    coolingLoopDoStep(coarse, 1.0);
+    coolingLoopGetOutputs(fine, &fineOut);
+    coolingLoopGetOutputs(coarse, &coarseOut);
+    EXPECT_EQ(fineOut.pumpSpeed, coarseOut.pumpSpeed);
+    EXPECT_EQ(fineOut.fanSpeed, coarseOut.fanSpeed);
+
+    // A zero step samples nothing
+    EXPECT_EQ(coolingLoopDoStep(coarse, 0.0), COOLINGLOOP_OK);
+    EXPECT_EQ(coolingLoopDoStep(coarse, -1.0), COOLINGLOOP_ERROR);
+    coolingLoopGetOutputs(coarse, &fineOut);
+    EXPECT_EQ(fineOut.pumpSpeed, coarseOut.pumpSpeed);
+    coolingLoopFreeInstance(fine);
+    coolingLoopFreeInstance(coarse);
+}
+
+// Test for the control period: the instance runs the calibrated loop per second, whatever
+// its period
+TEST(CoSimulationTest, ResponsePerSecondIndependentOfPeriod) {
+    CoolingLoopInstance* slow = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 1.0);
+    CoolingLoopInstance* fast = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 0.01);
+    ASSERT_NE(slow, nullptr);
+    ASSERT_NE(fast, nullptr);
+    float voltage = temperatureToVoltage(55.0f);
+    coolingLoopSetInputs(slow, voltage, 1, 1);
+    coolingLoopSetInputs(fast, voltage, 1, 1);
+    coolingLoopDoStep(slow, 1.0);
+    coolingLoopDoStep(fast, 1.0);
+    CoolingLoopOutputs slowOut, fastOut;
+    for (int second = 1; second <= 10; ++second) {
+        coolingLoopDoStep(slow, 1.0);
+        coolingLoopDoStep(fast, 1.0);
+        coolingLoopGetOutputs(slow, &slowOut);
+        coolingLoopGetOutputs(fast, &fastOut);
+        EXPECT_NEAR(fastOut.pumpSpeed, slowOut.pumpSpeed, 1.0f) << second;
+        EXPECT_NEAR(fastOut.fanSpeed, slowOut.fanSpeed, 1.0f) << second;
+    }
+    EXPECT_LT(fastOut.pumpSpeed, 50.0f);
+    coolingLoopFreeInstance(slow);
+    coolingLoopFreeInstance(fast);
+}
+
+// Test for rollback: a restored snapshot continues bit-identically, keeps a latched shutdown
+// and a damaged one leaves the instance alone
+TEST(CoSimulationTest, SerializedStateRollsBack) {
+    CoolingLoopInstance* instance = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 1.0);
+    ASSERT_NE(instance, nullptr);
+    coolingLoopSetInputs(instance, temperatureToVoltage(60.0f), 1, 1);
+    coolingLoopDoStep(instance, 5.0);
+
+    unsigned char state[COOLINGLOOP_STATE_SIZE];
+    ASSERT_EQ(coolingLoopSerializeState(instance, state, sizeof(state)), COOLINGLOOP_OK);
+    CoolingLoopOutputs first, second;
+    coolingLoopDoStep(instance, 3.0);
+    coolingLoopGetOutputs(instance, &first);
+    ASSERT_EQ(coolingLoopDeserializeState(instance, state, sizeof(state)), COOLINGLOOP_OK);
+    EXPECT_DOUBLE_EQ(coolingLoopTime(instance), 5.0);
+    coolingLoopDoStep(instance, 3.0);
+    coolingLoopGetOutputs(instance, &second);
+    EXPECT_EQ(first.pumpSpeed, second.pumpSpeed);
+    EXPECT_EQ(first.fanSpeed, second.fanSpeed);
+    EXPECT_EQ(first.measuredTemperature, second.measuredTemperature);
+
+    // Low coolant latches SAFETY_SHUTDOWN, and a rollback to it stays latched
+    coolingLoopSetInputs(instance, temperatureToVoltage(60.0f), 1, 0);
+    coolingLoopDoStep(instance, 1.0);
+    coolingLoopGetOutputs(instance, &first);
+    ASSERT_EQ(first.state, 2);
+    ASSERT_EQ(coolingLoopSerializeState(instance, state, sizeof(state)), COOLINGLOOP_OK);
+    CoolingLoopInstance* restored = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 1.0);
+    ASSERT_EQ(coolingLoopDeserializeState(restored, state, sizeof(state)), COOLINGLOOP_OK);
+    coolingLoopGetOutputs(restored, &second);
+    EXPECT_EQ(second.state, 2);
+    EXPECT_EQ(second.cause, 1);
+
+    state[20] ^= 1;
+    EXPECT_EQ(coolingLoopDeserializeState(restored, state, sizeof(state)), COOLINGLOOP_ERROR);
+    state[20] ^= 1;
+
+    // A cycle count that does not match the time, or a snapshot taken at another period
+    state[CHECKPOINT_SIZE + 8] ^= 1;
+    EXPECT_EQ(coolingLoopDeserializeState(restored, state, sizeof(state)), COOLINGLOOP_ERROR);
+    state[CHECKPOINT_SIZE + 8] ^= 1;
+    CoolingLoopInstance* faster = coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 0.5);
+    EXPECT_EQ(coolingLoopDeserializeState(faster, state, sizeof(state)), COOLINGLOOP_ERROR);
+    EXPECT_EQ(coolingLoopDeserializeState(restored, state, sizeof(state)), COOLINGLOOP_OK);
+    coolingLoopFreeInstance(faster);
+
+    EXPECT_EQ(coolingLoopSerializeState(restored, state, COOLINGLOOP_STATE_SIZE - 1), COOLINGLOOP_ERROR);
+    CoolingLoopInstance* other = coolingLoopInstantiate(nullptr, 0, 55.0f, 70.0f, 1.0);
+    coolingLoopSerializeState(instance, state, sizeof(state));
+    EXPECT_EQ(coolingLoopDeserializeState(other, state, sizeof(state)), COOLINGLOOP_ERROR);
+    coolingLoopFreeInstance(instance);
+    coolingLoopFreeInstance(restored);
+    coolingLoopFreeInstance(other);
+}
+
+// Test for the host contract: a bad calibration is refused, and stepping, outputs and
+// snapshots never allocate
+TEST(CoSimulationTest, StepsWithoutAllocating) {
+    CalibrationImage image = defaultCalibration();
+    CoolingLoopInstance* calibrated = coolingLoopInstantiate(&image, sizeof(image), 0.0f, 0.0f, 1.0);
+    EXPECT_NE(calibrated, nullptr);
+    coolingLoopFreeInstance(calibrated);
+    image.checksum ^= 1;
+    EXPECT_EQ(coolingLoopInstantiate(&image, sizeof(image), 0.0f, 0.0f, 1.0), nullptr);
+    EXPECT_EQ(coolingLoopInstantiate(nullptr, 0, 50.0f, 70.0f, 0.0), nullptr);
+
+    CoolingLoopInstance* instance = coolingLoopInstantiate(nullptr, 0, 0.0f, 0.0f, 0.01);
+    ASSERT_NE(instance, nullptr);
+    unsigned char state[COOLINGLOOP_STATE_SIZE];
+    CoolingLoopOutputs outputs;
+    long long before = AllocationTracker::threadAllocations();
+    for (int step = 0; step < 1000; ++step) {
+        coolingLoopSetInputs(instance, temperatureToVoltage(45.0f + static_cast<float>(step % 20)), 1, 1);
+        coolingLoopDoStep(instance, 0.004);
+        coolingLoopGetOutputs(instance, &outputs);
+        coolingLoopSerializeState(instance, state, sizeof(state));
+    }
+    coolingLoopDeserializeState(instance, state, sizeof(state));
+    EXPECT_EQ(AllocationTracker::threadAllocations(), before);
+    EXPECT_EQ(outputs.state, 1);
+    coolingLoopFreeInstance(instance);
+}
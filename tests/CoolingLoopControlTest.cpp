@@ -1,12 +1,49 @@
-#define UNIT_TEST
 #include <gtest/gtest.h>
-#include "../src/CoolingLoopControl_V1.1.cpp"
+#include <iostream>
+#include "Actuators.h"
+#include "CANBus.h"
+#include "Calibration.h"
+#include "CoolingLoopController.h"
+#include "PlantModel.h"
+#include "TemperatureSensor.h"
 
 // Test for PIDController
 TEST(PIDControllerTest, Compute) {
     PIDController pid(1.0, 0.1f, 0.01f); // Test values
     EXPECT_NEAR(pid.compute(50.0, 45.0), 5.5, 0.1);  // Example test
-    EXPECT_NEAR(pid.compute(50.0, 50.0), 0.0, 0.1);  // Edge case
+    EXPECT_NEAR(pid.compute(50.0, 50.0), 0.45, 0.1); // Edge case: integral (0.5) and derivative (-0.05) remain
+}
+
+// Test for the anti-windup: while the output is clamped the integral stops growing, so the
+// loop leaves saturation within a few dozen cycles once the error reverses
+TEST(PIDControllerTest, IntegralDoesNotWindUpWhileSaturated) {
+    const CalibrationImage& calibration = defaultCalibration();
+    PIDController pid(calibration.pumpGains[0], calibration.pumpGains[1], calibration.pumpGains[2]);
+    pid.setOutputLimits(0.0f, 100.0f);
+    float output = 0.0f;
+    for (int cycle = 0; cycle < 10000; ++cycle) {
+        output = pid.compute(50.0f, 100.0f);
+    }
+    EXPECT_EQ(output, 100.0f);
+    EXPECT_GT(pid.state().integral, -1000.0f); // -500000 without the anti-windup
+
+    int cycles = 0;
+    while (pid.compute(50.0f, 40.0f) > 0.0f && cycles < 10000) ++cycles;
+    EXPECT_LT(cycles, 100);
+}
+
+// Test for the reverse-acting gains: cooling demand above the setpoint, none below it
+TEST(PIDControllerTest, NegativeGainsAreReverseActing) {
+    const CalibrationImage& calibration = defaultCalibration();
+    for (const float* gains : {calibration.pumpGains, calibration.fanGains}) {
+        EXPECT_LT(gains[0], 0.0f);
+        PIDController hot(gains[0], gains[1], gains[2]);
+        hot.setOutputLimits(0.0f, 100.0f);
+        EXPECT_GT(hot.compute(50.0f, 55.0f), 0.0f);
+        PIDController cold(gains[0], gains[1], gains[2]);
+        cold.setOutputLimits(0.0f, 100.0f);
+        EXPECT_EQ(cold.compute(50.0f, 45.0f), 0.0f);
+    }
 }
 
 // Test for interpolateTemperature
@@ -22,3 +59,134 @@ TEST(ControlPumpTest, SpeedOutput) {
     std::string output = testing::internal::GetCapturedStdout();
     EXPECT_EQ(output, "Pump running at 50% speed.\n");
 }
+
+// Test for encodeCANFrame
+TEST(CANFrameTest, EncodesPumpAndFanSpeed) {
+    CANFrame frame = encodeCANFrame(100.0f, 50.0f);
+    EXPECT_EQ(frame.id, 0x18FF408Fu);
+    EXPECT_EQ(frame.dlc, 8);
+    EXPECT_EQ(frame.data[2], 255);
+    EXPECT_EQ(frame.data[6], 127);
+    EXPECT_EQ(frame.data[0], 0);
+}
+
+// Test for printCANFrame: both messages print in hex and leave std::cout as they found it
+TEST(CANFrameTest, PrintsWithoutChangingStreamFormat) {
+    std::ios_base::fmtflags flags = std::cout.flags();
+    testing::internal::CaptureStdout();
+    CANcontrol(100.0f, 50.0f);
+    CANderate(100.0f, 50.0f);
+    std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(output,
+              "CANID: 0x18FF408F\nMSG: 0x0 0x0 0xFF 0x0 0x0 0x0 0x7F 0x0 \n"
+              "CANID: 0x18FF418F\nMSG: 0xFF 0x7F 0x0 0x0 0x0 0x0 0x0 0x0 \n");
+    EXPECT_EQ(std::cout.flags(), flags);
+}
+
+// Test for CoolingLoopController state machine
+TEST(CoolingLoopControllerTest, IgnitionTurnsSystemOn) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    EXPECT_EQ(controller.step({2.838f, false, true}).state, SystemState::OFF);
+    EXPECT_EQ(controller.step({2.838f, true, true}).state, SystemState::ON);
+
+    const ControlOutputs& out = controller.step({2.838f, true, true});
+    EXPECT_EQ(out.state, SystemState::ON);
+    EXPECT_EQ(out.measuredTemperature, 40.0f);
+    EXPECT_EQ(out.cause, ShutdownCause::NONE);
+}
+
+TEST(CoolingLoopControllerTest, LowCoolantShutsDown) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.step({2.0f, true, true});
+    const ControlOutputs& out = controller.step({2.0f, true, false});
+    EXPECT_EQ(out.state, SystemState::SAFETY_SHUTDOWN);
+    EXPECT_EQ(out.cause, ShutdownCause::LOW_COOLANT);
+    EXPECT_EQ(out.pumpSpeed, 0.0f);
+    EXPECT_EQ(out.fanSpeed, 0.0f);
+}
+
+TEST(CoolingLoopControllerTest, OvertemperatureShutsDown) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.step({1.0f, true, true});
+    const ControlOutputs& out = controller.step({1.0f, true, true}); // 100°C
+    EXPECT_EQ(out.state, SystemState::SAFETY_SHUTDOWN);
+    EXPECT_EQ(out.cause, ShutdownCause::OVERTEMPERATURE);
+    EXPECT_EQ(out.pumpSpeed, 0.0f);
+
+    // Shutdown is latched
+    EXPECT_EQ(controller.step({3.0f, true, true}).state, SystemState::SAFETY_SHUTDOWN);
+}
+
+// Test for the reverse-acting cooling loops: demand rises above the setpoint
+TEST(CoolingLoopControllerTest, CoolsAboveSetpoint) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.step({2.838f, true, true});
+    EXPECT_EQ(controller.step({2.838f, true, true}).pumpSpeed, 0.0f); // 40°C, no demand
+    EXPECT_GT(controller.step({1.915f, true, true}).pumpSpeed, 0.0f); // 60°C
+}
+
+// Test for the control period: at a tenth of the calibration period the integral builds up
+// at the same rate per second, and the per-sample rate limit tightens with the period
+TEST(CoolingLoopControllerTest, ControlPeriodScalesPerCycleValues) {
+    CoolingLoopController slow(50.0f, 70.0f);
+    CoolingLoopController fast(50.0f, 70.0f);
+    fast.setControlPeriod(0.1f);
+    const float voltage = temperatureToVoltage(52.0f);
+    float slowPump = 0.0f;
+    float fastPump = 0.0f;
+    for (int second = 0; second < 10; ++second) {
+        slowPump = slow.step({voltage, true, true}).pumpSpeed;
+        for (int tenth = 0; tenth < 10; ++tenth) {
+            fastPump = fast.step({voltage, true, true}).pumpSpeed;
+        }
+    }
+    EXPECT_GT(slowPump, 2.0f);
+    EXPECT_NEAR(fastPump, slowPump, 1e-3f);
+
+    // A 0.3 V step is plausible within a second but not within a millisecond
+    CoolingLoopController kilohertz(50.0f, 70.0f);
+    kilohertz.setControlPeriod(0.001f);
+    kilohertz.step({voltage, true, true});
+    EXPECT_EQ(kilohertz.step({voltage - 0.3f, true, true}).sensorStatus, SensorStatus::RATE_OF_CHANGE);
+    slow.step({voltage - 0.3f, true, true});
+    EXPECT_EQ(slow.lastOutputs().sensorStatus, SensorStatus::VALID);
+
+    // ...while ±1 LSB of ADC jitter at 1 ms is not a jump
+    CoolingLoopController jittery(50.0f, 70.0f);
+    jittery.setControlPeriod(0.001f);
+    const float lsb = 5.0f / 4096.0f;
+    for (int sample = 0; sample < 1000; ++sample) {
+        float noise = static_cast<float>(sample * 7 % 3 - 1) * lsb;
+        ASSERT_EQ(jittery.step({voltage + noise, true, true}).sensorStatus, SensorStatus::VALID) << sample;
+    }
+}
+
+// Test for the linear interpolation between table entries: 60.1°C reads as 60.1°C, not as the
+// next entry (80°C) as the step table did
+TEST(InterpolateTemperatureTest, LinearBetweenEntries) {
+    EXPECT_NEAR(interpolateTemperature(temperatureToVoltage(60.1f)), 60.1f, 0.01f);
+    EXPECT_NEAR(interpolateTemperature(0.5f * (1.915f + 1.212f)), 70.0f, 1e-3f);
+    EXPECT_NEAR(interpolateTemperature(0.5f * (2.838f + 2.500f)), 45.0f, 1e-3f);
+}
+
+// Test for temperatureToVoltage round trip through the sensor table
+TEST(InterpolateTemperatureTest, TemperatureToVoltage) {
+    EXPECT_FLOAT_EQ(temperatureToVoltage(40.0f), 2.838f);
+    EXPECT_EQ(interpolateTemperature(temperatureToVoltage(60.0f)), 60.0f);
+    EXPECT_GT(temperatureToVoltage(45.0f), temperatureToVoltage(50.0f));
+}
+
+// Test for closed-loop regulation against the plant model
+TEST(PlantModelTest, ControllerHoldsBelowThreshold) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    PlantModel plant(PlantParameters{}, 25.0f);
+    float peak = plant.temperature();
+    for (int cycle = 0; cycle < 3600; ++cycle) {
+        const ControlOutputs& out = controller.step({plant.sensorVoltage(), true, true});
+        plant.step(1.0f, out.pumpSpeed, out.fanSpeed);
+        if (plant.temperature() > peak) peak = plant.temperature();
+    }
+    EXPECT_EQ(controller.state(), SystemState::ON);
+    EXPECT_LT(peak, 70.0f);
+    EXPECT_GT(plant.temperature(), 40.0f);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "CANBus.h"
+#include "Checkpoint.h"
+#include "CoolingLoopController.h"
+#include "Derating.h"
+#include "PlantModel.h"
+#include "TemperatureSensor.h"
+
+// Test for the derating curve: full power up to the setpoint, the minimum from the threshold,
+// continuous and falling in between
+TEST(DeratingTest, CurveFallsSmoothly) {
+    EXPECT_EQ(deratedPower(40.0f, 50.0f, 70.0f, 10.0f), 100.0f);
+    EXPECT_EQ(deratedPower(50.0f, 50.0f, 70.0f, 10.0f), 100.0f);
+    EXPECT_FLOAT_EQ(deratedPower(60.0f, 50.0f, 70.0f, 10.0f), 55.0f);
+    EXPECT_EQ(deratedPower(70.0f, 50.0f, 70.0f, 10.0f), 10.0f);
+    EXPECT_EQ(deratedPower(90.0f, 50.0f, 70.0f, 10.0f), 10.0f);
+
+    float previous = 100.0f;
+    for (float temperature = 50.0f; temperature <= 70.0f; temperature += 0.05f) {
+        float power = deratedPower(temperature, 50.0f, 70.0f, 0.0f);
+        ASSERT_LE(power, previous);
+        ASSERT_LT(previous - power, 0.5f) << temperature; // No steps
+        previous = power;
+    }
+    EXPECT_GT(deratedPower(51.0f, 50.0f, 70.0f, 0.0f), 99.0f); // Regulation overshoot costs little
+}
+
+// Test for the controller: no shutdown past the threshold, full cooling while derating and
+// a rate-limited recovery
+TEST(DeratingTest, ControllerDeratesInsteadOfShuttingDown) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableDerating(DerateLimits{});
+    // 1 °C per cycle keeps every sample within the plausible rate of change
+    auto rampTo = [&controller](float from, float to) {
+        float step = to > from ? 1.0f : -1.0f;
+        for (float temperature = from; (to - temperature) * step > 0.0f; temperature += step) {
+            controller.step({temperatureToVoltage(temperature), true, true});
+        }
+        return controller.step({temperatureToVoltage(to), true, true});
+    };
+    EXPECT_EQ(rampTo(45.0f, 45.0f).allowedPower, 100.0f);
+
+    ControlOutputs hot = rampTo(45.0f, 60.0f);
+    EXPECT_EQ(hot.state, SystemState::ON);
+    EXPECT_FLOAT_EQ(hot.allowedPower, 50.0f);
+    EXPECT_EQ(hot.pumpSpeed, 100.0f);
+    EXPECT_EQ(hot.fanSpeed, 100.0f);
+
+    ControlOutputs over = rampTo(60.0f, 80.0f);
+    EXPECT_EQ(over.state, SystemState::ON);
+    EXPECT_EQ(over.cause, ShutdownCause::NONE);
+    EXPECT_EQ(over.allowedPower, 0.0f);
+    EXPECT_EQ(over.pumpSpeed, 100.0f);
+
+    // Cooled down: power comes back at 2 % per cycle
+    ControlOutputs cooled = rampTo(80.0f, 45.0f);
+    EXPECT_LT(cooled.allowedPower, 100.0f);
+    EXPECT_EQ(cooled.pumpSpeed, 100.0f);
+    EXPECT_FLOAT_EQ(controller.step({temperatureToVoltage(45.0f), true, true}).allowedPower,
+                    cooled.allowedPower + 2.0f);
+
+    // Low coolant still shuts down, and takes the power with it
+    const ControlOutputs& dry = controller.step({temperatureToVoltage(45.0f), true, false});
+    EXPECT_EQ(dry.state, SystemState::SAFETY_SHUTDOWN);
+    EXPECT_EQ(dry.allowedPower, 0.0f);
+}
+
+// Test for the closed loop: a heat load the cooling cannot carry settles at reduced power
+// below the threshold, where the hard shutdown would have stopped the vehicle
+TEST(DeratingTest, ClosedLoopSettlesAtReducedPower) {
+    PlantParameters parameters;
+    parameters.heatLoad = 12000.0f;
+    CoolingLoopController legacy(50.0f, 70.0f);
+    CoolingLoopController derating(50.0f, 70.0f);
+    derating.enableDerating(DerateLimits{});
+    PlantModel legacyPlant(parameters, 45.0f);
+    PlantModel deratingPlant(parameters, 45.0f);
+
+    const ControlOutputs* out = nullptr;
+    for (int cycle = 0; cycle < 3600; ++cycle) {
+        const ControlOutputs& l = legacy.step({legacyPlant.sensorVoltage(), true, true});
+        legacyPlant.step(1.0f, l.pumpSpeed, l.fanSpeed);
+        out = &derating.step({deratingPlant.sensorVoltage(), true, true});
+        deratingPlant.setHeatLoad(parameters.heatLoad * out->allowedPower / 100.0f);
+        deratingPlant.step(1.0f, out->pumpSpeed, out->fanSpeed);
+        ASSERT_EQ(out->state, SystemState::ON) << cycle;
+    }
+    EXPECT_EQ(legacy.state(), SystemState::SAFETY_SHUTDOWN);
+    EXPECT_LT(deratingPlant.temperature(), 70.0f);
+    EXPECT_GT(out->allowedPower, 10.0f);
+    EXPECT_LT(out->allowedPower, 100.0f);
+}
+
+// Test for the last-resort trip: with the inverter ignoring the limit and the pump failed,
+// the coolant keeps rising and the overtemperature shutdown latches at the trip margin
+TEST(DeratingTest, TripsWhenDeratingCannotCool) {
+    PlantParameters parameters;
+    parameters.heatLoad = 6000.0f;
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableDerating(DerateLimits{});
+    PlantModel plant(parameters, 45.0f);
+    for (int cycle = 0; cycle < 3600; ++cycle) {
+        if (controller.step({plant.sensorVoltage(), true, true}).state != SystemState::ON) break;
+        plant.step(1.0f, 0.0f, 0.0f); // Pump and fan dead, full load regardless
+        ASSERT_LT(plant.temperature(), 85.0f) << cycle;
+    }
+    const ControlOutputs& out = controller.lastOutputs();
+    EXPECT_EQ(out.state, SystemState::SAFETY_SHUTDOWN);
+    EXPECT_EQ(out.cause, ShutdownCause::OVERTEMPERATURE);
+    EXPECT_GT(out.measuredTemperature, 70.0f + DerateLimits{}.tripMargin);
+
+    // Likewise in afterrun, where there is nothing to derate
+    CoolingLoopController parked(50.0f, 70.0f);
+    parked.enableDerating(DerateLimits{});
+    parked.enableAfterrun(AfterrunLimits{});
+    parked.step({temperatureToVoltage(68.0f), true, true});
+    ASSERT_EQ(parked.step({temperatureToVoltage(68.0f), false, true}).state, SystemState::AFTERRUN);
+    for (float temperature = 69.0f; temperature <= 82.0f; temperature += 1.0f) {
+        parked.step({temperatureToVoltage(temperature), false, true});
+        if (temperature <= 80.0f) {
+            ASSERT_EQ(parked.state(), SystemState::AFTERRUN) << temperature;
+        }
+    }
+    EXPECT_EQ(parked.state(), SystemState::SAFETY_SHUTDOWN);
+}
+
+// Test for the derating message and its checkpoint field
+TEST(DeratingTest, FrameAndCheckpoint) {
+    CANFrame frame = encodeDerateFrame(100.0f, 40.0f);
+    EXPECT_EQ(frame.id, 0x18FF418Fu);
+    EXPECT_EQ(frame.data[0], 255);
+    EXPECT_EQ(frame.data[1], 102);
+    float inverter = 0.0f;
+    float dcdc = 0.0f;
+    decodeDerateFrame(frame, inverter, dcdc);
+    EXPECT_FLOAT_EQ(inverter, 100.0f);
+    EXPECT_LE(dcdc, 40.0f); // Rounded down, never above the limit
+    EXPECT_GT(dcdc, 39.5f);
+
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.enableDerating(DerateLimits{});
+    controller.step({temperatureToVoltage(65.0f), true, true});
+    unsigned char snapshot[CHECKPOINT_SIZE];
+    ASSERT_EQ(controller.saveCheckpoint(snapshot, sizeof(snapshot)), CHECKPOINT_SIZE);
+    CoolingLoopController restored(50.0f, 70.0f);
+    restored.enableDerating(DerateLimits{});
+    ASSERT_TRUE(restored.restoreCheckpoint(snapshot, sizeof(snapshot)));
+    EXPECT_EQ(restored.lastOutputs().allowedPower, controller.lastOutputs().allowedPower);
+    SensorInputs cool{temperatureToVoltage(45.0f), true, true};
+    EXPECT_EQ(restored.step(cool).allowedPower, controller.step(cool).allowedPower);
+}
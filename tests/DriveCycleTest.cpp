@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "DriveCycle.h"
+
+namespace {
+
+std::string writeFile(const std::string& name, const std::string& text) {
+    std::string path = testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << text;
+    return path;
+}
+
+} // namespace
+
+// Test for the CSV reader: header, comments, blank lines and CRLF are skipped
+TEST(DriveCycleTest, ReadsCsv) {
+    std::string path = writeFile("coolingloop_cycle.csv",
+                                 "# recorded cycle\r\ntime,speed,inverter,dcdc,ambient\r\n"
+                                 "0, 0, 150, 350, 25\r\n\r\n10,50.5,1200,350,26.5\r\n20,80,2000,400,27");
+    DriveCycleReader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(path.c_str(), error)) << error;
+    EXPECT_FALSE(reader.binary());
+
+    DriveCycleSample sample;
+    ASSERT_TRUE(reader.next(sample));
+    EXPECT_EQ(sample.time, 0.0);
+    EXPECT_EQ(sample.dcdcLoss, 350.0f);
+    ASSERT_TRUE(reader.next(sample));
+    EXPECT_EQ(sample.time, 10.0);
+    EXPECT_EQ(sample.speed, 50.5f);
+    EXPECT_EQ(sample.inverterLoss, 1200.0f);
+    EXPECT_EQ(sample.ambient, 26.5f);
+    ASSERT_TRUE(reader.next(sample)); // Last line without a newline
+    EXPECT_EQ(sample.dcdcLoss, 400.0f);
+    EXPECT_FALSE(reader.next(sample));
+    EXPECT_TRUE(reader.error().empty());
+    EXPECT_EQ(reader.position(), 3u);
+    reader.close();
+    std::remove(path.c_str());
+}
+
+// Test for malformed files: bad fields, time going backwards, damaged binary files
+TEST(DriveCycleTest, RejectsMalformedFiles) {
+    DriveCycleReader reader;
+    DriveCycleSample sample;
+    std::string error;
+
+    std::string path = writeFile("coolingloop_bad.csv", "0,0,150,350,25\n1,0,150,x,25\n");
+    ASSERT_TRUE(reader.open(path.c_str(), error));
+    EXPECT_TRUE(reader.next(sample));
+    EXPECT_FALSE(reader.next(sample));
+    EXPECT_NE(reader.error().find("sample 2"), std::string::npos);
+    EXPECT_FALSE(reader.next(sample)); // Stays failed
+
+    path = writeFile("coolingloop_bad.csv", "0,0,150,350,25\n5,0,150,350,25,9\n");
+    ASSERT_TRUE(reader.open(path.c_str(), error));
+    EXPECT_TRUE(reader.next(sample));
+    EXPECT_FALSE(reader.next(sample));
+    EXPECT_FALSE(reader.error().empty());
+
+    path = writeFile("coolingloop_bad.csv", "0,0,150,350,25\n5,0,150,350,25\n5,0,150,350,25\n");
+    ASSERT_TRUE(reader.open(path.c_str(), error));
+    EXPECT_TRUE(reader.next(sample));
+    EXPECT_TRUE(reader.next(sample));
+    EXPECT_FALSE(reader.next(sample));
+    EXPECT_NE(reader.error().find("time does not increase"), std::string::npos);
+    std::remove(path.c_str());
+
+    // Binary file cut short
+    path = testing::TempDir() + "coolingloop_bad.dcb";
+    DriveCycleWriter writer;
+    ASSERT_TRUE(writer.open(path.c_str()));
+    ASSERT_TRUE(writer.write({0.0, 0.0f, 100.0f, 100.0f, 20.0f}));
+    ASSERT_TRUE(writer.close());
+    ASSERT_TRUE(reader.open(path.c_str(), error));
+    std::ofstream(path, std::ios::binary | std::ios::app) << "x";
+    EXPECT_FALSE(reader.open(path.c_str(), error));
+    EXPECT_FALSE(reader.open((path + ".missing").c_str(), error));
+    std::remove(path.c_str());
+}
+
+// Test for the binary column format: same samples back across block boundaries
+TEST(DriveCycleTest, BinaryRoundTrip) {
+    std::string path = testing::TempDir() + "coolingloop_cycle.dcb";
+    const int count = 2 * static_cast<int>(DRIVE_CYCLE_BLOCK) + 123;
+    DriveCycleWriter writer;
+    ASSERT_TRUE(writer.open(path.c_str()));
+    for (int i = 0; i < count; ++i) {
+        float f = static_cast<float>(i);
+        ASSERT_TRUE(writer.write({0.1 * i + 1e6, f * 0.01f, 1000.0f + f, 300.0f - f * 0.001f, 20.0f + f * 1e-4f}));
+    }
+    ASSERT_TRUE(writer.close());
+
+    DriveCycleReader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(path.c_str(), error)) << error;
+    EXPECT_TRUE(reader.binary());
+    DriveCycleSample sample;
+    for (int i = 0; i < count; ++i) {
+        float f = static_cast<float>(i);
+        ASSERT_TRUE(reader.next(sample)) << i;
+        ASSERT_EQ(sample.time, 0.1 * i + 1e6);
+        ASSERT_EQ(sample.speed, f * 0.01f);
+        ASSERT_EQ(sample.inverterLoss, 1000.0f + f);
+        ASSERT_EQ(sample.dcdcLoss, 300.0f - f * 0.001f);
+        ASSERT_EQ(sample.ambient, 20.0f + f * 1e-4f);
+    }
+    EXPECT_FALSE(reader.next(sample));
+    EXPECT_TRUE(reader.error().empty());
+    reader.close();
+    std::remove(path.c_str());
+}
+
+// Test for a crafted binary header: a sample count whose size computation wraps around to
+// the real file size is rejected, not read past the end
+TEST(DriveCycleTest, RejectsOverflowingSampleCount) {
+    std::string path = testing::TempDir() + "coolingloop_crafted.dcb";
+    DriveCycleWriter writer;
+    ASSERT_TRUE(writer.open(path.c_str()));
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(writer.write({static_cast<double>(i), 0.0f, 1000.0f, 300.0f, 20.0f}));
+    }
+    ASSERT_TRUE(writer.close());
+
+    // 2^49 + 1 blocks times the block size is one block modulo 2^64
+    std::FILE* file = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    DriveCycleHeader header;
+    ASSERT_EQ(std::fread(&header, sizeof(header), 1, file), 1u);
+    header.samples = (std::uint64_t{1} << 61) + DRIVE_CYCLE_BLOCK;
+    std::fseek(file, 0, SEEK_SET);
+    ASSERT_EQ(std::fwrite(&header, sizeof(header), 1, file), 1u);
+    std::fclose(file);
+
+    DriveCycleReader reader;
+    std::string error;
+    EXPECT_FALSE(reader.open(path.c_str(), error));
+    EXPECT_NE(error.find("damaged"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+// Test for interpolation to the control rate: linear between samples, held before the first,
+// over after the last
+TEST(DriveCycleTest, InterpolatesToControlRate) {
+    std::string path = writeFile("coolingloop_cycle.csv", "10,0,1000,200,20\n20,100,3000,400,30\n30,0,1000,200,20\n");
+    DriveCycleProfile profile;
+    std::string error;
+    ASSERT_TRUE(profile.open(path.c_str(), error)) << error;
+
+    DriveCycleSample sample;
+    ASSERT_TRUE(profile.at(0.0, sample));
+    EXPECT_EQ(sample.inverterLoss, 1000.0f);
+    EXPECT_EQ(sample.time, 0.0);
+    ASSERT_TRUE(profile.at(15.0, sample));
+    EXPECT_FLOAT_EQ(sample.speed, 50.0f);
+    EXPECT_FLOAT_EQ(sample.inverterLoss + sample.dcdcLoss, 2300.0f);
+    EXPECT_FLOAT_EQ(sample.ambient, 25.0f);
+    ASSERT_TRUE(profile.at(20.0, sample));
+    EXPECT_EQ(sample.speed, 100.0f);
+    ASSERT_TRUE(profile.at(27.5, sample));
+    EXPECT_FLOAT_EQ(sample.speed, 25.0f);
+    ASSERT_TRUE(profile.at(30.0, sample));
+    EXPECT_EQ(sample.speed, 0.0f);
+    EXPECT_FALSE(profile.at(30.5, sample));
+    EXPECT_TRUE(profile.error().empty());
+
+    std::string empty = writeFile("coolingloop_empty.csv", "time,speed,inverter,dcdc,ambient\n");
+    EXPECT_FALSE(profile.open(empty.c_str(), error));
+    EXPECT_NE(error.find("no samples"), std::string::npos);
+    std::remove(path.c_str());
+    std::remove(empty.c_str());
+}
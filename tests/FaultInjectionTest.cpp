@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include "FaultInjection.h"
+
+namespace {
+
+FaultScenario parse(const char* text) {
+    std::istringstream in(text);
+    FaultScenario scenario;
+    std::string error;
+    EXPECT_TRUE(parseFaultScenario(in, scenario, error)) << error;
+    return scenario;
+}
+
+} // namespace
+
+// Test for parseFaultScenario
+TEST(FaultScenarioTest, ParsesFaultsAndExpectations) {
+    FaultScenario scenario = parse(
+        "# comment\n"
+        "name demo\n"
+        "cycles 100\n"
+        "load 3000\n"
+        "fault open_circuit start=10 duration=5 value=4.9\n"
+        "fault can_frame_loss start=20 period=3\n"
+        "expect reach=OVERTEMP_SHUTDOWN within=2\n");
+
+    EXPECT_EQ(scenario.name, "demo");
+    EXPECT_EQ(scenario.cycles, 100);
+    EXPECT_EQ(scenario.heatLoad, 3000.0f);
+    ASSERT_EQ(scenario.faults.size(), 2u);
+    EXPECT_EQ(scenario.faults[0].type, FaultType::OPEN_CIRCUIT);
+    EXPECT_EQ(scenario.faults[0].value, 4.9f);
+    EXPECT_EQ(scenario.faults[1].duration, -1);
+    EXPECT_EQ(scenario.faults[1].period, 3);
+    ASSERT_EQ(scenario.expectations.size(), 1u);
+    EXPECT_EQ(scenario.expectations[0].reach, FaultOutcome::OVERTEMP_SHUTDOWN);
+    EXPECT_EQ(scenario.expectations[0].within, 2);
+}
+
+TEST(FaultScenarioTest, ParsesSensorChannels) {
+    FaultScenario scenario = parse(
+        "sensors 3\n"
+        "fault stuck_sensor channel=2 start=5 value=1.0\n");
+    EXPECT_EQ(scenario.sensors, 3);
+    ASSERT_EQ(scenario.faults.size(), 1u);
+    EXPECT_EQ(scenario.faults[0].channel, 2);
+
+    std::istringstream in("fault open_circuit channel=3\n");
+    std::string error;
+    EXPECT_FALSE(parseFaultScenario(in, scenario, error));
+}
+
+TEST(FaultScenarioTest, ReportsBadLines) {
+    std::istringstream in("cycles 10\nfault melted_pump start=1\n");
+    FaultScenario scenario;
+    std::string error;
+    EXPECT_FALSE(parseFaultScenario(in, scenario, error));
+    EXPECT_NE(error.find("line 2"), std::string::npos);
+}
+
+// Test for FaultInjector on the sensor and CAN paths
+TEST(FaultInjectorTest, AppliesActiveFaultsOnly) {
+    std::vector<FaultSpec> faults = {
+        {FaultType::OPEN_CIRCUIT, 10, 5, NAN, 1},
+        {FaultType::LEVEL_CHATTER, 20, 4, NAN, 2},
+        {FaultType::CAN_FRAME_LOSS, 30, 6, NAN, 3},
+    };
+    FaultInjector injector(faults);
+    SensorInputs sampled{2.5f, true, true};
+
+    EXPECT_EQ(injector.applySensorFaults(9, sampled).sensorVoltage, 2.5f);
+    EXPECT_EQ(injector.applySensorFaults(10, sampled).sensorVoltage, 5.0f);
+    EXPECT_EQ(injector.applySensorFaults(15, sampled).sensorVoltage, 2.5f);
+
+    EXPECT_FALSE(injector.applySensorFaults(20, sampled).levelSwitch);
+    EXPECT_FALSE(injector.applySensorFaults(21, sampled).levelSwitch);
+    EXPECT_TRUE(injector.applySensorFaults(22, sampled).levelSwitch);
+
+    EXPECT_TRUE(injector.dropCANFrame(30));
+    EXPECT_FALSE(injector.dropCANFrame(31));
+    EXPECT_TRUE(injector.dropCANFrame(33));
+    EXPECT_FALSE(injector.dropCANFrame(36));
+}
+
+// Test for runFaultScenario: the level check reacts to chatter in the same cycle
+TEST(FaultInjectorTest, LevelChatterShutsDownImmediately) {
+    FaultScenario scenario = parse(
+        "cycles 600\n"
+        "fault level_chatter start=100 duration=10 period=2\n"
+        "expect reach=LOW_COOLANT_SHUTDOWN within=0\n");
+    FaultRunResult result = runFaultScenario(scenario);
+
+    EXPECT_TRUE(result.passed) << result.failure;
+    EXPECT_EQ(result.firstFault, 100);
+    EXPECT_EQ(result.reachedAt[static_cast<int>(FaultOutcome::LOW_COOLANT_SHUTDOWN)], 100);
+    EXPECT_EQ(result.finalOutputs.state, SystemState::SAFETY_SHUTDOWN);
+}
+
+TEST(FaultInjectorTest, UnmetExpectationFails) {
+    FaultScenario scenario = parse(
+        "cycles 200\n"
+        "fault ignition_glitch start=50 duration=2\n"
+        "expect reach=OVERTEMP_SHUTDOWN\n");
+    FaultRunResult result = runFaultScenario(scenario);
+
+    EXPECT_FALSE(result.passed);
+    EXPECT_NE(result.failure.find("never reached OVERTEMP_SHUTDOWN"), std::string::npos);
+}
+
+// Test for FaultInjector on the plant: degradations ramp over their duration and stay
+TEST(FaultInjectorTest, RampsPlantDegradation) {
+    FaultScenario scenario = parse(
+        "fault filter_clog start=100 duration=100 value=5\n"
+        "fault pump_wear start=150 duration=0\n");
+    FaultInjector injector(scenario.faults);
+    PlantModel plant(PlantParameters{}, 50.0f);
+
+    injector.applyPlantFaults(99, plant);
+    plant.step(1.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(plant.pumpRpm(), 6000.0f);
+    float cleanRise = plant.temperature() - plant.inletTemperature();
+
+    injector.applyPlantFaults(150, plant); // Resistance 3 (half way), pump at 70% speed
+    plant.step(1.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(plant.pumpRpm(), 4200.0f);
+    EXPECT_NEAR(plant.temperature() - plant.inletTemperature(), cleanRise * std::sqrt(3.0f) / 0.7f, 1e-3f);
+
+    injector.applyPlantFaults(5000, plant); // Resistance 5 for good
+    plant.step(1.0f, 100.0f, 100.0f);
+    EXPECT_NEAR(plant.temperature() - plant.inletTemperature(), cleanRise * std::sqrt(5.0f) / 0.7f, 1e-3f);
+}
+
+// Test for runFaultScenario at a shorter step: the controller is retuned to the step, so the
+// loop settles as it does at 1 s
+TEST(FaultInjectorTest, ControlsAtScenarioStep) {
+    FaultScenario coarse = parse("cycles 900\nload 3000\n");
+    FaultScenario fine = parse("cycles 9000\nload 3000\ndt 0.1\n");
+    FaultRunResult coarseResult = runFaultScenario(coarse);
+    FaultRunResult fineResult = runFaultScenario(fine);
+
+    EXPECT_NEAR(fineResult.peakTemperature, coarseResult.peakTemperature, 0.5f);
+    EXPECT_NEAR(fineResult.finalOutputs.pumpSpeed, coarseResult.finalOutputs.pumpSpeed, 2.0f);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "FleetRuntime.h"
+
+// Test for the sharded run: same aggregates as stepping every loop on one thread
+TEST(FleetRuntimeTest, MatchesSerialStepping) {
+    FleetOptions options;
+    options.loops = 1001;
+    options.shards = 4;
+    options.threshold = 60.0f; // Low enough that the hill climb shuts some loops down
+    const long cycles = 1500;
+
+    FleetRuntime fleet;
+    ASSERT_TRUE(fleet.start(options));
+    fleet.run(1000);
+    fleet.run(cycles - 1000); // Runs continue where the last one stopped
+    FleetSummary summary = fleet.summary();
+
+    std::uint64_t shutdowns = 0;
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < options.loops; ++i) {
+        FleetLoop loop(options, i);
+        for (long c = 0; c < cycles; ++c) {
+            shutdowns += loop.step(static_cast<float>(c) * options.dt, options.dt);
+            peak = std::max(peak, loop.plant.temperature());
+        }
+    }
+    EXPECT_EQ(summary.loopCycles, options.loops * cycles);
+    EXPECT_GT(summary.shutdowns, 0u);
+    EXPECT_EQ(summary.shutdowns, shutdowns);
+    EXPECT_EQ(summary.peakTemperature, peak);
+}
+
+// Test for deterministic mode: bit-identical aggregates for 1, 3 and 64 shards, with every
+// loop drawing its own heat load noise
+TEST(FleetRuntimeTest, DeterministicAggregatesIndependentOfShards) {
+    FleetOptions options;
+    options.loops = 4 * FLEET_BLOCK + 77;
+    options.pin = false;
+    options.deterministic = true;
+    options.loadNoise = 0.2f;
+    options.seed = 42;
+    options.threshold = 60.0f;
+
+    FleetSummary summaries[3];
+    const int shardCounts[3] = {1, 3, 64};
+    for (int r = 0; r < 3; ++r) {
+        options.shards = shardCounts[r];
+        FleetRuntime fleet;
+        ASSERT_TRUE(fleet.start(options));
+        fleet.run(400);
+        fleet.run(400);
+        summaries[r] = fleet.summary();
+    }
+    EXPECT_GT(summaries[0].shutdowns, 0u);
+    for (int r = 1; r < 3; ++r) {
+        EXPECT_EQ(summaries[r].loopCycles, summaries[0].loopCycles);
+        EXPECT_EQ(summaries[r].shutdowns, summaries[0].shutdowns);
+        EXPECT_EQ(summaries[r].peakTemperature, summaries[0].peakTemperature);
+        EXPECT_EQ(summaries[r].heatEnergy, summaries[0].heatEnergy) << shardCounts[r] << " shards";
+    }
+
+    // Same total as stepping the loops one by one
+    double energy = 0.0;
+    for (std::size_t i = 0; i < options.loops; ++i) {
+        FleetLoop loop(options, i);
+        for (long c = 0; c < 800; ++c) loop.step(static_cast<float>(c) * options.dt, options.dt);
+        energy += loop.energy;
+    }
+    EXPECT_NEAR(summaries[0].heatEnergy, energy, 1e-9 * energy);
+}
+
+// Test for the random streams: every loop draws its own uniform sequence, repeatable from the seed
+TEST(FleetRuntimeTest, LoopStreamsAreDistinctAndRepeatable) {
+    FleetOptions options;
+    FleetLoop a(options, 0);
+    FleetLoop b(options, 1);
+    FleetLoop again(options, 0);
+    double mean = 0.0;
+    int same = 0;
+    for (int i = 0; i < 10000; ++i) {
+        float x = a.nextUniform();
+        ASSERT_GE(x, -1.0f);
+        ASSERT_LT(x, 1.0f);
+        EXPECT_EQ(again.nextUniform(), x);
+        same += b.nextUniform() == x;
+        mean += x;
+    }
+    EXPECT_LT(same, 5);
+    EXPECT_NEAR(mean / 10000.0, 0.0, 0.03);
+}
+
+// Test for the shard layout: contiguous ranges covering the fleet, nodes and CPUs from the topology
+TEST(FleetRuntimeTest, ShardsCoverFleetOnKnownNodes) {
+    std::vector<NumaNode> nodes = numaNodes();
+    ASSERT_FALSE(nodes.empty());
+    FleetOptions options;
+    options.loops = 10;
+    options.shards = 3;
+    options.nodes = 1;
+
+    FleetRuntime fleet;
+    ASSERT_TRUE(fleet.start(options));
+    EXPECT_EQ(fleet.nodeCount(), 1);
+    ASSERT_EQ(fleet.shardCount(), 3);
+    std::size_t total = 0;
+    for (int s = 0; s < fleet.shardCount(); ++s) {
+        total += fleet.shardLoops(s);
+        EXPECT_EQ(fleet.shardNode(s), nodes[0].id);
+        if (fleet.shardCpu(s) >= 0) {
+            EXPECT_NE(std::find(nodes[0].cpus.begin(), nodes[0].cpus.end(), fleet.shardCpu(s)), nodes[0].cpus.end());
+        }
+    }
+    EXPECT_EQ(total, options.loops);
+
+    // More shards than loops: the empty ones take part without stepping anything
+    options.loops = 2;
+    options.shards = 5;
+    options.pin = false;
+    ASSERT_TRUE(fleet.start(options));
+    fleet.run(10);
+    EXPECT_EQ(fleet.summary().loopCycles, 20u);
+    EXPECT_EQ(fleet.shardCpu(0), -1);
+    fleet.stop();
+    EXPECT_EQ(fleet.shardCount(), 0);
+}
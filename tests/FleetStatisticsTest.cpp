@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "FleetStatistics.h"
+
+namespace {
+
+// Fleet of loops running at a steady 2 kW with noisy pump duty around dutyPerKw %/kW
+struct Fleet {
+    std::vector<float> duty;
+    std::vector<float> load;
+    std::vector<float> dutyPerKw;
+    std::mt19937 random{7};
+    std::normal_distribution<float> noise{0.0f, 0.03f};
+
+    explicit Fleet(std::size_t loops) : duty(loops), load(loops, 2000.0f), dutyPerKw(loops) {
+        for (std::size_t i = 0; i < loops; ++i) {
+            dutyPerKw[i] = 10.0f + static_cast<float>(i % 13); // Every vehicle has its own level
+        }
+    }
+
+    void cycle(FleetStatistics& statistics) {
+        for (std::size_t i = 0; i < duty.size(); ++i) {
+            duty[i] = dutyPerKw[i] * (1.0f + noise(random)) * load[i] / 1000.0f;
+        }
+        statistics.update(duty.data(), load.data());
+    }
+};
+
+} // namespace
+
+// Test for the reference: Welford matches the two-pass mean and sample variance
+TEST(FleetStatisticsTest, ReferenceMatchesTwoPassStatistics) {
+    FleetStatisticsLimits limits;
+    limits.baselineSamples = 500.0f;
+    FleetStatistics statistics(1, limits);
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> duty(20.0f, 60.0f);
+    const float load = 2500.0f;
+
+    std::vector<double> ratios;
+    for (int i = 0; i < 800; ++i) {
+        float value = duty(random);
+        if (i < 500) {
+            ratios.push_back(value * 1000.0 / load); // Later samples are not part of the reference
+        }
+        statistics.update(&value, &load);
+    }
+    double mean = 0.0;
+    for (double r : ratios) mean += r;
+    mean /= ratios.size();
+    double variance = 0.0;
+    for (double r : ratios) variance += (r - mean) * (r - mean);
+    variance /= ratios.size() - 1;
+
+    EXPECT_FLOAT_EQ(statistics.samples(0), 500.0f);
+    EXPECT_NEAR(statistics.baseline(0), mean, 1e-3);
+    EXPECT_NEAR(statistics.deviation(0), std::sqrt(variance), 1e-3);
+}
+
+// Test for the detector: a loop whose duty creeps up for the same load tops the report
+TEST(FleetStatisticsTest, ReportsDriftingLoopFirst) {
+    const std::size_t loops = 1000;
+    const std::size_t drifting = 417;
+    FleetStatistics statistics(loops);
+    Fleet fleet(loops);
+    for (int cycle = 0; cycle < 600; ++cycle) {
+        fleet.cycle(statistics);
+    }
+    // 6% more duty for the same heat load: two standard deviations of the noise
+    fleet.dutyPerKw[drifting] *= 1.06f;
+    for (int cycle = 0; cycle < 300; ++cycle) {
+        fleet.cycle(statistics);
+    }
+
+    FleetAnomaly report[5];
+    ASSERT_EQ(statistics.topAnomalies(report, 5), 5u);
+    EXPECT_EQ(report[0].loop, drifting);
+    EXPECT_TRUE(statistics.anomalous(drifting));
+    EXPECT_GT(report[0].drift, 1.0f);
+    EXPECT_NEAR(report[0].current / report[0].baseline, 1.06f, 0.01f);
+    for (int i = 1; i < 5; ++i) {
+        EXPECT_GE(report[i - 1].score, report[i].score);
+        EXPECT_FALSE(statistics.anomalous(report[i].loop)) << report[i].loop;
+    }
+}
+
+// Test for light loads: samples below minHeatLoad leave the loop unchanged
+TEST(FleetStatisticsTest, IgnoresLightLoads) {
+    FleetStatisticsLimits limits;
+    FleetStatistics statistics(2, limits);
+    const float duty[2] = {30.0f, 30.0f};
+    const float load[2] = {limits.minHeatLoad - 1.0f, 1500.0f};
+    for (int i = 0; i < 10; ++i) {
+        statistics.update(duty, load);
+    }
+    EXPECT_EQ(statistics.samples(0), 0.0f);
+    EXPECT_EQ(statistics.current(0), 0.0f);
+    EXPECT_EQ(statistics.samples(1), 10.0f);
+    EXPECT_FLOAT_EQ(statistics.current(1), 20.0f);
+}
+
+// Test for topAnomalies and reset: ordering, ties by loop, zero scores left out
+TEST(FleetStatisticsTest, TopAnomaliesOrderAndReset) {
+    FleetStatisticsLimits limits;
+    limits.baselineSamples = 10.0f;
+    const std::size_t loops = 6;
+    FleetStatistics statistics(loops, limits);
+    std::vector<float> duty(loops, 20.0f);
+    std::vector<float> load(loops, 1000.0f);
+    for (int i = 0; i < 10; ++i) {
+        statistics.update(duty.data(), load.data());
+    }
+    // Shifts of 0, 2, 4, 4, 0 and -4 reference deviations (the 2% floor)
+    const float shift[loops] = {0.0f, 0.04f, 0.08f, 0.08f, 0.0f, -0.08f};
+    for (std::size_t i = 0; i < loops; ++i) {
+        duty[i] = 20.0f * (1.0f + shift[i]);
+    }
+    statistics.update(duty.data(), load.data());
+
+    FleetAnomaly report[8];
+    ASSERT_EQ(statistics.topAnomalies(report, 8), 4u);
+    EXPECT_EQ(report[0].loop, 2u);
+    EXPECT_EQ(report[1].loop, 3u);
+    EXPECT_EQ(report[2].loop, 5u);
+    EXPECT_EQ(report[3].loop, 1u);
+    EXPECT_NEAR(report[0].score, 3.5f, 1e-3f);
+    EXPECT_NEAR(report[3].score, 1.5f, 1e-3f);
+    ASSERT_EQ(statistics.topAnomalies(report, 2), 2u);
+    EXPECT_EQ(report[1].loop, 3u);
+
+    statistics.reset(2);
+    EXPECT_EQ(statistics.score(2), 0.0f);
+    EXPECT_EQ(statistics.samples(2), 0.0f);
+    ASSERT_EQ(statistics.topAnomalies(report, 1), 1u);
+    EXPECT_EQ(report[0].loop, 3u);
+}
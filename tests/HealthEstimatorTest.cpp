@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "CoolingLoopController.h"
+#include "HealthEstimator.h"
+#include "PlantModel.h"
+
+namespace {
+
+HealthSample sample(const PlantModel& plant, float pumpCommand) {
+    return {pumpCommand, plant.pumpRpm(), plant.inletTemperature(), plant.temperature(), plant.heatLoad()};
+}
+
+// Run the controller closed-loop and feed every cycle to the estimator
+void run(PlantModel& plant, HealthState& health, const HealthLimits& limits, int cycles) {
+    CoolingLoopController controller(50.0f, 130.0f);
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        const ControlOutputs& out = controller.step({plant.sensorVoltage(), true, true});
+        plant.step(1.0f, out.pumpSpeed, out.fanSpeed);
+        updateHealth(health, sample(plant, out.pumpSpeed), limits);
+    }
+}
+
+} // namespace
+
+// Test for updateHealth: both fits converge to the plant's real degradation
+TEST(HealthEstimatorTest, TracksFilterResistanceAndPumpSpeed) {
+    HealthLimits limits;
+    PlantParameters parameters;
+    parameters.heatLoad = 3000.0f;
+    parameters.filterResistance = 2.0f;
+    parameters.pumpWear = 0.1f;
+    PlantModel plant(parameters, 45.0f);
+    HealthState health(limits);
+    run(plant, health, limits, 1200);
+
+    EXPECT_NEAR(health.pumpSpeedRatio.theta, 0.9f, 0.01f);
+    EXPECT_NEAR(health.filterResistance(limits), 2.0f, 0.05f);
+    EXPECT_EQ(health.flags, FILTER_CLOGGED); // 90% speed is still within the pump limit
+}
+
+// Test for the sample rate: fed every healthSampleEvery() cycles, a loop at a 10 ms period
+// raises the clogging flag after as many seconds as one at 1 s, and no sooner than minSamples
+TEST(HealthEstimatorTest, FlagsAfterSameTimeAtAnyPeriod) {
+    EXPECT_EQ(healthSampleEvery(1.0f), 1u);
+    EXPECT_EQ(healthSampleEvery(5.0f), 1u);
+    EXPECT_EQ(healthSampleEvery(0.001f), 1000u);
+
+    auto secondsToFlag = [](float period) {
+        HealthLimits limits;
+        PlantParameters parameters;
+        parameters.heatLoad = 3000.0f;
+        parameters.filterResistance = 2.0f;
+        PlantModel plant(parameters, 45.0f);
+        HealthState health(limits);
+        CoolingLoopController controller(50.0f, 130.0f);
+        controller.setControlPeriod(period);
+        const std::uint32_t every = healthSampleEvery(period);
+        for (std::uint32_t cycle = 1; cycle <= 1200 * every; ++cycle) {
+            const ControlOutputs& out = controller.step({plant.sensorVoltage(), true, true});
+            plant.step(period, out.pumpSpeed, out.fanSpeed);
+            if (cycle % every == 0) {
+                updateHealth(health, sample(plant, out.pumpSpeed), limits);
+                if (health.flags & FILTER_CLOGGED) return static_cast<float>(cycle) * period;
+            }
+        }
+        return -1.0f;
+    };
+    float slow = secondsToFlag(1.0f);
+    float fast = secondsToFlag(0.01f);
+    EXPECT_GE(slow, 60.0f);
+    EXPECT_GE(fast, 60.0f);
+    EXPECT_NEAR(fast, slow, 5.0f);
+}
+
+// Test for a healthy loop under changing load: no false maintenance flag
+TEST(HealthEstimatorTest, HealthyLoopRaisesNoFlag) {
+    HealthLimits limits;
+    PlantModel plant(PlantParameters{}, 25.0f);
+    HealthState health(limits);
+    const float loads[4] = {500.0f, 1800.0f, 3500.0f, 1000.0f};
+    for (float load : loads) {
+        plant.setHeatLoad(load);
+        run(plant, health, limits, 900);
+        EXPECT_EQ(health.flags, 0) << load << " W";
+    }
+    EXPECT_GT(health.flowSamples, limits.minSamples);
+    EXPECT_NEAR(health.filterResistance(limits), 1.0f, 0.02f);
+    EXPECT_NEAR(health.pumpSpeedRatio.theta, 1.0f, 0.01f);
+}
+
+// Test for the separation of the two fits: a worn pump does not read as a clogged filter
+TEST(HealthEstimatorTest, SeparatesPumpWearFromClogging) {
+    HealthLimits limits;
+    PlantParameters parameters;
+    parameters.heatLoad = 2500.0f;
+    parameters.pumpWear = 0.3f;
+    PlantModel plant(parameters, 45.0f);
+    HealthState health(limits);
+    run(plant, health, limits, 600);
+
+    EXPECT_EQ(health.flags, PUMP_DEGRADED);
+    EXPECT_NEAR(health.filterResistance(limits), 1.0f, 0.02f);
+
+    // New pump fitted: the flag clears once the estimate is back inside the hysteresis
+    plant.setPumpWear(0.0f);
+    run(plant, health, limits, 600);
+    EXPECT_EQ(health.flags, 0);
+}
+
+// Test for updateHealthBatch against the scalar update
+TEST(HealthEstimatorTest, BatchMatchesScalar) {
+    HealthLimits limits;
+    const size_t count = 37;
+    std::vector<HealthState> batch(count, HealthState(limits));
+    std::vector<HealthState> scalar(count, HealthState(limits));
+    std::vector<HealthSample> samples(count);
+    for (int step = 0; step < 200; ++step) {
+        for (size_t i = 0; i < count; ++i) {
+            float command = 5.0f + static_cast<float>((i * 7 + step) % 96);
+            float rise = 0.1f + 0.05f * static_cast<float>(i % 30);
+            samples[i] = {command, command * 55.0f, 50.0f, 50.0f + rise, 2000.0f + 10.0f * static_cast<float>(i)};
+            updateHealth(scalar[i], samples[i], limits);
+        }
+        updateHealthBatch(batch.data(), samples.data(), count, limits);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(batch[i].pumpSpeedRatio.theta, scalar[i].pumpSpeedRatio.theta);
+        EXPECT_EQ(batch[i].flowCapacity.theta, scalar[i].flowCapacity.theta);
+        EXPECT_EQ(batch[i].flags, scalar[i].flags);
+    }
+}
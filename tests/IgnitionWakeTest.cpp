@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "IgnitionWake.h"
+
+#ifndef _WIN32
+
+// Test for the eventfd stand-in: wait() sleeps until raise() from another thread, and the
+// level follows raise() and lower()
+TEST(IgnitionWakeTest, EventWaitsForRaise) {
+    IgnitionWake wake;
+    std::string error;
+    ASSERT_TRUE(wake.open("eventfd", error)) << error;
+    EXPECT_FALSE(wake.ignition());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::thread driver([&wake]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        wake.raise();
+    });
+    EXPECT_TRUE(wake.wait(error)) << error;
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    driver.join();
+    EXPECT_TRUE(wake.ignition());
+
+    // Already on: no wait at all
+    EXPECT_TRUE(wake.wait(error));
+    wake.lower();
+    EXPECT_FALSE(wake.ignition());
+}
+
+#if defined(__linux__)
+
+// Test for the GPIO source on a stand-in value file: the level is read from the file
+TEST(IgnitionWakeTest, GpioLevelFromValueFile) {
+    char path[] = "/tmp/coolingloop_gpio_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, "1\n", 2), 2);
+    close(fd);
+
+    IgnitionWake wake;
+    std::string error;
+    ASSERT_TRUE(wake.open((std::string("gpio:") + path).c_str(), error)) << error;
+    EXPECT_TRUE(wake.ignition());
+    EXPECT_TRUE(wake.wait(error)) << error;
+
+    std::FILE* file = std::fopen(path, "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("0\n", file);
+    std::fclose(file);
+    EXPECT_FALSE(wake.ignition());
+    wake.close();
+    std::remove(path);
+}
+
+#endif
+
+// Test for the errors: unknown sources, missing files and interfaces are refused
+TEST(IgnitionWakeTest, RejectsUnusableSources) {
+    IgnitionWake wake;
+    std::string error;
+    EXPECT_FALSE(wake.open("serial", error));
+    EXPECT_NE(error.find("unknown wake source"), std::string::npos);
+    EXPECT_FALSE(wake.open("gpio:/nonexistent/gpio17/value", error));
+    EXPECT_FALSE(wake.open("can:nosuchcan0", error));
+    EXPECT_FALSE(wake.isOpen());
+}
+
+#endif
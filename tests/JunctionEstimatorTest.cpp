@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "CoolingLoopController.h"
+#include "JunctionEstimator.h"
+#include "TemperatureSensor.h"
+
+// Foster step response Zth(t) P, evaluated in double
+static double stepResponse(const FosterNetwork& network, double t, double power) {
+    double rise = 0.0;
+    for (int n = 0; n < network.nodes; ++n) {
+        rise += network.resistance[n] * (1.0 - std::exp(-t / network.tau[n])) * power;
+    }
+    return rise;
+}
+
+// Test for the update against the analytic step response, at a step size far above the
+// fastest time constants
+TEST(JunctionEstimatorTest, MatchesStepResponse) {
+    JunctionEstimator estimator(INVERTER_IGBT_NETWORK, 40.0f);
+    for (int step = 1; step <= 50; ++step) {
+        float junction = estimator.update(300.0f, 40.0f, 0.1f);
+        ASSERT_NEAR(junction - 40.0f, stepResponse(INVERTER_IGBT_NETWORK, 0.1 * step, 300.0), 1e-3) << step;
+    }
+    for (int step = 0; step < 100; ++step) {
+        estimator.update(300.0f, 40.0f, 1.0f);
+    }
+    EXPECT_NEAR(estimator.temperature() - 40.0f, steadyJunctionRise(INVERTER_IGBT_NETWORK, 300.0f), 1e-3);
+    EXPECT_NEAR(steadyJunctionRise(INVERTER_IGBT_NETWORK, 300.0f), 33.0f, 1e-3);
+}
+
+// Test for the step size: the same loss history gives the same junction temperature whether
+// it is stepped in 1 s or in 10 ms
+TEST(JunctionEstimatorTest, IndependentOfStepSize) {
+    JunctionEstimator coarse(DCDC_MOSFET_NETWORK, 50.0f);
+    JunctionEstimator fine(DCDC_MOSFET_NETWORK, 50.0f);
+    const float losses[] = {20.0f, 80.0f, 0.0f, 45.0f, 45.0f, 10.0f};
+    for (float loss : losses) {
+        coarse.update(loss, 50.0f, 1.0f);
+        for (int i = 0; i < 100; ++i) {
+            fine.update(loss, 50.0f, 0.01f);
+        }
+        EXPECT_NEAR(coarse.temperature(), fine.temperature(), 1e-3);
+    }
+    // The junction follows the coolant directly
+    EXPECT_NEAR(coarse.update(10.0f, 60.0f, 1.0f) - fine.update(10.0f, 50.0f, 1.0f), 10.0f, 1e-3);
+}
+
+// Test for the array: bit-identical to the scalar estimator for every device
+TEST(JunctionEstimatorTest, ArrayMatchesScalar) {
+    const std::size_t devices = 37;
+    JunctionEstimatorArray array(INVERTER_IGBT_NETWORK, devices, 45.0f);
+    std::vector<JunctionEstimator> scalar(devices, JunctionEstimator(INVERTER_IGBT_NETWORK, 45.0f));
+    std::vector<float> power(devices);
+    std::vector<float> coolant(devices);
+    for (int step = 0; step < 200; ++step) {
+        float dt = step < 100 ? 0.05f : 0.2f;
+        for (std::size_t i = 0; i < devices; ++i) {
+            power[i] = 50.0f + static_cast<float>((i * 37 + step * 11) % 400);
+            coolant[i] = 45.0f + 0.1f * static_cast<float>((i + step) % 50);
+        }
+        array.update(power.data(), coolant.data(), dt);
+        for (std::size_t i = 0; i < devices; ++i) {
+            ASSERT_EQ(array.temperature(i), scalar[i].update(power[i], coolant[i], dt)) << step << " " << i;
+        }
+    }
+    EXPECT_EQ(array.size(), devices);
+}
+
+// Test for the power stage: the DC-DC sits in coolant warmed by the inverter loss
+TEST(JunctionEstimatorTest, PowerStageHottestJunction) {
+    PowerStageJunctions stage(50.0f);
+    float hottest = 0.0f;
+    for (int step = 0; step < 100; ++step) {
+        hottest = stage.update(4000.0f, 1000.0f, 50.0f, 55.0f, 1.0f);
+    }
+    EXPECT_NEAR(stage.inverterJunction(), 50.0f + steadyJunctionRise(INVERTER_IGBT_NETWORK, 4000.0f / 6), 1e-2);
+    EXPECT_NEAR(stage.dcdcJunction(), 54.0f + steadyJunctionRise(DCDC_MOSFET_NETWORK, 1000.0f / 4), 1e-2);
+    EXPECT_EQ(hottest, stage.dcdcJunction());
+}
+
+// Test for the headroom: rises at the rate limit, falls at once, never negative
+TEST(JunctionEstimatorTest, HeadroomRisesSlowlyAndFallsAtOnce) {
+    JunctionHeadroom headroom; // 150 °C less 15 K
+    EXPECT_FLOAT_EQ(headroom.update(100.0f, 50.0f, 50.0f, 1.0f), 0.1f);
+    EXPECT_FLOAT_EQ(headroom.update(100.0f, 50.0f, 50.0f, 1.0f), 0.2f);
+    for (int i = 0; i < 1000; ++i) {
+        headroom.update(100.0f, 50.0f, 50.0f, 1.0f);
+    }
+    EXPECT_FLOAT_EQ(headroom.value(), 35.0f);
+    EXPECT_FLOAT_EQ(headroom.update(130.0f, 55.0f, 50.0f, 1.0f), 10.0f); // Load step
+    EXPECT_EQ(headroom.update(160.0f, 55.0f, 50.0f, 1.0f), 0.0f);
+}
+
+// Test for the rise rate: per second, so the raise climbs equally fast at any update period
+TEST(JunctionEstimatorTest, HeadroomRiseIndependentOfPeriod) {
+    JunctionHeadroom slow;
+    JunctionHeadroom fast;
+    for (int second = 0; second < 20; ++second) {
+        slow.update(100.0f, 50.0f, 50.0f, 1.0f);
+        for (int ms = 0; ms < 1000; ++ms) {
+            fast.update(100.0f, 50.0f, 50.0f, 0.001f);
+        }
+        ASSERT_NEAR(fast.value(), slow.value(), 1e-3f) << second;
+    }
+    EXPECT_NEAR(slow.value(), 2.0f, 1e-4f);
+}
+
+// Test for the controller: a raise moves the regulation point, at most half way to the threshold
+TEST(JunctionEstimatorTest, ControllerAcceptsBoundedRaise) {
+    auto pumpAt = [](float temperature, float raise) {
+        CoolingLoopController controller(50.0f, 70.0f);
+        SensorInputs inputs{temperatureToVoltage(temperature), true, true};
+        inputs.setpointRaise = raise;
+        return controller.step(inputs).pumpSpeed;
+    };
+    EXPECT_LT(pumpAt(55.0f, 4.0f), pumpAt(55.0f, 0.0f));
+    EXPECT_EQ(pumpAt(55.0f, 4.0f), pumpAt(51.0f, 0.0f));
+    EXPECT_EQ(pumpAt(65.0f, 30.0f), pumpAt(55.0f, 0.0f)); // Raise limited to 10 K
+    EXPECT_EQ(pumpAt(55.0f, -5.0f), pumpAt(55.0f, 0.0f)); // Never lowered
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <vector>
+#include "LoopState.h"
+
+// Test for the SoA layout: every loop matches a FleetLoop stepped alongside it, bit for bit
+TEST(LoopStateTest, MatchesFleetLoops) {
+    FleetOptions options;
+    options.threshold = 60.0f; // Low enough that the hill climb shuts some loops down
+    const std::size_t loops = 37; // Two full blocks and a partial one
+    LoopStateArray array(loops, options);
+    ASSERT_EQ(array.loops(), loops);
+
+    std::vector<FleetLoop> reference;
+    for (std::size_t i = 0; i < loops; ++i) reference.emplace_back(options, i);
+
+    std::size_t shutdowns = 0;
+    std::size_t expected = 0;
+    for (long c = 0; c < 2000; ++c) {
+        float seconds = static_cast<float>(c) * options.dt;
+        shutdowns += array.step(seconds);
+        for (std::size_t i = 0; i < loops; ++i) {
+            bool entered = reference[i].step(seconds, options.dt);
+            expected += entered;
+            if (entered) {
+                EXPECT_EQ(array.shutdownTime(i), seconds);
+            }
+            ASSERT_EQ(array.state(i), reference[i].controller.state()) << "loop " << i << " cycle " << c;
+            ASSERT_EQ(array.coolantTemperature(i), reference[i].plant.temperature()) << "loop " << i << " cycle " << c;
+        }
+    }
+    EXPECT_GT(expected, 0u);
+    EXPECT_EQ(shutdowns, expected);
+    for (std::size_t i = 0; i < loops; ++i) {
+        if (array.state(i) == SystemState::SAFETY_SHUTDOWN) {
+            EXPECT_EQ(array.cause(i), ShutdownCause::OVERTEMPERATURE);
+            EXPECT_EQ(array.pumpSpeed(i), 0.0f);
+        }
+        EXPECT_EQ(array.sensorFaults(i), 0u);
+    }
+}
+
+// Test for the block layout: hot fields on whole, aligned cache lines
+TEST(LoopStateTest, HotBlocksAreCacheLineAligned) {
+    EXPECT_EQ(alignof(LoopHotBlock), 64u);
+    EXPECT_EQ(sizeof(LoopHotBlock) % 64, 0u);
+    EXPECT_EQ(offsetof(LoopHotBlock, temperature) % 64, 0u);
+    EXPECT_EQ(offsetof(LoopHotBlock, state) % 64, 0u);
+}
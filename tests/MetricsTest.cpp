@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+#include "MetricsServer.h"
+
+namespace {
+
+// One HTTP request over a connected socket, returning the whole response
+std::string exchange(int connection, const char* request) {
+    std::string response;
+    if (::send(connection, request, std::strlen(request), 0) < 0) {
+        return response;
+    }
+    char buffer[4096];
+    for (ssize_t count; (count = ::recv(connection, buffer, sizeof(buffer), 0)) > 0;) {
+        response.append(buffer, static_cast<size_t>(count));
+    }
+    ::close(connection);
+    return response;
+}
+
+std::string scrapeTcp(int port) {
+    int connection = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(static_cast<uint16_t>(port));
+    if (::connect(connection, reinterpret_cast<sockaddr*>(&server), sizeof(server)) != 0) {
+        ::close(connection);
+        return "";
+    }
+    return exchange(connection, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+}
+
+std::string scrapeUnix(const std::string& path, const char* request) {
+    int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un server{};
+    server.sun_family = AF_UNIX;
+    std::strcpy(server.sun_path, path.c_str());
+    if (::connect(connection, reinterpret_cast<sockaddr*>(&server), sizeof(server)) != 0) {
+        ::close(connection);
+        return "";
+    }
+    return exchange(connection, request);
+}
+
+std::string format(const ControllerMetrics& metrics) {
+    static char buffer[METRICS_RESPONSE_SIZE];
+    return std::string(buffer, formatMetrics(metrics, buffer, sizeof(buffer)));
+}
+
+} // namespace
+
+// Test for ShardedCounter and LatencyHistogram: updates from many threads all add up
+TEST(MetricsTest, ShardsAddUpAcrossThreads) {
+    static ControllerMetrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2 * METRIC_SHARDS; ++t) { // More threads than shards share some
+        threads.emplace_back([]() {
+            for (int i = 0; i < 10000; ++i) {
+                metrics.cycles.add();
+                metrics.stageLatency[0].record(1000);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(metrics.cycles.value(), 2u * METRIC_SHARDS * 10000u);
+    EXPECT_EQ(metrics.stageLatency[0].count(), 2u * METRIC_SHARDS * 10000u);
+    EXPECT_NEAR(metrics.stageLatency[0].sumSeconds(), 2.0 * METRIC_SHARDS * 10000 * 1e-6, 1e-9);
+}
+
+// Test for LatencyHistogram::percentile: within one bucket (19 %) of the exact value
+TEST(MetricsTest, PercentilesFollowDistribution) {
+    static LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.5), 0.0);
+    for (std::uint64_t microseconds = 1; microseconds <= 10000; ++microseconds) {
+        histogram.record(microseconds * 1000);
+    }
+    EXPECT_NEAR(histogram.percentile(0.5), 5e-3, 5e-3 * 0.19);
+    EXPECT_NEAR(histogram.percentile(0.9), 9e-3, 9e-3 * 0.19);
+    EXPECT_NEAR(histogram.percentile(0.99), 9.9e-3, 9.9e-3 * 0.19);
+
+    for (std::uint64_t nanoseconds = 0; nanoseconds < 100000; nanoseconds += 7) {
+        int bucket = latencyBucket(nanoseconds);
+        EXPECT_LE(latencyBucket(nanoseconds / 2), bucket); // Monotonic
+        EXPECT_LT(bucket, LATENCY_BUCKETS);
+    }
+}
+
+// Test for formatMetrics: Prometheus text with shutdowns counted once per entry
+TEST(MetricsTest, FormatsPrometheusText) {
+    static ControllerMetrics metrics;
+    ControlOutputs out{SystemState::ON, ShutdownCause::NONE, 61.5f, 40.0f, 20.0f, SensorStatus::VALID, 1, false};
+    metrics.recordOutputs(out);
+    out.state = SystemState::SAFETY_SHUTDOWN;
+    out.cause = ShutdownCause::OVERTEMPERATURE;
+    metrics.recordOutputs(out);
+    metrics.recordOutputs(out); // Still latched: not a new shutdown
+    metrics.cycles.add(3);
+    metrics.stageLatency[static_cast<int>(ControlStage::CONTROL)].record(2000);
+    metrics.wakeLatency.record(50000);
+
+    std::string text = format(metrics);
+    EXPECT_NE(text.find("# TYPE coolingloop_cycles_total counter\ncoolingloop_cycles_total 3\n"), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_shutdowns_total{cause=\"overtemperature\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_shutdowns_total{cause=\"low_coolant\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_stage_latency_seconds_count{stage=\"control\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_stage_latency_seconds{stage=\"control\",quantile=\"0.99\"} 2."), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_wake_latency_seconds_count 1\n"), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_temperature_celsius 61.5\n"), std::string::npos);
+    EXPECT_NE(text.find("coolingloop_state{state=\"safety_shutdown\"} 1\n"), std::string::npos);
+
+    char tiny[64];
+    EXPECT_EQ(formatMetrics(metrics, tiny, sizeof(tiny)), 0u);
+}
+
+// Test for MetricsServer: scrapes over a loopback port and a Unix socket
+TEST(MetricsTest, ServesLoopbackAndUnixSocket) {
+    static ControllerMetrics metrics;
+    metrics.cycles.add(42);
+
+    static MetricsServer tcp;
+    ASSERT_TRUE(tcp.start(metrics, "0"));
+    ASSERT_GT(tcp.port(), 0);
+    std::string response = scrapeTcp(tcp.port());
+    EXPECT_EQ(response.rfind("HTTP/1.0 200 OK\r\n", 0), 0u) << response;
+    EXPECT_NE(response.find("text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("\ncoolingloop_cycles_total 42\n"), std::string::npos);
+    tcp.stop();
+
+    std::string path = "/tmp/coolingloop_metrics_test_" + std::to_string(::getpid()) + ".sock";
+    static MetricsServer local;
+    ASSERT_TRUE(local.start(metrics, path.c_str()));
+    response = scrapeUnix(path, "GET /metrics HTTP/1.0\r\n\r\n");
+    EXPECT_NE(response.find("\ncoolingloop_cycles_total 42\n"), std::string::npos) << response;
+    response = scrapeUnix(path, "GET /other HTTP/1.0\r\n\r\n");
+    EXPECT_EQ(response.rfind("HTTP/1.0 404", 0), 0u) << response;
+    local.stop();
+    EXPECT_NE(::access(path.c_str(), F_OK), 0); // Socket file removed
+}
+
+// Test for the Unix socket path: a stale socket is replaced, any other file is left alone
+TEST(MetricsTest, ReplacesOnlyStaleSockets) {
+    static ControllerMetrics metrics;
+    std::string path = "/tmp/coolingloop_metrics_path_" + std::to_string(::getpid());
+    FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("keep", file);
+    std::fclose(file);
+    MetricsServer server;
+    EXPECT_FALSE(server.start(metrics, path.c_str()));
+    EXPECT_EQ(::access(path.c_str(), F_OK), 0);
+    std::remove(path.c_str());
+
+    // A socket bound and abandoned, as by a process that was killed
+    int stale = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    ASSERT_EQ(::bind(stale, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ::close(stale);
+    EXPECT_TRUE(server.start(metrics, path.c_str()));
+    server.stop();
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "PerformanceMap.h"
+#include "PlantModel.h"
+
+// Test for bilinear interpolation: exact at the grid points, linear along the edges and
+// bilinear inside a cell, clamped outside the grid
+TEST(PerformanceMapTest, InterpolatesBilinearly) {
+    PerformanceMap map;
+    // f(x, y) = 10 x + 100 y + x y on x = 0, 0.5, 1 and y = 2, 4
+    std::vector<float> grid = {200.0f, 206.0f, 212.0f, 400.0f, 407.0f, 414.0f};
+    ASSERT_TRUE(map.assign({0.0f, 0.5f, 3}, {2.0f, 2.0f, 2}, grid));
+    EXPECT_EQ(map.xPoints(), 3);
+
+    EXPECT_FLOAT_EQ(map.evaluate(0.5f, 2.0f), 206.0f);
+    EXPECT_FLOAT_EQ(map.evaluate(1.0f, 4.0f), 414.0f);
+    EXPECT_FLOAT_EQ(map.evaluate(0.25f, 3.0f), 302.5f + 0.75f); // Bilinear is exact for x y
+    EXPECT_FLOAT_EQ(map.evaluate(0.75f, 2.0f), 209.0f);
+
+    EXPECT_FLOAT_EQ(map.evaluate(-1.0f, 2.0f), 200.0f);
+    EXPECT_FLOAT_EQ(map.evaluate(2.0f, 10.0f), 414.0f);
+    EXPECT_FLOAT_EQ(map.evaluate(0.5f, 0.0f), 206.0f);
+    EXPECT_TRUE(std::isnan(map.evaluate(-INFINITY, 3.0f)));
+    EXPECT_TRUE(std::isnan(map.evaluate(NAN, 3.0f))); // Rejected, never an out-of-range index
+    EXPECT_TRUE(std::isnan(map.evaluate(0.5f, NAN)));
+
+    EXPECT_FALSE(map.assign({0.0f, 0.5f, 3}, {2.0f, 2.0f, 1}, {1.0f, 2.0f, 3.0f}));
+    EXPECT_FALSE(map.assign({0.0f, 0.0f, 2}, {2.0f, 2.0f, 2}, {1.0f, 2.0f, 3.0f, 4.0f}));
+    EXPECT_FALSE(map.assign({0.0f, 1.0f, 2}, {2.0f, 2.0f, 2}, {1.0f, 2.0f, 3.0f}));
+}
+
+// Test for the batch evaluation: identical to evaluate() over several chunks, inside and
+// outside the grid
+TEST(PerformanceMapTest, BatchMatchesScalar) {
+    RadiatorMap radiator;
+    std::string error;
+    ASSERT_TRUE(loadRadiatorMap(COOLINGLOOP_SOURCE_DIR "/config/radiator_map.txt", radiator, error)) << error;
+    const PerformanceMap& map = radiator.conductance;
+
+    const std::size_t count = 1000;
+    std::vector<float> flow(count), air(count), out(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        flow[i] = -0.2f + 1.4f * static_cast<float>(i % 89) / 88.0f;
+        air[i] = -1.0f + 15.0f * static_cast<float>(i % 97) / 96.0f;
+    }
+    map.evaluateBatch(flow.data(), air.data(), out.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(out[i], map.evaluate(flow[i], air[i])) << i;
+    }
+    flow[3] = NAN;
+    air[700] = -NAN;
+    map.evaluateBatch(flow.data(), air.data(), out.data(), count);
+    EXPECT_TRUE(std::isnan(out[3]));
+    EXPECT_TRUE(std::isnan(out[700]));
+    EXPECT_EQ(out[4], map.evaluate(flow[4], air[4]));
+
+    // Conductance rises with both coolant flow and air velocity
+    EXPECT_LT(map.evaluate(0.2f, 6.0f), map.evaluate(0.8f, 6.0f));
+    EXPECT_LT(map.evaluate(0.8f, 2.0f), map.evaluate(0.8f, 6.0f));
+}
+
+// Test for the map file: keywords, comments and errors with line numbers
+TEST(PerformanceMapTest, ParsesRadiatorMap) {
+    std::istringstream good("# comment\nflow_axis 0 1 2\nair_axis 0 5 2\nfan_air_velocity 5\n"
+                            "ram_air_fraction 0.5\nrow 10 20  # 0 m/s\nrow 30 40\n");
+    RadiatorMap radiator;
+    std::string error;
+    ASSERT_TRUE(parseRadiatorMap(good, radiator, error)) << error;
+    EXPECT_FLOAT_EQ(radiator.conductance.evaluate(0.5f, 2.5f), 25.0f);
+    EXPECT_FLOAT_EQ(radiatorAirVelocity(radiator, 100.0f, 0.0f), 5.0f);
+    EXPECT_FLOAT_EQ(radiatorAirVelocity(radiator, 60.0f, 28.8f), 5.0f); // 3 m/s fan, 4 m/s ram air
+
+    std::istringstream shortRow("flow_axis 0 1 3\nair_axis 0 5 2\nrow 1 2 3\nrow 1 2\n");
+    EXPECT_FALSE(parseRadiatorMap(shortRow, radiator, error));
+    EXPECT_NE(error.find("line 4"), std::string::npos);
+    std::istringstream badValue("flow_axis 0 1 2\nair_axis 0 5 2\nrow 1 x\nrow 1 2\n");
+    EXPECT_FALSE(parseRadiatorMap(badValue, radiator, error));
+    EXPECT_NE(error.find("line 3: bad value for 'row'"), std::string::npos);
+    std::istringstream missingRow("flow_axis 0 1 2\nair_axis 0 5 2\nrow 1 2\n");
+    EXPECT_FALSE(parseRadiatorMap(missingRow, radiator, error));
+    std::istringstream unknown("flow_axis 0 1 2\nfan 3\n");
+    EXPECT_FALSE(parseRadiatorMap(unknown, radiator, error));
+    EXPECT_NE(error.find("unknown keyword 'fan'"), std::string::npos);
+    EXPECT_FALSE(loadRadiatorMap("missing_radiator_map.txt", radiator, error));
+}
+
+// Test for the plant on a map: more ram air rejects more heat
+TEST(PerformanceMapTest, PlantUsesMapAndRamAir) {
+    RadiatorMap radiator;
+    std::string error;
+    ASSERT_TRUE(loadRadiatorMap(COOLINGLOOP_SOURCE_DIR "/config/radiator_map.txt", radiator, error)) << error;
+
+    PlantModel parked(PlantParameters{}, 60.0f);
+    PlantModel driving(PlantParameters{}, 60.0f);
+    parked.setRadiatorMap(&radiator);
+    driving.setRadiatorMap(&radiator);
+    driving.setVehicleSpeed(100.0f);
+    for (int i = 0; i < 600; ++i) {
+        parked.step(1.0f, 50.0f, 30.0f);
+        driving.step(1.0f, 50.0f, 30.0f);
+    }
+    EXPECT_LT(driving.temperature(), parked.temperature() - 1.0f);
+
+    // Without a map the built-in model is back
+    parked.setRadiatorMap(nullptr);
+    PlantModel reference(PlantParameters{}, parked.temperature());
+    parked.step(1.0f, 50.0f, 30.0f);
+    reference.step(1.0f, 50.0f, 30.0f);
+    EXPECT_EQ(parked.temperature(), reference.temperature());
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Actuators.h"
+#include "PlantModel.h"
+#include "PlantServer.h"
+
+namespace {
+
+std::string socketPath() {
+    return "/tmp/coolingloop_plant_test_" + std::to_string(::getpid()) + ".sock";
+}
+
+} // namespace
+
+// Test for a round trip: the served plant steps exactly like a local one on the stepped
+// drive profile, and the sample echoes the command
+TEST(PlantServerTest, RoundTripMatchesLocalPlant) {
+    const std::string path = socketPath();
+    PlantModel served(PlantParameters{}, 45.0f);
+    PlantServer server;
+    ASSERT_TRUE(server.start(path.c_str(), served));
+
+    PlantLink link;
+    ASSERT_TRUE(link.connect(path.c_str()));
+    PlantModel local(PlantParameters{}, 45.0f);
+    PlantSample sample;
+    ASSERT_TRUE(link.exchange(0.0f, sample)); // Sample only
+    EXPECT_EQ(sample.outletTemperature, local.temperature());
+
+    float time = 0.0f;
+    for (int i = 0; i < 200; ++i) {
+        link.setPump(static_cast<float>(i % 100));
+        link.setFan(30.0f);
+        ASSERT_TRUE(link.exchange(0.5f, sample));
+        local.setHeatLoad(driveProfileHeatLoad(time));
+        local.step(0.5f, static_cast<float>(i % 100), 30.0f);
+        time += 0.5f;
+        ASSERT_EQ(sample.outletTemperature, local.temperature()) << i;
+        ASSERT_EQ(sample.sensorVoltage, local.sensorVoltage()) << i;
+        ASSERT_EQ(sample.pumpRpm, local.pumpRpm()) << i;
+        ASSERT_EQ(sample.heatLoad, local.heatLoad()) << i;
+    }
+    EXPECT_EQ(sample.sequence, 201u);
+    EXPECT_EQ(server.roundTrips(), 201u);
+}
+
+// Test for the actuator driver: controlPump() and controlFan() reach the plant server
+TEST(PlantServerTest, ActuatorsRouteThroughLink) {
+    const std::string path = socketPath();
+    PlantModel served(PlantParameters{}, 45.0f);
+    PlantServer server;
+    ASSERT_TRUE(server.start(path.c_str(), served));
+    PlantLink link;
+    ASSERT_TRUE(link.connect(path.c_str()));
+
+    setActuatorDriver(&link);
+    controlPump(80.0f);
+    controlFan(60.0f);
+    setActuatorDriver(nullptr);
+    EXPECT_FLOAT_EQ(link.pumpCommand(), 80.0f);
+    EXPECT_FLOAT_EQ(link.fanCommand(), 60.0f);
+
+    PlantSample sample;
+    ASSERT_TRUE(link.exchange(1.0f, sample));
+    PlantModel local(PlantParameters{}, 45.0f);
+    local.setHeatLoad(driveProfileHeatLoad(0.0f));
+    local.step(1.0f, 80.0f, 60.0f);
+    EXPECT_EQ(sample.pumpRpm, local.pumpRpm());
+}
+
+// Test for the rig switches and reconnecting after the controller restarts
+TEST(PlantServerTest, SwitchesAndReconnect) {
+    const std::string path = socketPath();
+    PlantModel served(PlantParameters{}, 45.0f);
+    PlantServer server;
+    ASSERT_TRUE(server.start(path.c_str(), served));
+
+    PlantLink link;
+    ASSERT_TRUE(link.connect(path.c_str()));
+    PlantSample sample;
+    ASSERT_TRUE(link.exchange(0.0f, sample));
+    EXPECT_EQ(sample.ignition, 1);
+    EXPECT_EQ(sample.level, 1);
+    server.setLevel(false);
+    server.setIgnition(false);
+    ASSERT_TRUE(link.exchange(0.0f, sample));
+    EXPECT_EQ(sample.ignition, 0);
+    EXPECT_EQ(sample.level, 0);
+
+    link.close();
+    EXPECT_FALSE(link.exchange(0.0f, sample));
+    ASSERT_TRUE(link.connect(path.c_str()));
+    ASSERT_TRUE(link.exchange(0.0f, sample));
+    EXPECT_EQ(sample.level, 0);
+
+    // The socket file goes with the server
+    server.stop();
+    EXPECT_NE(::access(path.c_str(), F_OK), 0);
+    EXPECT_FALSE(link.exchange(0.0f, sample));
+}
+
+// Test for the socket path: a stale socket is replaced, any other file is left alone
+TEST(PlantServerTest, ReplacesOnlyStaleSockets) {
+    const std::string path = socketPath();
+    FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("keep", file);
+    std::fclose(file);
+    PlantModel served(PlantParameters{}, 45.0f);
+    PlantServer server;
+    EXPECT_FALSE(server.start(path.c_str(), served));
+    EXPECT_EQ(::access(path.c_str(), F_OK), 0);
+    std::remove(path.c_str());
+
+    // A socket bound and abandoned, as by a server that was killed
+    int stale = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    ASSERT_EQ(::bind(stale, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ::close(stale);
+    ASSERT_TRUE(server.start(path.c_str(), served));
+    PlantLink link;
+    EXPECT_TRUE(link.connect(path.c_str()));
+    server.stop();
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "PowerView.h"
+#include "Seqlock.h"
+
+namespace {
+
+PowerViewSnapshot running(float temperature, float pump, std::uint32_t cycle) {
+    PowerViewSnapshot snapshot{};
+    snapshot.outputs = ControlOutputs{SystemState::ON, ShutdownCause::NONE, temperature, pump, 10.0f,
+                                      SensorStatus::VALID, 0x3, false};
+    snapshot.setpoint = 50.0f;
+    snapshot.threshold = 70.0f;
+    snapshot.cycle = cycle;
+    return snapshot;
+}
+
+std::string line(const PowerView& view, int row) {
+    return std::string(view.line(row), POWER_VIEW_COLUMNS);
+}
+
+} // namespace
+
+// Test for PowerView::diff: the first frame is drawn in full, an unchanged one costs nothing
+TEST(PowerViewTest, RedrawsOnlyWhatChanged) {
+    PowerView view;
+    char buffer[POWER_VIEW_BUFFER_SIZE];
+
+    view.compose(running(55.0f, 30.0f, 1));
+    std::size_t first = view.diff(buffer, sizeof(buffer));
+    EXPECT_GE(first, static_cast<std::size_t>(POWER_VIEW_ROWS * POWER_VIEW_COLUMNS));
+    EXPECT_EQ(std::string(buffer, 6), "\033[1;1H");
+
+    view.compose(running(55.0f, 30.0f, 1));
+    EXPECT_EQ(view.diff(buffer, sizeof(buffer)), 0u);
+
+    // A new pump speed touches the changed cells of the pump row only
+    view.compose(running(55.0f, 80.0f, 1));
+    std::size_t length = view.diff(buffer, sizeof(buffer));
+    std::string update(buffer, length);
+    EXPECT_LT(length, 64u);
+    for (std::size_t move = update.find("\033["); move != std::string::npos; move = update.find("\033[", move + 1)) {
+        EXPECT_EQ(update.compare(move, 4, "\033[6;"), 0) << update;
+    }
+    EXPECT_NE(line(view, 5).find("80.0 %"), std::string::npos);
+
+    view.invalidate();
+    EXPECT_EQ(view.diff(buffer, sizeof(buffer)), first);
+}
+
+// Test for the fault list: faults stay listed after they clear, with the cycles they were seen
+TEST(PowerViewTest, FaultListLatches) {
+    PowerView view;
+    view.compose(running(55.0f, 30.0f, 1));
+    EXPECT_NE(line(view, 11).find("none"), std::string::npos);
+
+    PowerViewSnapshot open = running(55.0f, 100.0f, 7);
+    open.outputs.sensorStatus = SensorStatus::OPEN_CIRCUIT;
+    open.outputs.activeSensors = 0;
+    view.compose(open);
+    EXPECT_NE(line(view, 11).find("ACTIVE   Sensor open circuit"), std::string::npos) << line(view, 11);
+    EXPECT_NE(line(view, 12).find("ACTIVE   No plausible sensor"), std::string::npos) << line(view, 12);
+
+    view.compose(running(55.0f, 30.0f, 9));
+    EXPECT_NE(line(view, 11).find("cleared  Sensor open circuit"), std::string::npos) << line(view, 11);
+    EXPECT_NE(line(view, 11).find("cycles 7-7"), std::string::npos) << line(view, 11);
+    EXPECT_NE(line(view, 8).find("ch1 in use"), std::string::npos);
+}
+
+// Test for Seqlock: a reader never sees a half-written snapshot
+TEST(PowerViewTest, SeqlockReadsAreConsistent) {
+    Seqlock<PowerViewSnapshot> snapshot;
+    std::atomic<bool> done(false);
+    std::thread writer([&]() {
+        for (std::uint32_t cycle = 1; cycle <= 200000; ++cycle) {
+            float value = static_cast<float>(cycle);
+            snapshot.store(running(value, value, cycle));
+        }
+        done = true;
+    });
+
+    long reads = 0;
+    bool consistent = true;
+    std::uint32_t lastCycle = 0;
+    while (!done || reads == 0) {
+        PowerViewSnapshot copy;
+        snapshot.load(copy);
+        consistent &= copy.outputs.measuredTemperature == static_cast<float>(copy.cycle) &&
+                      copy.outputs.pumpSpeed == static_cast<float>(copy.cycle) && copy.cycle >= lastCycle;
+        lastCycle = copy.cycle;
+        ++reads;
+    }
+    writer.join();
+    EXPECT_TRUE(consistent);
+    EXPECT_GT(reads, 0);
+}
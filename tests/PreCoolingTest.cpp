@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "CANBus.h"
+#include "CoolingLoopController.h"
+#include "DriveCycle.h"
+#include "PlantModel.h"
+#include "PreCooling.h"
+
+// Test for the forecast: values hold until replaced, and time moves them to the front
+TEST(PreCoolingTest, ForecastHoldsAndAdvances) {
+    LoadForecast forecast(4, 5.0f, 1000.0f);
+    forecast.set(10.0f, 3000.0f);
+    forecast.set(17.0f, 2000.0f);
+    EXPECT_EQ(forecast.at(0), 1000.0f);
+    EXPECT_EQ(forecast.at(1), 1000.0f);
+    EXPECT_EQ(forecast.at(2), 3000.0f);
+    EXPECT_EQ(forecast.at(3), 2000.0f);
+
+    forecast.advance(3.0f);
+    EXPECT_EQ(forecast.stepsPassed(), 0u);
+    forecast.advance(9.0f); // 12 s: two steps
+    EXPECT_EQ(forecast.stepsPassed(), 2u);
+    EXPECT_EQ(forecast.at(0), 3000.0f);
+    EXPECT_EQ(forecast.at(1), 2000.0f);
+    EXPECT_EQ(forecast.at(2), 2000.0f);
+    EXPECT_EQ(forecast.at(3), 2000.0f);
+}
+
+// Test for the plan: a load step ahead raises the cooling before it and pulls the coolant below
+// the setpoint by the time it arrives
+TEST(PreCoolingTest, PlansAheadOfLoadStep) {
+    LoadForecast flat(120, 5.0f, 1800.0f);
+    LoadForecast climb(120, 5.0f, 1800.0f);
+    climb.set(240.0f, 3500.0f);
+    climb.set(540.0f, 1800.0f);
+    PreCoolingPlanner flatPlanner;
+    PreCoolingPlanner climbPlanner;
+    float flatFloor = 0.0f;
+    float climbFloor = 0.0f;
+    for (int call = 0; call < 200; ++call) {
+        flatFloor = flatPlanner.plan(50.0f, 50.0f, flat);
+        climbFloor = climbPlanner.plan(50.0f, 50.0f, climb);
+    }
+    EXPECT_GE(climbFloor, flatFloor);
+    EXPECT_GT(climbPlanner.plannedCommand(40), flatPlanner.plannedCommand(40) + 0.05f);
+    EXPECT_LT(climbPlanner.plannedTemperature(48), 49.0f); // Just before the climb
+    EXPECT_NEAR(flatPlanner.plannedTemperature(60), 50.0f, 0.5f);
+    EXPECT_GT(flatFloor, 40.0f); // Holds 1800 W at the setpoint
+    EXPECT_LT(flatFloor, 80.0f);
+}
+
+// Test for the warm start: a few iterations per call converge to the cost of a long cold solve
+TEST(PreCoolingTest, WarmStartConverges) {
+    LoadForecast forecast(120, 5.0f, 1800.0f);
+    forecast.set(300.0f, 3500.0f);
+    PreCoolingOptions cold;
+    cold.iterations = 2000;
+    PreCoolingPlanner reference(PlantParameters{}, cold);
+    reference.plan(50.0f, 50.0f, forecast);
+
+    PreCoolingPlanner warm;
+    for (int call = 0; call < 300; ++call) {
+        warm.plan(50.0f, 50.0f, forecast);
+    }
+    EXPECT_LE(warm.cost(), reference.cost() * 1.02f);
+
+    // Time passing shifts the plan; the next call starts from the shifted schedule
+    float ahead = warm.plannedCommand(1);
+    forecast.advance(5.0f);
+    PreCoolingOptions none;
+    none.iterations = 0;
+    PreCoolingPlanner shifted(PlantParameters{}, none);
+    warm.plan(warm.plannedTemperature(1), 50.0f, forecast);
+    EXPECT_NEAR(warm.plannedCommand(0), ahead, 0.05f);
+    EXPECT_EQ(shifted.plan(50.0f, 50.0f, forecast), 50.0f); // No iterations: initial schedule
+}
+
+// Test for the step length: a long quiet stretch, where the plan cannot improve, leaves the
+// planner able to react to a peak as quickly as a new one
+TEST(PreCoolingTest, RecoversAfterQuietStretch) {
+    LoadForecast forecast(120, 5.0f, 500.0f);
+    PreCoolingPlanner idle;
+    for (int call = 0; call < 600; ++call) {
+        idle.plan(40.0f, 50.0f, forecast);
+    }
+    EXPECT_LT(idle.plannedCommand(0), 0.1f); // Nothing to cool
+
+    forecast.set(300.0f, 6000.0f);
+    PreCoolingPlanner fresh;
+    float idleFloor = 0.0f;
+    float freshFloor = 0.0f;
+    for (int call = 0; call < 300; ++call) {
+        idleFloor = idle.plan(40.0f, 50.0f, forecast);
+        freshFloor = fresh.plan(40.0f, 50.0f, forecast);
+    }
+    EXPECT_NEAR(idleFloor, freshFloor, 5.0f);
+    EXPECT_LE(idle.cost(), fresh.cost() * 1.05f);
+}
+
+// Test for the controller: the floor lifts both commands and nothing else
+TEST(PreCoolingTest, ControllerAppliesFloor) {
+    CoolingLoopController plain(50.0f, 70.0f);
+    CoolingLoopController floored(50.0f, 70.0f);
+    SensorInputs inputs{temperatureToVoltage(45.0f), true, true};
+    EXPECT_EQ(plain.step(inputs).pumpSpeed, 0.0f);
+    inputs.coolingFloor = 60.0f;
+    const ControlOutputs& out = floored.step(inputs);
+    EXPECT_EQ(out.pumpSpeed, 60.0f);
+    EXPECT_EQ(out.fanSpeed, 60.0f);
+    inputs.coolingFloor = 150.0f;
+    EXPECT_EQ(floored.step(inputs).pumpSpeed, 100.0f);
+}
+
+// Test for the closed loop on the stepped drive profile: knowing the hill climb ten minutes
+// ahead keeps the peak well below the PID loops' own
+TEST(PreCoolingTest, ClosedLoopLowersPeak) {
+    float peak[2] = {0.0f, 0.0f};
+    for (int lookahead = 0; lookahead < 2; ++lookahead) {
+        CoolingLoopController controller(50.0f, 70.0f);
+        PlantModel plant(PlantParameters{}, 45.0f);
+        PreCoolingOptions options;
+        LoadForecast forecast(options.horizon, options.stepSeconds);
+        PreCoolingPlanner planner(PlantParameters{}, options);
+        double until = 0.0;
+        float floor = 0.0f;
+        for (int second = 0; second < 3600; ++second) {
+            plant.setHeatLoad(driveProfileHeatLoad(static_cast<float>(second)));
+            SensorInputs inputs{plant.sensorVoltage(), true, true};
+            inputs.coolingFloor = floor;
+            const ControlOutputs& out = controller.step(inputs);
+            plant.step(1.0f, out.pumpSpeed, out.fanSpeed);
+            if (second > 600 && plant.temperature() > peak[lookahead]) peak[lookahead] = plant.temperature();
+            if (lookahead) {
+                forecast.advance(1.0f);
+                for (; until < second + 1 + 600.0; until += options.stepSeconds) {
+                    float load = driveProfileHeatLoad(static_cast<float>(until));
+                    forecast.set(static_cast<float>(until - (second + 1)), load);
+                }
+                floor = planner.plan(plant.temperature(), 50.0f, forecast);
+            }
+        }
+    }
+    EXPECT_GT(peak[0], 55.0f);
+    EXPECT_LT(peak[1], 52.0f);
+}
+
+// Test for the forecast message: 16-bit time and load, rounded, saturating
+TEST(PreCoolingTest, ForecastFrame) {
+    CANFrame frame = encodeForecastFrame(300.0f, 3504.0f);
+    EXPECT_EQ(frame.id, 0x18FF428Fu);
+    EXPECT_EQ(frame.data[0], 300 & 0xFF);
+    EXPECT_EQ(frame.data[1], 300 >> 8);
+    float seconds = 0.0f;
+    float load = 0.0f;
+    decodeForecastFrame(frame, seconds, load);
+    EXPECT_EQ(seconds, 300.0f);
+    EXPECT_EQ(load, 3500.0f);
+
+    decodeForecastFrame(encodeForecastFrame(1e6f, -5.0f), seconds, load);
+    EXPECT_EQ(seconds, 65535.0f);
+    EXPECT_EQ(load, 0.0f);
+}
+
+// Test for the CAN path of the forecast: frames sent for a drive cycle fill the forecast as
+// reading the drive cycle directly does, to the 10 W resolution of the frame
+TEST(PreCoolingTest, ForecastOverCan) {
+    std::string path = testing::TempDir() + "coolingloop_forecast.csv";
+    std::ofstream(path) << "time,speed,inverter,dcdc,ambient\n0,0,1000,500,25\n20,0,1000,500,25\n"
+                           "21,0,4000,1000,25\n60,0,2000,500,25\n";
+    DriveCycleProfile direct;
+    DriveCycleProfile ahead;
+    std::string error;
+    ASSERT_TRUE(direct.open(path.c_str(), error)) << error;
+    ASSERT_TRUE(ahead.open(path.c_str(), error)) << error;
+
+    LoadForecast expected(12, 5.0f, 1800.0f);
+    LoadForecast received(12, 5.0f, 1800.0f);
+    double directUntil = 0.0;
+    double sentUntil = 0.0;
+    std::vector<CANFrame> frames;
+    for (int second = 0; second < 30; ++second) {
+        readForecast(direct, expected, second, directUntil);
+        sendForecast(ahead, received, second, sentUntil, frames);
+        for (const CANFrame& frame : frames) {
+            EXPECT_EQ(frame.id, DEFAULT_FORECAST_LAYOUT.id);
+            receiveForecast(received, frame);
+        }
+        frames.clear();
+        for (int k = 0; k < expected.steps(); ++k) {
+            ASSERT_NEAR(received.at(k), expected.at(k), 5.0f) << second << " s, step " << k; // 10 W units
+        }
+        expected.advance(1.0f);
+        received.advance(1.0f);
+    }
+    std::remove(path.c_str());
+}
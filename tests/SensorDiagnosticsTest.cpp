@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "CoolingLoopController.h"
+#include "SensorDiagnostics.h"
+#include "TemperatureSensor.h"
+
+// Test for classifySensorSample
+TEST(SensorDiagnosticsTest, ClassifiesOpenShortAndRate) {
+    SensorLimits limits;
+    EXPECT_EQ(classifySensorSample(2.5f, 2.5f, limits), static_cast<uint8_t>(SensorStatus::VALID));
+    EXPECT_EQ(classifySensorSample(5.0f, 2.5f, limits), static_cast<uint8_t>(SensorStatus::OPEN_CIRCUIT));
+    EXPECT_EQ(classifySensorSample(0.0f, 2.5f, limits), static_cast<uint8_t>(SensorStatus::SHORT_CIRCUIT));
+    EXPECT_EQ(classifySensorSample(3.2f, 2.5f, limits), static_cast<uint8_t>(SensorStatus::RATE_OF_CHANGE));
+    EXPECT_EQ(classifySensorSample(1.8f, 2.5f, limits), static_cast<uint8_t>(SensorStatus::RATE_OF_CHANGE));
+    // The whole table range is valid
+    EXPECT_EQ(classifySensorSample(4.771f, 4.771f, limits), static_cast<uint8_t>(SensorStatus::VALID));
+    EXPECT_EQ(classifySensorSample(0.749f, 0.749f, limits), static_cast<uint8_t>(SensorStatus::VALID));
+}
+
+// Test for the batch version over many channels
+TEST(SensorDiagnosticsTest, BatchMatchesScalar) {
+    SensorLimits limits;
+    std::vector<float> voltage, previous;
+    for (int i = 0; i < 1000; ++i) {
+        voltage.push_back(0.01f * static_cast<float>(i % 530));
+        previous.push_back(0.01f * static_cast<float>((i * 7) % 530));
+    }
+    std::vector<uint8_t> status(voltage.size());
+    classifySensorSamples(voltage.data(), previous.data(), status.data(), voltage.size(), limits);
+    for (size_t i = 0; i < voltage.size(); ++i) {
+        ASSERT_EQ(status[i], classifySensorSample(voltage[i], previous[i], limits)) << i;
+    }
+}
+
+// Test for the fallback: full cooling in the same cycle as the bad sample
+TEST(SensorDiagnosticsTest, ControllerFallsBackWithinOneSample) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    controller.step({temperatureToVoltage(40.0f), true, true});
+    EXPECT_EQ(controller.step({temperatureToVoltage(40.0f), true, true}).pumpSpeed, 0.0f);
+
+    const ControlOutputs& open = controller.step({5.0f, true, true});
+    EXPECT_EQ(open.sensorStatus, SensorStatus::OPEN_CIRCUIT);
+    EXPECT_EQ(open.state, SystemState::ON);
+    EXPECT_EQ(open.pumpSpeed, 100.0f);
+    EXPECT_EQ(open.fanSpeed, 100.0f);
+    EXPECT_EQ(open.measuredTemperature, 40.0f); // Last good reading kept
+
+    // A short no longer looks like an overtemperature
+    const ControlOutputs& shorted = controller.step({0.0f, true, true});
+    EXPECT_EQ(shorted.sensorStatus, SensorStatus::SHORT_CIRCUIT);
+    EXPECT_EQ(shorted.state, SystemState::ON);
+    EXPECT_EQ(shorted.pumpSpeed, 100.0f);
+}
+
+TEST(SensorDiagnosticsTest, ControllerRecoversAfterSpike) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    float normal = temperatureToVoltage(45.0f);
+    controller.step({normal, true, true});
+    controller.step({normal, true, true});
+    EXPECT_EQ(controller.step({normal - 1.0f, true, true}).sensorStatus, SensorStatus::RATE_OF_CHANGE);
+    EXPECT_EQ(controller.step({normal, true, true}).sensorStatus, SensorStatus::RATE_OF_CHANGE);
+    EXPECT_EQ(controller.step({normal, true, true}).sensorStatus, SensorStatus::VALID);
+    EXPECT_EQ(controller.state(), SystemState::ON);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "CoolingLoopController.h"
+#include "SensorVoting.h"
+#include "TemperatureSensor.h"
+
+// Test for voteSensorChannels
+TEST(SensorVotingTest, HottestPlausibleChannelDrivesControl) {
+    VotingLimits limits;
+    SensorVote vote = voteSensorChannels(52.0f, 58.0f, 0.0f, true, true, false, limits);
+    EXPECT_EQ(vote.temperature, 58.0f);
+    EXPECT_EQ(vote.median, 55.0f);
+    EXPECT_EQ(vote.usedMask, 0x3);
+    EXPECT_EQ(vote.disagreement, 0);
+
+    // An implausible channel never wins the max-select, whatever it holds
+    vote = voteSensorChannels(52.0f, 95.0f, 0.0f, true, false, false, limits);
+    EXPECT_EQ(vote.temperature, 52.0f);
+    EXPECT_EQ(vote.usedMask, 0x1);
+
+    vote = voteSensorChannels(52.0f, 58.0f, 60.0f, false, false, false, limits);
+    EXPECT_EQ(vote.usedMask, 0);
+}
+
+TEST(SensorVotingTest, MedianVotesOutSingleOutlier) {
+    VotingLimits limits;
+    SensorVote vote = voteSensorChannels(50.0f, 52.0f, 100.0f, true, true, true, limits);
+    EXPECT_EQ(vote.median, 52.0f);
+    EXPECT_EQ(vote.temperature, 52.0f);
+    EXPECT_EQ(vote.usedMask, 0x3);
+    EXPECT_EQ(vote.disagreement, 1);
+
+    // No majority: two channels far from the median on either side, keep them all
+    vote = voteSensorChannels(30.0f, 50.0f, 70.0f, true, true, true, limits);
+    EXPECT_EQ(vote.temperature, 70.0f);
+    EXPECT_EQ(vote.usedMask, 0x7);
+
+    // Two channels cannot out-vote each other; the spread is only flagged
+    vote = voteSensorChannels(50.0f, 80.0f, 0.0f, true, true, false, limits);
+    EXPECT_EQ(vote.temperature, 80.0f);
+    EXPECT_EQ(vote.disagreement, 1);
+}
+
+// Test for the batch version over many loops
+TEST(SensorVotingTest, BatchMatchesScalar) {
+    VotingLimits limits;
+    const size_t loops = 1000;
+    std::vector<float> t[MAX_SENSOR_CHANNELS];
+    std::vector<std::uint8_t> s[MAX_SENSOR_CHANNELS];
+    for (int ch = 0; ch < MAX_SENSOR_CHANNELS; ++ch) {
+        for (size_t i = 0; i < loops; ++i) {
+            t[ch].push_back(20.0f + static_cast<float>((i * (7 + 5 * ch)) % 80));
+            s[ch].push_back(static_cast<std::uint8_t>((i + ch) % 7 == 0 ? 1 : 0));
+        }
+    }
+    const float* temperature[MAX_SENSOR_CHANNELS] = {t[0].data(), t[1].data(), t[2].data()};
+    const std::uint8_t* status[MAX_SENSOR_CHANNELS] = {s[0].data(), s[1].data(), s[2].data()};
+    std::vector<float> control(loops), median(loops);
+    std::vector<std::uint8_t> disagreement(loops);
+
+    for (int channels = 1; channels <= MAX_SENSOR_CHANNELS; ++channels) {
+        voteSensorChannelsBatch(temperature, status, channels, control.data(), median.data(), disagreement.data(),
+                                loops, limits);
+        for (size_t i = 0; i < loops; ++i) {
+            SensorVote vote = voteSensorChannels(t[0][i], t[1][i], t[2][i], s[0][i] == 0,
+                                                 channels > 1 && s[1][i] == 0, channels > 2 && s[2][i] == 0, limits);
+            if (vote.usedMask) {
+                ASSERT_EQ(control[i], vote.temperature) << channels << " channels, loop " << i;
+            }
+            ASSERT_EQ(median[i], vote.median) << channels << " channels, loop " << i;
+            ASSERT_EQ(disagreement[i], vote.disagreement) << channels << " channels, loop " << i;
+        }
+    }
+}
+
+// Test for the controller with redundant sensors
+TEST(SensorVotingTest, ControllerKeepsControlOnRemainingSensor) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    float cool = temperatureToVoltage(45.0f);
+    float hot = temperatureToVoltage(60.0f);
+    SensorInputs inputs{cool, true, true, {hot, 0.0f}, 2};
+    controller.step(inputs);
+    const ControlOutputs& out = controller.step(inputs);
+    EXPECT_NEAR(out.measuredTemperature, 60.0f, 0.01f); // DC-DC outlet is hotter
+    EXPECT_EQ(out.activeSensors, 0x3);
+    EXPECT_GT(out.pumpSpeed, 0.0f);
+
+    // DC-DC sensor wire opens: the inverter sensor carries on, no full-cooling fallback
+    inputs.redundantVoltage[0] = 5.0f;
+    const ControlOutputs& open = controller.step(inputs);
+    EXPECT_EQ(open.sensorStatus, SensorStatus::OPEN_CIRCUIT);
+    EXPECT_EQ(open.activeSensors, 0x1);
+    EXPECT_NEAR(open.measuredTemperature, 45.0f, 0.01f);
+    EXPECT_LT(open.pumpSpeed, 100.0f);
+
+    // Both gone: full cooling
+    inputs.sensorVoltage = 0.0f;
+    EXPECT_EQ(controller.step(inputs).pumpSpeed, 100.0f);
+}
+
+TEST(SensorVotingTest, ThirdSensorOutvotesFalseOvertemperature) {
+    CoolingLoopController controller(50.0f, 70.0f);
+    float normal = temperatureToVoltage(48.0f);
+    SensorInputs inputs{normal, true, true, {normal, temperatureToVoltage(95.0f)}, 3};
+    controller.step(inputs);
+    const ControlOutputs& out = controller.step(inputs);
+    EXPECT_EQ(out.state, SystemState::ON);
+    EXPECT_EQ(out.activeSensors, 0x3);
+    EXPECT_TRUE(out.sensorDisagreement);
+    EXPECT_NEAR(out.measuredTemperature, 48.0f, 0.01f);
+}
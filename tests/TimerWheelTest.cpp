@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "TimerWheel.h"
+
+// Test for expiry on the exact tick, for delays in every wheel and across cascades
+TEST(TimerWheelTest, FiresOnItsTick) {
+    const std::uint64_t delays[] = {1, 2, 63, 64, 65, 127, 4095, 4096, 4097, 262143, 262144, 1000003,
+                                    16777216, TIMER_WHEEL_MAX_DELAY};
+    for (std::uint64_t start : {std::uint64_t{0}, std::uint64_t{37}, std::uint64_t{4095}, std::uint64_t{1} << 33}) {
+        TimerWheel wheel(32, start);
+        for (std::uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); ++i) {
+            ASSERT_NE(wheel.arm(delays[i], i, 0).index, TIMER_NONE);
+        }
+        std::vector<std::uint64_t> firedAt(sizeof(delays) / sizeof(delays[0]), 0);
+        std::size_t fired = wheel.advance(TIMER_WHEEL_MAX_DELAY, [&](std::uint32_t owner, std::uint16_t) {
+            firedAt[owner] = wheel.time();
+        });
+        EXPECT_EQ(fired, firedAt.size());
+        for (std::size_t i = 0; i < firedAt.size(); ++i) {
+            EXPECT_EQ(firedAt[i], start + delays[i]) << "start " << start << ", delay " << delays[i];
+        }
+        EXPECT_EQ(wheel.size(), 0u);
+        EXPECT_EQ(wheel.time(), start + TIMER_WHEEL_MAX_DELAY);
+    }
+}
+
+// Test for cancel: a cancelled timer never fires, and a stale handle cannot cancel the timer
+// that reuses its node
+TEST(TimerWheelTest, CancelAndStaleHandles) {
+    TimerWheel wheel(2);
+    TimerHandle first = wheel.arm(100, 1, static_cast<std::uint16_t>(LoopTimer::AFTERRUN));
+    TimerHandle kept = first;
+    EXPECT_TRUE(wheel.armed(first));
+    EXPECT_TRUE(wheel.cancel(first));
+    EXPECT_EQ(first.index, TIMER_NONE);
+    EXPECT_FALSE(wheel.armed(kept));
+
+    TimerHandle second = wheel.arm(100, 2, static_cast<std::uint16_t>(LoopTimer::HEARTBEAT));
+    EXPECT_EQ(second.index, kept.index); // Node reused, new generation
+    EXPECT_FALSE(wheel.cancel(kept));
+    EXPECT_TRUE(wheel.armed(second));
+    wheel.arm(5, 3, 0);
+    EXPECT_EQ(wheel.arm(5, 4, 0).index, TIMER_NONE); // Pool full
+
+    std::vector<std::uint32_t> owners;
+    wheel.advance(1000, [&](std::uint32_t owner, std::uint16_t) { owners.push_back(owner); });
+    EXPECT_EQ(owners, (std::vector<std::uint32_t>{3, 2}));
+    EXPECT_FALSE(wheel.armed(second));
+}
+
+// Test for callbacks that re-arm (a heartbeat) and cancel a timer due in the same tick
+TEST(TimerWheelTest, CallbacksArmAndCancel) {
+    TimerWheel wheel(8);
+    TimerHandle other = wheel.arm(50, 9, 0);
+    wheel.arm(50, 1, static_cast<std::uint16_t>(LoopTimer::HEARTBEAT));
+    std::vector<std::uint64_t> beats;
+    wheel.advance(400, [&](std::uint32_t owner, std::uint16_t kind) {
+        if (kind == static_cast<std::uint16_t>(LoopTimer::HEARTBEAT)) {
+            beats.push_back(wheel.time());
+            wheel.arm(100, owner, kind);
+            wheel.cancel(other);
+        } else {
+            ADD_FAILURE() << "cancelled timer fired";
+        }
+    });
+    EXPECT_EQ(beats, (std::vector<std::uint64_t>{50, 150, 250, 350}));
+    EXPECT_EQ(wheel.size(), 1u);
+}
+
+// Test against a reference (ordered map of expiries) under random arms, cancels and advances
+TEST(TimerWheelTest, MatchesReferenceModel) {
+    std::mt19937_64 random(7);
+    TimerWheel wheel(4096);
+    std::multimap<std::uint64_t, std::uint32_t> reference; // expiry -> owner
+    struct Armed {
+        TimerHandle handle;
+        std::uint64_t expiry;
+        std::uint32_t owner;
+    };
+    std::vector<Armed> handles; // Every timer armed, fired or not
+    std::uint32_t nextOwner = 0;
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> fired;
+    for (int round = 0; round < 20000; ++round) {
+        int action = static_cast<int>(random() % 10);
+        if (action < 5 && wheel.size() < wheel.capacity()) {
+            std::uint64_t delay = 1 + (random() % 4 == 0 ? random() % 1000000 : random() % 300);
+            TimerHandle handle = wheel.arm(delay, nextOwner, 0);
+            reference.emplace(wheel.time() + delay, nextOwner);
+            handles.push_back(Armed{handle, wheel.time() + delay, nextOwner++});
+        } else if (action < 7 && !handles.empty()) {
+            Armed& pick = handles[random() % handles.size()];
+            bool wasArmed = wheel.armed(pick.handle);
+            EXPECT_EQ(wheel.cancel(pick.handle), wasArmed);
+            auto range = reference.equal_range(pick.expiry);
+            auto it = std::find_if(range.first, range.second,
+                                   [&](const std::pair<const std::uint64_t, std::uint32_t>& entry) {
+                                       return entry.second == pick.owner;
+                                   });
+            EXPECT_EQ(it != range.second, wasArmed);
+            if (it != range.second) reference.erase(it);
+        } else {
+            std::uint64_t ticks = random() % 2 ? random() % 10 : random() % 5000;
+            fired.clear();
+            wheel.advance(ticks, [&](std::uint32_t owner, std::uint16_t) {
+                fired.emplace_back(wheel.time(), owner);
+            });
+            std::vector<std::pair<std::uint64_t, std::uint32_t>> expected;
+            while (!reference.empty() && reference.begin()->first <= wheel.time()) {
+                expected.emplace_back(reference.begin()->first, reference.begin()->second);
+                reference.erase(reference.begin());
+            }
+            // Same timers at the same ticks; the order within a tick is not specified
+            std::sort(fired.begin(), fired.end());
+            std::sort(expected.begin(), expected.end());
+            ASSERT_EQ(fired, expected) << "round " << round;
+        }
+        ASSERT_EQ(wheel.size(), reference.size());
+    }
+}
@@ -0,0 +1,40 @@
+/*
+Calibration baker: turns the text calibration into the binary image the application maps
+at startup (see src/Calibration.h). Run by the build for config/calibration.txt.
+
+Usage:
+    CalibrationBake calibration.txt calibration.img
+*/
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Calibration.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: CalibrationBake calibration.txt calibration.img\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << argv[1] << ": cannot open\n";
+        return 1;
+    }
+    CalibrationImage image;
+    std::string error;
+    if (!parseCalibration(in, image, error)) {
+        std::cerr << argv[1] << ": " << error << "\n";
+        return 1;
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&image), sizeof(image));
+    if (!out.flush()) {
+        std::cerr << argv[2] << ": cannot write\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+Drive-cycle converter: turns a CSV drive cycle (or a fleet log exported as CSV) into the
+binary column format that the simulators stream (see src/DriveCycle.h). Both files are
+streamed, so the input may be larger than memory.
+
+Usage:
+    DriveCycleConvert cycle.csv cycle.dcb
+*/
+
+#include <iostream>
+#include <string>
+
+#include "DriveCycle.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: DriveCycleConvert cycle.csv cycle.dcb\n";
+        return 1;
+    }
+
+    DriveCycleReader reader;
+    std::string error;
+    if (!reader.open(argv[1], error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    DriveCycleWriter writer;
+    if (!writer.open(argv[2])) {
+        std::cerr << argv[2] << ": cannot write\n";
+        return 1;
+    }
+
+    DriveCycleSample sample;
+    bool ok = true;
+    while (ok && reader.next(sample)) {
+        ok = writer.write(sample);
+    }
+    if (!reader.error().empty()) {
+        std::cerr << argv[1] << ": " << reader.error() << "\n";
+        return 1;
+    }
+    if (!writer.close() || !ok) {
+        std::cerr << argv[2] << ": cannot write\n";
+        return 1;
+    }
+    std::cout << "Converted " << reader.position() << " samples\n";
+    return 0;
+}